@@ -0,0 +1,78 @@
+#version 330 compatibility
+
+// Prepended to every fragment stage, must match the std140 structs in GameShaders.h
+
+#define MAX_LIGHTS 2
+
+struct Light {
+    vec4 position;      // eye space, w = 0 for directional
+    vec4 direction;     // eye space spot direction, w = 1 when enabled
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 spot;          // x = cos(cutoff), y = exponent
+    vec4 attenuation;   // constant, linear, quadratic
+};
+
+layout(std140) uniform LightBlock {
+    Light lights[MAX_LIGHTS];
+    vec4 globalAmbient;
+};
+
+layout(std140) uniform MaterialBlock {
+    vec4 matAmbient;
+    vec4 matDiffuse;
+    vec4 matSpecular;
+    vec4 matEmission;
+    vec4 matShininess;  // x = shininess
+};
+
+in vec3 vEyePosition;
+in vec3 vEyeNormal;
+in vec2 vTexCoord;
+
+out vec4 fragColor;
+
+// Same terms as the fixed-function equation, evaluated per pixel
+vec4 shadeLit() {
+    vec3 normal = normalize(vEyeNormal);
+    if (!gl_FrontFacing) normal = -normal;
+    vec3 toEye = normalize(-vEyePosition);
+
+    vec3 color = matEmission.rgb + globalAmbient.rgb * matAmbient.rgb;
+
+    for (int i = 0; i < MAX_LIGHTS; ++i) {
+        Light light = lights[i];
+        if (light.direction.w == 0.0) continue;
+
+        vec3 toLight = light.position.xyz - vEyePosition * light.position.w;
+        float distance = length(toLight);
+        toLight /= max(distance, 1e-5);
+
+        float attenuation = 1.0;
+        if (light.position.w != 0.0) {
+            vec3 k = light.attenuation.xyz;
+            attenuation = 1.0 / max(k.x + k.y * distance + k.z * distance * distance, 1e-5);
+        }
+
+        float spotCos = dot(-toLight, normalize(light.direction.xyz));
+        if (spotCos < light.spot.x) continue;
+        if (light.spot.x > -1.0) {
+            attenuation *= pow(max(spotCos, 0.0), light.spot.y);
+        }
+
+        float lambert = max(dot(normal, toLight), 0.0);
+        vec3 lightColor = light.ambient.rgb * matAmbient.rgb
+                        + lambert * light.diffuse.rgb * matDiffuse.rgb;
+
+        if (lambert > 0.0) {
+            vec3 halfVector = normalize(toLight + toEye);
+            float highlight = pow(max(dot(normal, halfVector), 1e-4), matShininess.x);
+            lightColor += highlight * light.specular.rgb * matSpecular.rgb;
+        }
+
+        color += attenuation * lightColor;
+    }
+
+    return vec4(clamp(color, 0.0, 1.0), matDiffuse.a);
+}
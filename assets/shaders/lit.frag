@@ -0,0 +1,5 @@
+// MaterialClass::Lit, lighting.glsl is prepended by GameShaders
+
+void main() {
+    fragColor = shadeLit();
+}
@@ -0,0 +1,21 @@
+#version 330 compatibility
+
+// Shared vertex stage for every lit material class.
+// Reads the legacy attribute slots so immediate mode, display lists and
+// client-array VBOs (glVertexPointer/glNormalPointer) all feed it the same way.
+
+out vec3 vEyePosition;
+out vec3 vEyeNormal;
+out vec2 vTexCoord;
+
+void main() {
+    vec4 eyePosition = gl_ModelViewMatrix * gl_Vertex;
+
+    vEyePosition = eyePosition.xyz;
+    vEyeNormal = gl_NormalMatrix * gl_Normal;
+    vTexCoord = gl_MultiTexCoord0.xy;
+
+    // Keeps glClipPlane working (Pac-Man's mouth)
+    gl_ClipVertex = eyePosition;
+    gl_Position = gl_ProjectionMatrix * eyePosition;
+}
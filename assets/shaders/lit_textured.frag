@@ -0,0 +1,8 @@
+// MaterialClass::LitTextured, lighting.glsl is prepended by GameShaders
+
+uniform sampler2D diffuseTexture;
+
+void main() {
+    // Same as GL_MODULATE
+    fragColor = shadeLit() * texture(diffuseTexture, vTexCoord);
+}
@@ -0,0 +1,109 @@
+# Offscreen render benchmark (Linux CI without display/GPU)
+# Renders through OSMesa (llvmpipe/softpipe), everything else comes from the system.
+#
+#   cmake -S . -B build-headless -DPACMAN_HEADLESS=ON
+#   cmake --build build-headless
+#   cd build-headless && ./MPG-PacMan-headless --frames 600 --dump frames --dump-every 60
+
+find_package(PkgConfig REQUIRED)
+pkg_check_modules(OSMESA REQUIRED IMPORTED_TARGET osmesa)
+find_package(OpenGL REQUIRED)
+find_package(GLEW REQUIRED)
+find_package(GLUT REQUIRED)
+find_package(Freetype REQUIRED)
+find_package(SDL3 REQUIRED CONFIG)
+find_package(SDL3_mixer REQUIRED CONFIG)
+
+# Same sources as the game minus the Windows entry point, glft2 is compiled in directly
+file(GLOB HEADLESS_SOURCES "${CMAKE_SOURCE_DIR}/src/*.cpp")
+list(FILTER HEADLESS_SOURCES EXCLUDE REGEX ".*/src/main\\.cpp$")
+file(GLOB HEADLESS_GLFT2_SOURCES "${CMAKE_SOURCE_DIR}/lib/glft2/src/*.cpp")
+
+add_executable(MPG-PacMan-headless
+    ${HEADLESS_SOURCES}
+    ${HEADLESS_GLFT2_SOURCES}
+    "${CMAKE_SOURCE_DIR}/tools/pacman_headless.cpp"
+)
+
+target_compile_definitions(MPG-PacMan-headless PRIVATE PACMAN_HEADLESS)
+
+target_include_directories(MPG-PacMan-headless PRIVATE
+    ${CMAKE_SOURCE_DIR}/include
+    ${CMAKE_SOURCE_DIR}/resources
+    ${CMAKE_SOURCE_DIR}/lib/stb
+    ${CMAKE_SOURCE_DIR}/lib/glft2/include
+)
+
+target_link_libraries(MPG-PacMan-headless PRIVATE
+    PkgConfig::OSMESA
+    OpenGL::GLU
+    GLEW::GLEW
+    GLUT::GLUT
+    Freetype::Freetype
+    SDL3::SDL3
+    SDL3_mixer::SDL3_mixer
+)
+
+set_property(TARGET MPG-PacMan-headless PROPERTY CXX_STANDARD 20)
+
+# Copy assets dir to the output directory
+add_custom_command(TARGET MPG-PacMan-headless POST_BUILD
+    COMMAND ${CMAKE_COMMAND} -E copy_directory
+    "${CMAKE_SOURCE_DIR}/assets/"
+    "${CMAKE_BINARY_DIR}/assets/"
+)
+
+# Navigation micro benchmarks, JSON results (see tools/pacman_bench_nav.cpp)
+#
+#   cd build-headless && ./pacman_bench_nav --out nav.json
+add_executable(pacman_bench_nav
+    ${HEADLESS_SOURCES}
+    ${HEADLESS_GLFT2_SOURCES}
+    "${CMAKE_SOURCE_DIR}/tools/pacman_bench_nav.cpp"
+)
+
+target_include_directories(pacman_bench_nav PRIVATE
+    ${CMAKE_SOURCE_DIR}/include
+    ${CMAKE_SOURCE_DIR}/resources
+    ${CMAKE_SOURCE_DIR}/lib/stb
+    ${CMAKE_SOURCE_DIR}/lib/glft2/include
+)
+
+target_link_libraries(pacman_bench_nav PRIVATE
+    OpenGL::GLU
+    GLEW::GLEW
+    GLUT::GLUT
+    Freetype::Freetype
+    SDL3::SDL3
+    SDL3_mixer::SDL3_mixer
+)
+
+set_property(TARGET pacman_bench_nav PROPERTY CXX_STANDARD 20)
+add_dependencies(pacman_bench_nav MPG-PacMan-headless)   # reuses its assets copy
+
+# Map compiler (see tools/pacman_mapc.cpp), the maps are compiled by compile_maps (see cmake/Helpers.cmake)
+add_executable(pacman_mapc
+    ${HEADLESS_SOURCES}
+    ${HEADLESS_GLFT2_SOURCES}
+    "${CMAKE_SOURCE_DIR}/tools/pacman_mapc.cpp"
+)
+
+target_include_directories(pacman_mapc PRIVATE
+    ${CMAKE_SOURCE_DIR}/include
+    ${CMAKE_SOURCE_DIR}/resources
+    ${CMAKE_SOURCE_DIR}/lib/stb
+    ${CMAKE_SOURCE_DIR}/lib/glft2/include
+)
+
+target_link_libraries(pacman_mapc PRIVATE
+    OpenGL::GLU
+    GLEW::GLEW
+    GLUT::GLUT
+    Freetype::Freetype
+    SDL3::SDL3
+    SDL3_mixer::SDL3_mixer
+)
+
+set_property(TARGET pacman_mapc PROPERTY CXX_STANDARD 20)
+
+compile_maps(MPG-PacMan-headless)
@@ -13,4 +13,36 @@ function(extract_zip zip_path target_dir)
   else()
     message(FATAL_ERROR "ZIP extraction is only implemented for Windows with PowerShell")
   endif()
-endfunction()
\ No newline at end of file
+endfunction()
+
+# Compile the text maps and the level pack into the output dir, only when a map or pacman_mapc changes.
+# Call it after the target's assets copy, the copy restamps the text maps and the .pmap must stay newer.
+function(compile_maps target)
+  file(GLOB map_files "${CMAKE_SOURCE_DIR}/assets/maps/*.map")
+  set(maps_dir "${CMAKE_BINARY_DIR}/assets/maps")
+  set(compiled_files)
+  foreach(map_file ${map_files})
+    get_filename_component(map_name ${map_file} NAME_WE)
+    add_custom_command(
+      OUTPUT "${maps_dir}/${map_name}.pmap"
+      COMMAND ${CMAKE_COMMAND} -E make_directory "${maps_dir}"
+      COMMAND pacman_mapc "${map_file}" "${maps_dir}/${map_name}.pmap"
+      DEPENDS "${map_file}" pacman_mapc
+      COMMENT "Compiling ${map_name}.map"
+    )
+    list(APPEND compiled_files "${maps_dir}/${map_name}.pmap")
+  endforeach()
+  add_custom_command(
+    OUTPUT "${maps_dir}/levels.ppak"
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${maps_dir}"
+    COMMAND pacman_mapc --pack "${CMAKE_SOURCE_DIR}/assets/maps/levels.txt" "${maps_dir}/levels.ppak"
+    DEPENDS "${CMAKE_SOURCE_DIR}/assets/maps/levels.txt" ${map_files} pacman_mapc
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    COMMENT "Packing levels.ppak"
+  )
+  add_custom_target(${target}_maps DEPENDS ${compiled_files} "${maps_dir}/levels.ppak")
+  add_dependencies(${target} ${target}_maps)
+  add_custom_command(TARGET ${target} POST_BUILD
+    COMMAND ${CMAKE_COMMAND} -E touch_nocreate ${compiled_files}
+  )
+endfunction()
@@ -0,0 +1,94 @@
+#ifndef COMPILEDMAP_H
+#define COMPILEDMAP_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "NavGraph.h"
+#include "Tile.h"
+
+class MapTemplate;
+
+// Binary form of a .map, written by pacman_mapc and read back through a file mapping.
+// Holds everything the text loader derives on every level start: tile and wall types,
+// the teleport links, spawn tiles, the pellet bitset and the NavGraph tables. Grid
+// neighbours are implicit, only links to a tile that is not next door are stored.
+// Little endian, every section 8 byte aligned. Bump VERSION on any layout change,
+// old files are then rejected and the text map is loaded instead.
+class CompiledMap {
+public:
+    static constexpr char MAGIC[4] = { 'P', 'M', 'A', 'P' };
+    static constexpr uint32_t VERSION = 1;
+    static constexpr int MAX_SIDE = 4096;
+
+    enum Spawn { SPAWN_PLAYER, SPAWN_BLINKY, SPAWN_PINKY, SPAWN_INKY, SPAWN_CLYDE, SPAWN_COUNT };
+    enum LinkDirection : int32_t { LINK_UP, LINK_DOWN, LINK_LEFT, LINK_RIGHT };
+
+    struct Link {
+        int32_t tile;           // row-major index
+        int32_t direction;      // LinkDirection
+        int32_t target;
+    };
+
+    // Maps the file and checks the header and every table, the views below stay valid until close
+    bool open(const std::string& path);
+    // Same checks on a compiled map inside memory someone else keeps mapped (a LevelPack level),
+    // data 8 byte aligned. name is only for messages.
+    bool openBytes(const uint8_t* data, size_t size, const std::string& name);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    int getWidth() const { return header->width; }
+    int getHeight() const { return header->height; }
+    int getPelletCount() const { return header->pelletCount; }
+    // Row-major tile index
+    int getSpawn(Spawn spawn) const { return header->spawns[spawn]; }
+    std::span<const uint8_t> getTileTypes() const { return section<uint8_t>(TILE_TYPES); }
+    std::span<const uint8_t> getWallTypes() const { return section<uint8_t>(WALL_TYPES); }
+    std::span<const Link> getLinks() const { return section<Link>(LINKS); }
+    std::span<const uint64_t> getPelletBits() const { return section<uint64_t>(PELLETS); }
+    NavGraph::PackedView getNavTables() const;
+
+    // See MapTemplate::capture for a map built from text
+    static bool write(const MapTemplate& source, const std::string& path);
+    // The file's bytes, for writers that embed maps in a bigger file
+    static std::vector<uint8_t> encode(const MapTemplate& source);
+    // SPAWN_COUNT for anything that is not a spawn
+    static Spawn spawnOf(TileType type);
+
+private:
+    enum SectionId { TILE_TYPES, WALL_TYPES, LINKS, PELLETS, NAV_NODES, NAV_EDGES, NAV_EDGE_TILES, NAV_COMPONENTS, SECTION_COUNT };
+
+    struct Section {
+        uint64_t offset;
+        uint64_t size;          // bytes
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        int32_t width;
+        int32_t height;
+        int32_t pelletCount;
+        int32_t navComponentCount;
+        int32_t spawns[SPAWN_COUNT];
+        uint32_t reserved;
+        Section sections[SECTION_COUNT];
+    };
+
+    template <typename T>
+    std::span<const T> section(SectionId id) const {
+        const Section& s = header->sections[id];
+        return std::span<const T>(reinterpret_cast<const T*>(bytes + s.offset), (size_t)(s.size / sizeof(T)));
+    }
+    bool validate(const std::string& path) const;
+
+    MappedFile file;                // unused for openBytes
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+    const Header* header = nullptr;
+};
+
+#endif
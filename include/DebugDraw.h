@@ -0,0 +1,106 @@
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include "gl_includes.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Point3D.h"
+#include "BoundingBox3D.h"
+
+struct DebugColor {
+    float r = 1.0f;
+    float g = 1.0f;
+    float b = 1.0f;
+    float a = 1.0f;
+};
+
+// Collects debug lines, quads and text labels during the frame and draws them all
+// in flush(), one buffer upload and one draw per primitive kind. Labels use a
+// built-in 5x7 font atlas, so thousands of them cost as much as a few quads.
+// Submissions are dropped while disabled, toggled with 'g'.
+class DebugDraw {
+public:
+    static constexpr unsigned char TOGGLE_KEY = 'g';
+
+    static DebugDraw& getInstance() {
+        static DebugDraw instance;
+        return instance;
+    }
+
+    void handleInput();
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool value);
+
+    void line(const Point3D& a, const Point3D& b, const DebugColor& color);
+    // Corners in winding order, drawn as two triangles
+    void quad(const Point3D& a, const Point3D& b, const Point3D& c, const Point3D& d, const DebugColor& color);
+    // Translucent faces plus solid edges
+    void box(const BoundingBox3D& absoluteBox, const DebugColor& color);
+    void cross(const Point3D& center, float size, const DebugColor& color);
+    // World position projected at flush time, text is centered on it in screen pixels
+    // (scale = pixels per font pixel) and drawn on top of everything
+    void label(const Point3D& position, const std::string& text, const DebugColor& color, int scale = 1);
+
+    // Call with the scene camera still on the modelview stack
+    void flush();
+    void clear();
+
+private:
+    DebugDraw() = default;
+    DebugDraw(const DebugDraw&) = delete;
+    DebugDraw& operator=(const DebugDraw&) = delete;
+
+    struct Vertex {
+        GLfloat x, y, z;
+        GLubyte rgba[4];
+    };
+
+    struct TextVertex {
+        GLfloat x, y;
+        GLfloat u, v;
+        GLubyte rgba[4];
+    };
+
+    struct Label {
+        Point3D position;
+        uint32_t textOffset;
+        uint32_t textLength;
+        int scale;
+        GLubyte rgba[4];
+    };
+
+    static constexpr int GLYPH_W = 5;
+    static constexpr int GLYPH_H = 7;
+    static constexpr int CELL_W = GLYPH_W + 1;   // one pixel gap against bleeding
+    static constexpr int CELL_H = GLYPH_H + 1;
+    static constexpr int ATLAS_COLS = 16;
+
+    static void packColor(const DebugColor& color, GLubyte out[4]);
+    bool initFont();
+    void buildTextVertices();
+    // Uploads into the stream buffer (or points at the vector without VBOs) and draws
+    template <typename V>
+    void drawBatch(GLuint buffer, const std::vector<V>& vertices, GLenum mode);
+
+    bool enabled = false;
+
+    std::vector<Vertex> lineVertices;
+    std::vector<Vertex> triangleVertices;
+    std::vector<Label> labels;
+    std::string labelText;             // all label strings back to back
+    std::vector<TextVertex> textVertices;
+
+    GLuint fontTexture = 0;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    uint8_t glyphIndex[128] = {};      // ASCII -> atlas cell
+
+    bool buffersReady = false;
+    bool useBuffers = false;
+    GLuint lineBuffer = 0;
+    GLuint triangleBuffer = 0;
+    GLuint textBuffer = 0;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <cstdint>
+#include <vector>
+#include "Map.h"
+#include "Tile.h"
+
+// BFS distance map from one target tile over the walkable tiles, teleports included
+// (they are plain neighbour links). Every reached tile stores the neighbour one step
+// closer to the target, so any number of chasers get their next hop in O(1).
+class FlowField {
+public:
+    static constexpr int UNREACHABLE = -1;
+
+    // Rebuilds when the target tile or the map changed, returns true if it did. With reach
+    // (the chasers' tiles) the search stops once all of them have a distance and the rest
+    // of the map stays UNREACHABLE, a tile in reach that is not covered yet forces a rebuild.
+    bool update(Map* map, Tile* target, const std::vector<const Tile*>& reach = {});
+    void invalidate() { builtMap = nullptr; builtTarget = nullptr; }
+    // Fixes the field after one tile changed walkability (a door), only tiles whose
+    // distance actually changes are touched. Returns how many that were.
+    int repair(Tile* changed);
+
+    // Neighbour one step closer to the target, nullptr on the target or off the field
+    Tile* nextHop(const Tile* from) const;
+    int distanceTo(const Tile* from) const;
+    Tile* getTarget() const { return builtTarget; }
+    // False if the last search stopped early at its reach
+    bool isComplete() const { return complete; }
+    // Bumped on every rebuild, lets followers notice a new field
+    uint64_t getVersion() const { return version; }
+
+private:
+    static constexpr int NO_LINK = -1;
+
+    void build();
+    void buildLinks();
+    int repairOpened(Tile* opened);
+    int repairClosed(Tile* closed);
+    static int neighborsOf(const Tile* tile, Tile* out[4]);
+    int indexOf(const Tile* tile) const { return tile->getTileRow() * width + tile->getTileCol(); }
+
+    Map* builtMap = nullptr;
+    Tile* builtTarget = nullptr;
+    int width = 0;
+    int height = 0;
+    uint64_t version = 0;
+    std::vector<const Tile*> reachTiles;
+    bool complete = true;
+    bool repairedOutsideSearch = false;    // repairs wrote tiles the last search did not
+
+    // Flat copy of the grid's links so a rebuild does not chase Tile pointers, made once
+    // per map and topology version (unique across maps, so a new map at the same address
+    // is still noticed). Only tiles that can be walked (or opened) are linked.
+    Map* linkedMap = nullptr;
+    uint64_t linkedTopology = 0;
+    std::vector<Tile*> tiles;           // row-major
+    std::vector<int> links;             // 4 per tile, up/down/left/right, NO_LINK if none
+    std::vector<uint8_t> doors;         // walkability of these is read from the tile
+    std::vector<int> indexQueue;
+
+    std::vector<int> distances;
+    std::vector<Tile*> hops;
+    std::vector<Tile*> queue;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include "gl_includes.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One render pass of a frame, see FrameZone
+struct ZoneSample {
+    const char* name = "";
+    double cpuStartMs = 0.0;    // offset from the frame start
+    double cpuMs = 0.0;         // command submission
+    double gpuMs = -1.0;        // GL_TIME_ELAPSED, -1 until resolved or without timer queries
+};
+
+struct FrameSample {
+    uint64_t frame = 0;
+    double startMs = 0.0;   // since the first frame, for the trace timeline
+    double cpuMs = 0.0;     // time spent submitting the frame (Game::render)
+    double gpuMs = -1.0;    // sum of the zone GPU times, -1 until resolved
+    int drawCalls = 0;      // primitives/batches issued by the game renderer
+    std::vector<ZoneSample> zones;
+};
+
+// Per-frame CPU time, draw-call counter and per-zone CPU/GPU timings, fed by Game::render and RenderHelper.
+// GPU times come from GL_TIME_ELAPSED queries that are read GPU_LATENCY_FRAMES later,
+// so getLastFrame() has CPU data only and getLastGpuFrame() is the newest fully resolved frame.
+class FrameStats {
+public:
+    static constexpr int GPU_LATENCY_FRAMES = 4;
+    static constexpr int MAX_ZONES = 16;
+
+    static FrameStats& getInstance() {
+        static FrameStats instance;
+        return instance;
+    }
+
+    // Needs a current context and glewInit, without timer query support only CPU zones are recorded
+    void initGpuTimers();
+    bool hasGpuTimers() const { return gpuTimersEnabled; }
+
+    void beginFrame();
+    void endFrame();
+    void countDrawCalls(int count) { currentDrawCalls += count; }
+
+    // Zones must not nest, GL_TIME_ELAPSED queries cannot overlap
+    void beginZone(const char* name);
+    void endZone();
+
+    const FrameSample& getLastFrame() const { return lastFrame; }
+    const FrameSample& getLastGpuFrame() const { return lastGpuFrame; }
+
+    // Keep every frame sample, used by the headless benchmark
+    void setRecording(bool record) { recording = record; }
+    const std::vector<FrameSample>& getHistory() const { return history; }
+    void clearHistory() { history.clear(); }
+
+    // Waits for all outstanding queries, only for the end of a benchmark run
+    void flushGpuTimers();
+    // Chrome trace event JSON (chrome://tracing, Perfetto) of the recorded history
+    bool writeTrace(const std::string& path) const;
+
+private:
+    FrameStats() = default;
+    FrameStats(const FrameStats&) = delete;
+    FrameStats& operator=(const FrameStats&) = delete;
+
+    // Queries of one in-flight frame
+    struct GpuFrame {
+        GLuint queries[MAX_ZONES] = {};
+        int zoneCount = 0;
+        bool pending = false;
+        FrameSample sample;
+        long long historyIndex = -1;
+    };
+
+    void resolveGpuFrame(GpuFrame& gpuFrame, bool wait);
+    double msSince(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) const {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    std::chrono::steady_clock::time_point firstFrameStart;
+    std::chrono::steady_clock::time_point frameStart;
+    std::chrono::steady_clock::time_point zoneStart;
+    bool started = false;
+    uint64_t frameCounter = 0;
+    int currentDrawCalls = 0;
+    FrameSample currentFrame;
+    FrameSample lastFrame;
+    FrameSample lastGpuFrame;
+    bool zoneOpen = false;
+
+    bool gpuTimersEnabled = false;
+    GpuFrame gpuFrames[GPU_LATENCY_FRAMES];
+    GpuFrame* currentGpuFrame = nullptr;
+
+    bool recording = false;
+    std::vector<FrameSample> history;
+};
+
+// Scoped zone, e.g. { FrameZone zone("map"); map->render(...); }
+class FrameZone {
+public:
+    explicit FrameZone(const char* name) { FrameStats::getInstance().beginZone(name); }
+    ~FrameZone() { FrameStats::getInstance().endZone(); }
+    FrameZone(const FrameZone&) = delete;
+    FrameZone& operator=(const FrameZone&) = delete;
+};
+
+#endif
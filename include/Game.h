@@ -5,14 +5,25 @@
 #include "Map.h"
 #include "Player.h"
 #include "MapFactory.h"
+#include "LevelPreparer.h"
+#include "MapWatcher.h"
 #include "MoveDir.h"
 #include "Ghost.h"
+#include "FlowField.h"
 #include "GameUserInput.h"
 #include "GameCamera.h"
 #include "GameMenu.h"
 #include "glft2/TextRenderer.hpp"
 #include "FadeTimer.h"
 #include "GameSounds.h"
+#include "HudCache.h"
+#include "GameSnapshot.h"
+#include "SceneCache.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 enum class GameState {
     MainMenu = 0,
@@ -33,13 +44,23 @@ public:
     static constexpr float GHOST_SPEED_COMP = 0.1f;
     static constexpr float LEVEL_DURATION_MULTIPLIER = 0.88f;
 
+    static constexpr int SIMULATION_TICK_MS = 8;
+    static constexpr int SIMULATION_IDLE_MS = 50;     // poll interval while not playing
+    static constexpr int UPDATE_INTERVAL_MS = 8;
+    static constexpr int IDLE_LINGER_UPDATES = 30;    // updates to keep running after the last input/motion
+    static constexpr float MAX_SIMULATION_STEP_S = 0.1f;
+    static constexpr double PATHFINDING_BUDGET_MS = 1.0;  // inline path searches per tick without the worker
+    static constexpr unsigned char DOOR_TOGGLE_KEY = 'o'; // opens/closes every door of the level
+    static constexpr double NEAR_PLANE = 0.1;         // clip planes on the classic board, see Map::getViewScale
+    static constexpr double FAR_PLANE = 1000.0;
+
     void init();    // Init new game along with OpenGL settings
     void initNewLevel(int level = -1);
     void resetLevelOnDeath();
     void startNewCasualSession();
     void startNewSandboxSession();
 
-    static void update(int value = 0);  // Update game logic
+    static void update(int value = 0);  // Input, menus and camera, ticks the simulation inline when it has no thread
     static void render();  // Display the game scene
     static void renderScore();
     static void renderLives();
@@ -48,21 +69,34 @@ public:
     // GLUT Callbacks
     static void reshape(int w, int h);
 
-    // Getters
-    Map* getMap() { return &map; }
+    // Menus stop the update timer when nothing moves, input callbacks restart it
+    static void wake();
+
+    // Simulation thread, started by init unless headless
+    void startSimulation();
+    void stopSimulation();
+
+    // Getters (simulation side, only touch these from GameLogic and the entities)
+    Map* getMap() { return map.get(); }
     Player* getPlayer() { return &player; }
     std::vector<Ghost*>& getGhosts() { return ghosts; }
+    FlowField& getPlayerFlowField() { return playerFlowField; }
     float getLastFrameTimeDeltaSeconds() const { return lastFrameTimeDeltaS; }
     float getBaseSpeed() const { return baseMoveSpeed; }
     int getPlayerLives() const { return playerLives; }
     int getCurrentLevel() const { return currentLevel; }
     int getTotalScore() const { return totalScore; }
 
+    // Render side, last snapshot picked up from the simulation
+    const GameSnapshot& getRenderSnapshot() const { return snapshots.readBuffer(); }
+    Map* getRenderMap() const { return getRenderSnapshot().map.get(); }
+    Player* getRenderPlayer() { return &renderPlayer; }
+
     glft2::font_data getGameFont() const { return gameFont; }
     glft2::font_data getMenuFont() const { return menuFont; }
 
     // Setters
-    void setMap(Map newMap) { map = newMap; }
+    void setMap(Map newMap) { map = std::make_shared<Map>(newMap); }
     void setPlayer(Player newPlayer) { player = newPlayer; }
     void setBaseSpeed(float speed) { baseMoveSpeed = speed; }
     void setPlayerLives(int lives) { playerLives = lives; }
@@ -71,8 +105,27 @@ public:
 
     void replenishCameraHintFadeTimer() { cameraHintFadeTimer.start(); }
 
-    GameState getGameState() const { return gameState; };
-    GameState setGameState(GameState newGameState) { gameState = newGameState; }
+    // Text map every level loads (its compiled .pmap if there is one), set before init
+    void setMapPath(const std::string& path) { mapPath = path; }
+    const std::string& getMapPath() const { return mapPath; }
+    // Endless mode, every level is a MazeGenerator board seeded with seed + level, set before init
+    void setGeneratedLevels(bool enabled, uint32_t seed = 0) { generatedLevels = enabled; levelSeed = seed; }
+    bool hasGeneratedLevels() const { return generatedLevels; }
+    // Level N is the pack's level N (from the start again past its end) with its speeds, set before init.
+    // False with a message if the pack does not open, the map path stays in use then.
+    bool setLevelPack(const std::string& path);
+    bool hasLevelPack() const { return levelPack != nullptr; }
+    // Level design: the map being played is patched in place whenever its file is saved, set before init
+    void setMapWatching(bool enabled) { mapWatching = enabled; }
+
+    // Offscreen mode (HeadlessRenderer), no GLUT window: no callbacks, timers or buffer swaps
+    void setHeadless(bool enabled) { headless = enabled; }
+    bool isHeadless() const { return headless; }
+    // Game time in headless mode is stepped by the caller instead of GLUT_ELAPSED_TIME
+    void advanceHeadlessClock(float deltaS) { headlessTimeS += deltaS; }
+
+    GameState getGameState() const { return gameState.load(); };
+    void setGameState(GameState newGameState) { gameState = newGameState; }
 
     void killPlayer() {
         GameSounds::getInstance().playDeath();
@@ -87,17 +140,66 @@ public:
     int gameCollectedPellets = 0;
 private:
     Game() = default;
+    ~Game() { stopSimulation(); }
     Game(const Game&) = delete;  // Prevent copy constructor
     Game& operator=(const Game&) = delete;  // Prevent assignment operator
 
     bool gameLoaded = false;
     bool gameLoading = false;
 
+    // Uncached HUD drawing, baked into the HUD caches or used directly without FBO support
+    static void renderScoreGeometry();
+    static void renderLivesGeometry();
+    static void applyProjection(int w, int h, float viewScale);
+
+    HudCache scoreHud;
+    HudCache livesHud;
+
+    void simulationLoop();
+    void simulateTick(float deltaS);
+    void publishSnapshot();
+    bool acquireSnapshot();
+    bool isIdleCandidate();
+    LevelPreparer::Source levelSource(int level) const;
+    // Patches the live map from its file, the level starts over only if the size changed
+    void reloadMap();
+
+    std::thread simulationThread;
+    std::atomic<bool> simulationRunning{ false };
+    // Held for a whole tick and while the menu (re)starts a session
+    std::mutex simulationMutex;
+    TripleBuffer<GameSnapshot> snapshots;
+    uint64_t simulationTick = 0;
+    uint64_t mapGeneration = 0;
+    uint64_t hudMapGeneration = 0;
+    // Set by the simulation, the game over menu is built on the GLUT thread
+    std::atomic<bool> gameOverPending{ false };
+    // Set from input, consumed by the next simulation tick
+    std::atomic<bool> doorToggleRequested{ false };
+
+    bool updateSleeping = false;
+    int idleLingerUpdates = IDLE_LINGER_UPDATES;
+    SceneCache sceneCache;
+
+    // Render copies of the entities, filled from the snapshot
+    Player renderPlayer;
+    std::vector<Ghost> renderGhosts;
+
+    bool headless = false;
+    float headlessTimeS = 0.0f;
+
     FadeTimer cameraHintFadeTimer = FadeTimer();
     GameMenu gameMenu = GameMenu();
 
-    MapFactory mapFactory;
-    Map map;
+    std::string mapPath = MapFactory::DEFAULT_MAP_PATH;
+    bool generatedLevels = false;
+    uint32_t levelSeed = 0;
+    std::shared_ptr<const LevelPack> levelPack;
+    LevelPreparer::Source mapSource;    // board the current map was built from
+    bool mapWatching = false;
+    MapWatcher mapWatcher;
+    float projectionScale = 1.0f;   // view scale the projection was last set up for
+    std::shared_ptr<Map> map;
     Player player;
     Ghost pinky;
     Ghost blinky;
@@ -107,14 +209,17 @@ private:
     Player dummyPlayer = Player();
 
     std::vector<Ghost*> ghosts;
+    // Distances to the player's tile, shared by every chasing ghost
+    FlowField playerFlowField;
     MoveDir moveDir;
 
-    GameState gameState;
+    std::atomic<GameState> gameState{ GameState::MainMenu };
 
     bool playerDying = false;
 
     float lastFrameTimeS = 0.0f;
-    float lastFrameTimeDeltaS = 0.0f;
+    float lastFrameTimeDeltaS = 0.0f;   // simulation step
+    float lastUpdateDeltaS = 0.0f;      // GLUT update step, drives the camera
 
     float baseMoveSpeed = 6.5f;
     const float maxFrametimeNormalizedSpeed = 0.5f;
@@ -13,7 +13,7 @@ enum class CameraMode {
     FollowingPlayer = 2
 };
 
-static class GameCamera {
+class GameCamera {
 public:
     static constexpr float PI = 3.14159265358979323846f;
     static constexpr float DEFAULT_MOUSE_SENSITIVITY = 0.08f;
@@ -49,6 +49,10 @@ public:
     CameraGlu getCameraGLU() const { return cameraGlu; }
     CameraState getCameraState() const { return cameraState; }
     void setLockUserUpdate(bool lock) { lockUserUpdate = lock; }
+    // Jump straight to a state in free mode (camera path replay)
+    void applyCameraState(CameraState newCameraState);
+    // Auto camera still easing toward its target
+    bool isTransitioning() const { return (autoCameraMoving || autoCameraOrbitting || autoCameraZooming) && !autoCameraTargetReached; }
 private:
     bool lockUserUpdate = false;
 
@@ -111,6 +115,7 @@ private:
     void handleCameraOrbitting();
     void handleCameraPosMoving();
     void handleCameraZooming();
+    static float mapViewScale();
 
     float frametimeNormalizedTransitionSpeed(float frametimeS) { return frametimeS * DEFAULT_CAMERA_TRANSITION_SPEED * MapFactory::TILE_SIZE; }
     void updateAutoCameraTransition(float frametimeS);
@@ -1,6 +1,7 @@
 #ifndef GAMECONTROL_H
 #define GAMECONTROL_H
 #include "gl_includes.h"
+#include <atomic>
 #include <unordered_set>
 #include <unordered_map>
 #include "CameraModels.h"
@@ -14,16 +15,19 @@ public:
         static GameControl instance;
         return instance;
     }
+    // Runs on the GLUT thread, the simulation thread only reads moveDir and takes movementChanged
     void update();
     void setMoveDir(MoveDir moveDir) { this->moveDir = moveDir; }
     MoveDir getMoveDir() const { return moveDir; }
-    bool& getMovementChanged() { return movementChanged; }
-    bool resetMovementChanged() { movementChanged = false; }
+    // Returns the flag and clears it in one go, so a key press is never seen twice or lost
+    bool consumeMovementChanged() { return movementChanged.exchange(false); }
+    void resetMovementChanged() { movementChanged = false; }
     void setMovementChanged() { movementChanged = true; }
 
     // Disables WASD movement until a full key press-and-release cycle is detected.
     // If a WASD key is already held down when this is called, it must be released,
     // then pressed and released again to enable movement.
+    // Safe to call from the simulation thread, the key check happens in the next update().
     void enableWasdAfterFullPressCycle();
 
 private:
@@ -34,12 +38,13 @@ private:
     GameControl(const GameControl&) = delete;
     GameControl& operator=(const GameControl&) = delete;
     void changeCameraMode();
-    MoveDir moveDir = MoveDir::NONE;
+    std::atomic<MoveDir> moveDir{ MoveDir::NONE };
 
     bool waitForKeyReleaseFirst = false;
+    std::atomic<bool> wasdReleaseCheckPending{ false };
 
-    bool isWasdMovementEnabled = false;
-    bool movementChanged = false;
+    std::atomic<bool> isWasdMovementEnabled{ false };
+    std::atomic<bool> movementChanged{ false };
 
 };
 
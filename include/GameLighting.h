@@ -2,12 +2,16 @@
 #define GameLighting_H
 
 #include "gl_includes.h"
+#include "GameShaders.h"
 
-static class GameLighting {
+class GameLighting {
 private:
     static void initSceneLight();
     // lightPos(x, y, z, w) | lightDir(x, y, z)
     static void initCameraLight();
+    // Moves the light into eye space with the current modelview (like glLightfv) and hands it to the shaders
+    static void mirrorLight(int index, ShaderLight light, const GLfloat pos[4], const GLfloat dir[3]);
+    static ShaderLight shaderCameraLight;
 public:
     static void init();
     static void updateCameraLight(GLfloat lightPos[4], GLfloat lightDir[3]);
@@ -17,7 +21,8 @@ public:
         const GLfloat* diffuse,
         const GLfloat* specular,
         const GLfloat* emission,
-        GLfloat shininess
+        GLfloat shininess,
+        MaterialClass materialClass = MaterialClass::Lit
     );
 
     static void resetMaterial(GLenum face);
@@ -21,6 +21,10 @@ public:
     static void updateGhosts();
 	static void updatePlayerLives();
 	static void initLevel();
+	// Ghosts drop their routes and head for their corners again, e.g. after a map reload
+	static void replanGhosts();
+	// Flips every door, only routes and flow field entries through them are repaired
+	static void toggleDoors();
 };
 
 #endif
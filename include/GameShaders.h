@@ -0,0 +1,91 @@
+#ifndef GAMESHADERS_H
+#define GAMESHADERS_H
+
+#include "gl_includes.h"
+#include <string>
+
+// One program per material class, all share the light/material uniform blocks
+enum class MaterialClass {
+    Lit = 0,
+    LitTextured = 1,
+    Count = 2,
+};
+
+// std140 mirror of Light in assets/shaders/lighting.glsl
+struct ShaderLight {
+    GLfloat position[4] = { 0.0f, 0.0f, 1.0f, 0.0f };
+    GLfloat direction[4] = { 0.0f, 0.0f, -1.0f, 0.0f };   // w = 1 when enabled
+    GLfloat ambient[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    GLfloat diffuse[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    GLfloat specular[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    GLfloat spot[4] = { -1.0f, 0.0f, 0.0f, 0.0f };        // cos(cutoff), exponent
+    GLfloat attenuation[4] = { 1.0f, 0.0f, 0.0f, 0.0f };  // constant, linear, quadratic
+};
+
+// std140 mirror of MaterialBlock in assets/shaders/lighting.glsl
+struct ShaderMaterial {
+    GLfloat ambient[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    GLfloat diffuse[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    GLfloat specular[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    GLfloat emission[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    GLfloat shininess[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+};
+
+class GameShaders {
+public:
+    static constexpr int MAX_LIGHTS = 2;
+    static constexpr GLuint LIGHT_BLOCK_BINDING = 0;
+    static constexpr GLuint MATERIAL_BLOCK_BINDING = 1;
+
+    static constexpr const char* VERTEX_PATH = "assets/shaders/lit.vert";
+    static constexpr const char* LIGHTING_PATH = "assets/shaders/lighting.glsl";
+    static constexpr const char* LIT_FRAGMENT_PATH = "assets/shaders/lit.frag";
+    static constexpr const char* LIT_TEXTURED_FRAGMENT_PATH = "assets/shaders/lit_textured.frag";
+
+    static GameShaders& getInstance() {
+        static GameShaders instance;
+        return instance;
+    }
+
+    // Needs a current context and glewInit, returns false if the fixed-function path has to be used
+    bool init();
+    bool isEnabled() const { return enabled; }
+
+    void setLight(int index, const ShaderLight& light);
+    void setGlobalAmbient(const GLfloat ambient[4]);
+
+    // Binds the class program and uploads the material (skipped if unchanged)
+    void bindMaterial(MaterialClass materialClass, const ShaderMaterial& material);
+    void unbind();
+
+private:
+    GameShaders() = default;
+    GameShaders(const GameShaders&) = delete;
+    GameShaders& operator=(const GameShaders&) = delete;
+
+    // std140 mirror of LightBlock
+    struct LightBlock {
+        ShaderLight lights[MAX_LIGHTS];
+        GLfloat globalAmbient[4] = { 0.2f, 0.2f, 0.2f, 1.0f };
+    };
+
+    static bool readFile(const char* path, std::string& out);
+    static GLuint compileShader(GLenum type, const std::string& source, const char* name);
+    static GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader, const char* name);
+    void deletePrograms();
+
+    bool enabled = false;
+
+    GLuint programs[(int)MaterialClass::Count] = {};
+    GLuint lightUbo = 0;
+    GLuint materialUbo = 0;
+
+    LightBlock lightBlock;
+    bool lightsDirty = true;
+
+    ShaderMaterial boundMaterial;
+    bool materialValid = false;
+    GLuint boundProgram = 0;
+};
+
+#endif
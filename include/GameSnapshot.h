@@ -0,0 +1,27 @@
+#ifndef GAMESNAPSHOT_H
+#define GAMESNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Map.h"
+#include "Player.h"
+#include "Ghost.h"
+
+// Immutable per-tick copy of everything the render thread needs.
+// The map itself is shared (tiles only change in pellet and door state, which live in the MapState),
+// so a new level just swaps the pointer or restores the state, the old map dies with its last snapshot.
+struct GameSnapshot {
+    uint64_t tick = 0;
+    uint64_t mapGeneration = 0;     // bumped on every new level, HUD caches key off it
+    std::shared_ptr<Map> map;
+    MapState mapState;
+    PlayerRenderState player;
+    std::vector<GhostRenderState> ghosts;
+    int totalScore = 0;
+    int playerLives = 0;
+    int currentLevel = 0;
+    bool playerDying = false;
+};
+
+#endif
@@ -7,7 +7,7 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_mixer.h>
 
-static class GameSounds {
+class GameSounds {
 public:
     static GameSounds& getInstance() {
         static GameSounds instance;
@@ -3,9 +3,18 @@
 
 #include "gl_includes.h"
 #include "MovableEntity.h"
+#include "FlowField.h"
 #include <unordered_map>
 #include <deque>
 
+// Everything Ghost::render reads, copied out of the simulation every tick
+struct GhostRenderState {
+    Point3D origin;
+    BoundingBox3D boundingBox;
+    MoveDir moveDir = MoveDir::UNDEFINED;
+    float color[3] = { 0.0f, 1.0f, 0.0f };
+};
+
 class Ghost : public MovableEntity {
 private:
     static constexpr float DEFAULT_SPEED = 4.0f;
@@ -13,6 +22,10 @@ private:
     static const MoveDir DEFAULT_MOVE_DIR = MoveDir::UNDEFINED;
     static constexpr bool DEFAULT_DIR_CHANGE_REQUEST_EXPIRE = false;
     static constexpr float DEFAULT_DIR_CHANGE_REQUEST_EXPIRE_AFTER_MS = 1000;
+    // Tiles kept queued from the flow field, two so teleport pairs look like an A* path
+    static constexpr size_t FLOW_FIELD_LOOKAHEAD = 2;
+    // Tiles left on a partial (hierarchical) route when the rest is requested
+    static constexpr size_t CONTINUE_AHEAD = 4;
     MoveDir randomDirection();
     MoveDir randomTurnDirection();
     bool randomBool();
@@ -25,7 +38,6 @@ private:
     float heuristicCost(Tile* a, Tile* b);
     std::deque<Tile*> movePath = {};
 
-    std::deque<Tile*> shortestPathToTile(Tile* tile);
     MoveDir currentDirection = MoveDir::NONE;
     float colorR = 0.0f;
     float colorG = 1.0f;
@@ -33,6 +45,21 @@ private:
     std::string name = "";
     void createPathToTile(Tile* tile);
     Tile* tileToSwitchPathTo = nullptr;
+
+    // Async path request, the result is switched to at the tile center it was searched from
+    uint64_t pathTicket = 0;
+    bool hasReadyPath = false;
+    Tile* readyPathStart = nullptr;
+    std::deque<Tile*> readyPath;
+    bool readyPathPartial = false;
+    // Goal of the partial route being walked, searched further from its end
+    Tile* continueTo = nullptr;
+    void requestPath(Tile* target, Tile* start);
+    void pollPathRequest(Tile* tile, bool inCenter);
+    bool hasPendingPath() const { return pathTicket != 0 || hasReadyPath; }
+
+    const FlowField* flowField = nullptr;
+    void topUpPathFromFlowField(Tile* tile);
 public:
     Ghost();
     Ghost(const Ghost& other);
@@ -48,8 +75,21 @@ public:
         colorB = b;
     }
     bool isPathEmpty() { return movePath.empty(); }
+    // Once the queued path runs out, moveOnPath takes next hops from the field (nullptr = off)
+    void followFlowField(const FlowField* field) { flowField = field; }
+    bool isFollowingFlowField() const { return flowField != nullptr; }
+    // Last queued tile, the flow field is read from there on
+    Tile* getPathTail() const { return movePath.empty() ? nullptr : movePath.back(); }
     Tile* furthestTileTowardCorner(MapCorner mapCorner);
-    void clearMovePath() { movePath.clear(); }
+    // Synchronous search from the current tile, the game itself goes through the pathfinding queue
+    std::deque<Tile*> shortestPathToTile(Tile* tile);
+    void clearMovePath();
+    // Door tile toggled, truncates and re-requests routes that ran through it
+    void onDoorChanged(Tile* door, bool open);
+
+    // Snapshot exchange between the simulation and render thread
+    GhostRenderState getRenderState() const;
+    void applyRenderState(const GhostRenderState& state);
 };
 
 #endif // PLAYER_H
@@ -0,0 +1,86 @@
+#ifndef HEADLESSRENDERER_H
+#define HEADLESSRENDERER_H
+
+// Only built into the PACMAN_HEADLESS target (Linux CI, software GL through OSMesa)
+#ifdef PACMAN_HEADLESS
+
+#include "gl_includes.h"
+#include <GL/osmesa.h>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CameraModels.h"
+
+struct HeadlessOptions {
+    int width = 800;
+    int height = 600;
+    int frames = 600;
+    int warmupFrames = 30;          // rendered but left out of the report
+    float frameTimeS = 1.0f / 60.0f; // fixed game step, keeps replays deterministic
+    bool play = false;              // start a sandbox session instead of idling in the main menu
+    std::string replayPath;         // camera keyframes and key events, see loadReplay
+    std::string dumpDir;            // PNG output dir, empty = no dumps
+    int dumpEvery = 0;              // dump every n-th frame (0 = off)
+    std::string csvPath;            // per-frame samples, empty = none
+    std::string tracePath;          // Chrome trace JSON with CPU/GPU zones, empty = none
+    std::string mapPath;            // level map, empty = the game's default
+    bool generate = false;          // generated levels instead of the map, see MazeGenerator
+    uint32_t seed = 0;
+    std::string packPath;           // level pack (pacman_mapc --pack), empty = none
+    bool watch = false;             // reload the map in place when its file is saved, see MapWatcher
+};
+
+// Runs Game::render into an OSMesa framebuffer, replays a camera path / input
+// session and reports CPU frame times and draw calls
+class HeadlessRenderer {
+public:
+    explicit HeadlessRenderer(const HeadlessOptions& options) : options(options) {}
+    ~HeadlessRenderer();
+
+    bool init();
+    bool run();
+    void printReport(std::ostream& out) const;
+
+private:
+    struct CameraKeyframe {
+        int frame;
+        CameraState state;
+    };
+
+    struct InputEvent {
+        int frame;
+        unsigned char key;
+        bool pressed;
+    };
+
+    struct FrameResult {
+        double cpuMs;       // Game::render submission (FrameStats)
+        double totalMs;     // submission + glFinish, the software rasterizer runs on the CPU too
+        double gpuMs;       // sum of the GL_TIME_ELAPSED zones, -1 without timer queries
+        int drawCalls;
+    };
+
+    // Line based text format:
+    //   camera <frame> <yaw> <pitch> <distance> <lookAtX> <lookAtY> <lookAtZ>
+    //   key <frame> <char|esc> <down|up>
+    bool loadReplay(const std::string& path);
+    CameraState cameraStateAt(int frame) const;
+    CameraState defaultOrbitAt(int frame) const;
+    void feedInput(int frame);
+    bool dumpFrame(int frame) const;
+    bool writeCsv() const;
+
+    HeadlessOptions options;
+    OSMesaContext context = nullptr;
+    std::vector<GLubyte> colorBuffer;
+
+    std::vector<CameraKeyframe> cameraPath;
+    std::vector<InputEvent> inputEvents;
+    size_t nextInputEvent = 0;
+
+    std::vector<FrameResult> results;
+};
+
+#endif // PACMAN_HEADLESS
+#endif
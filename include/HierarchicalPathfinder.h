@@ -0,0 +1,101 @@
+#ifndef HIERARCHICALPATHFINDER_H
+#define HIERARCHICALPATHFINDER_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <shared_mutex>
+#include <vector>
+#include "Tile.h"
+#include "SearchStats.h"
+#include "PortalHeuristic.h"
+
+// HPA* for big generated maps. The grid is cut into square clusters, every run of
+// walkable tiles along a cluster border becomes an entrance (one or two transition
+// tiles per side, teleport links count as borders too) and the transitions inside a
+// cluster are joined by their in-cluster distances. A query searches that small
+// abstract graph and turns only the first few clusters of the route into tiles,
+// the caller asks again from the end of that piece when it gets there.
+// Keeps its own copy of walkability, searches may run on another thread while
+// setWalkable re-derives the clusters around a changed tile.
+class HierarchicalPathfinder {
+public:
+    static constexpr int DEFAULT_CLUSTER_SIZE = 16;
+    static constexpr int REFINE_CLUSTERS = 3;
+    static constexpr int MAX_SINGLE_TRANSITION_WIDTH = 6;   // wider entrances get one transition per end
+
+    struct Route {
+        std::deque<Tile*> tiles;    // after start, up to goal or the last refined transition
+        bool partial = false;       // true if the goal is still ahead
+    };
+
+    // grid is row-major with the given width, neighbour links (teleports too) must be set
+    void build(const std::vector<Tile*>& grid, int width, int height, int clusterSize = DEFAULT_CLUSTER_SIZE);
+    void clear();
+    bool isEmpty() const { return clusters.empty(); }
+
+    // Re-derives the entrances and in-cluster distances of the clusters touching the tile
+    void setWalkable(const Tile* tile, bool walkable);
+    // Tile objects swapped in at their row and column (map hot reload), links already set.
+    // Every touched cluster is derived once for the whole batch. Teleport changes need build().
+    void replaceTiles(const std::vector<Tile*>& changed);
+
+    // Empty tiles and partial == false if unreachable or start == goal
+    Route findPath(Tile* start, Tile* goal, int refineClusters = REFINE_CLUSTERS, SearchStats* stats = nullptr) const;
+
+    int getClusterCount() const { return (int)clusters.size(); }
+    int getTransitionCount() const;
+
+private:
+    struct Cluster {
+        int row = 0;
+        int col = 0;
+        int rows = 0;
+        int cols = 0;
+        std::vector<int> nodes;                         // transition tiles, sorted
+        std::vector<int> distances;                     // nodes x nodes, -1 = no way inside the cluster
+        std::vector<std::pair<int, int>> tileLinks;     // transition tile here -> tile in the other cluster
+
+        // Filled by renumberNodes, searches use global node ids
+        int firstNode = 0;                              // id of nodes[0]
+        std::vector<int> linkStarts;                    // per node into links, one extra at the end
+        std::vector<std::pair<int, int>> links;         // node index here, node id there
+    };
+
+    struct Transition {
+        int inside;     // tile index in the lower numbered cluster
+        int outside;
+    };
+
+    static uint64_t borderKey(int a, int b) { return a < b ? (uint64_t(a) << 32) | uint32_t(b) : (uint64_t(b) << 32) | uint32_t(a); }
+    int clusterOf(int tile) const { return (tile / width / clusterSize) * clusterCols + (tile % width) / clusterSize; }
+    bool contains(const Cluster& cluster, int tile) const;
+    int localIndex(const Cluster& cluster, int tile) const { return (tile / width - cluster.row) * cluster.cols + (tile % width - cluster.col); }
+    int indexOf(const Tile* tile) const { return tile->getTileRow() * width + tile->getTileCol(); }
+    // Walkable neighbours by tile index, teleports included
+    int neighborsOf(int tile, int out[4]) const;
+
+    void rebuildBorder(int a, int b);
+    void rebuildCluster(int cluster);
+    void renumberNodes();
+    // BFS inside one cluster, distances by localIndex (-1 unreachable), parents as tile indices
+    void searchCluster(int cluster, int from, std::vector<int>& distances, std::vector<int>* parents) const;
+    // Tiles after from up to to, both in the same cluster
+    bool refineInCluster(int cluster, int from, int to, std::deque<Tile*>& out) const;
+
+    int width = 0;
+    int height = 0;
+    int clusterSize = DEFAULT_CLUSTER_SIZE;
+    int clusterCols = 0;
+    std::vector<Tile*> tiles;
+    std::vector<uint8_t> walkable;
+    std::vector<Cluster> clusters;
+    std::map<uint64_t, std::vector<Transition>> borders;
+    std::vector<int> nodeTiles;                         // by node id
+    std::vector<int> nodeClusters;                      // by node id
+    PortalHeuristic portals;
+
+    mutable std::shared_mutex mutex;
+};
+
+#endif
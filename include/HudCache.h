@@ -0,0 +1,56 @@
+#ifndef HUDCACHE_H
+#define HUDCACHE_H
+
+#include "gl_includes.h"
+#include <functional>
+
+// World-space floor rectangle the cached HUD element covers (xz plane at height y)
+struct HudRect {
+    float x0 = 0.0f;
+    float z0 = 0.0f;
+    float x1 = 0.0f;
+    float z1 = 0.0f;
+    float y = 0.0f;
+};
+
+// Bakes a rarely changing HUD element (lives, score) into an FBO texture seen
+// from straight above and draws it as one textured floor quad every frame.
+class HudCache {
+public:
+    static constexpr float PIXELS_PER_UNIT = 64.0f;
+    static constexpr float QUAD_LIFT = 0.01f;   // keeps the quad above the floor tiles
+    static constexpr float BAKE_EYE_HEIGHT = 10.0f;
+
+    HudCache() = default;
+    ~HudCache();
+    HudCache(const HudCache&) = delete;
+    HudCache& operator=(const HudCache&) = delete;
+
+    // FBOs need GL 3.0 / ARB_framebuffer_object, callers draw directly otherwise
+    static bool isSupported();
+    // False once the FBO turned out incomplete on this driver
+    bool isUsable() const;
+
+    bool isStale(int key) const { return !valid || key != cachedKey; }
+    // Renders drawFn (world-space geometry inside rect) into the texture and remembers the key
+    bool bake(int key, const HudRect& rect, const std::function<void()>& drawFn);
+    void render() const;
+    void invalidate() { valid = false; }
+
+private:
+    bool ensureTarget(int width, int height);
+    void release();
+
+    GLuint framebuffer = 0;
+    GLuint colorTexture = 0;
+    GLuint depthBuffer = 0;
+    int textureWidth = 0;
+    int textureHeight = 0;
+
+    HudRect bakedRect;
+    int cachedKey = 0;
+    bool valid = false;
+    bool broken = false;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MapTemplate.h"
+
+// Many compiled maps in one file with an index and what the game needs per level
+// besides the board (name, difficulty, speeds), written by pacman_mapc --pack. Mapped
+// once, level N is one index lookup away and its MapTemplate reads the tables in
+// place, no other file is opened. Templates keep the pack mapped while they live.
+// Layout: header, index (one Entry per level), names, then the levels as .pmap bytes.
+// Little endian, levels 8 byte aligned. Bump VERSION on any layout change.
+class LevelPack : public std::enable_shared_from_this<LevelPack> {
+public:
+    static constexpr char MAGIC[4] = { 'P', 'P', 'A', 'K' };
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char* DEFAULT_PATH = "assets/maps/levels.ppak";
+
+    struct LevelInfo {
+        std::string name;
+        int difficulty = 0;
+        float playerSpeed = 0.0f;   // move speed on the level, 0 keeps the game's own curve
+        float ghostSpeed = 0.0f;    // 0 = a bit faster than the player, as without a pack
+    };
+
+    struct Level {
+        LevelInfo info;
+        std::shared_ptr<const MapTemplate> board;
+    };
+
+    // Null if the file does not open or its header and index do not check out
+    static std::shared_ptr<const LevelPack> open(const std::string& path);
+    static bool write(const std::vector<Level>& levels, const std::string& path);
+
+    int getLevelCount() const { return (int)header->levelCount; }
+    // level in [0, getLevelCount())
+    LevelInfo getInfo(int level) const;
+    // Null if the level's map does not validate
+    std::shared_ptr<const MapTemplate> loadTemplate(int level) const;
+
+    LevelPack(const LevelPack&) = delete;
+    LevelPack& operator=(const LevelPack&) = delete;
+
+private:
+    LevelPack() = default;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t levelCount;
+        uint32_t reserved;
+        uint64_t indexOffset;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+    };
+
+    struct Entry {
+        uint64_t offset;        // compiled map, from the start of the file
+        uint64_t size;
+        uint32_t nameOffset;    // into the names
+        uint32_t nameLength;
+        int32_t difficulty;
+        float playerSpeed;
+        float ghostSpeed;
+        uint32_t reserved;
+    };
+
+    bool validate() const;
+    const Entry& entry(int level) const { return reinterpret_cast<const Entry*>(file.data() + header->indexOffset)[level]; }
+
+    std::string path;
+    MappedFile file;
+    const Header* header = nullptr;
+};
+
+#endif
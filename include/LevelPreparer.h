@@ -0,0 +1,93 @@
+#ifndef LEVELPREPARER_H
+#define LEVELPREPARER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LevelPack.h"
+#include "Map.h"
+#include "MapTemplate.h"
+
+// Builds the next level's Map (tiles, pellets, NavGraph, cluster hierarchy) on a worker
+// thread while the current level is played, so the level transition only swaps the
+// pointer in. One request at a time, a new one replaces what was not started yet.
+// take() hands out the prepared map if it was built from the same source, waits if it
+// is still being built and builds it inline otherwise. Without the worker (headless)
+// take() always builds inline. Maps are built from a MapTemplate, the last board's is
+// kept so building it again (another session or game instance) skips the load.
+// Freeing a big map takes as long as a frame or more, so the old one is retired to the
+// worker too and dropped there once nobody else (snapshots, path jobs) holds it.
+class LevelPreparer {
+public:
+    static constexpr std::chrono::milliseconds RETIRE_POLL{ 100 };
+
+    // Where a level's map comes from, levels with the same source get the same board
+    struct Source {
+        std::string mapPath;
+        bool generated = false;
+        uint32_t seed = 0;          // MazeGenerator seed, only for generated boards
+        std::shared_ptr<const LevelPack> pack;  // level packLevel of the pack instead of the path
+        int packLevel = 0;
+
+        bool operator==(const Source& other) const = default;
+    };
+
+    static LevelPreparer& getInstance() {
+        static LevelPreparer instance;
+        return instance;
+    }
+
+    void start();
+    void stop();
+    bool isThreaded() const { return worker.joinable(); }
+
+    void prepare(const Source& source);
+    // Fresh map for the source, never one that was played on, nullptr if it has no board
+    std::shared_ptr<Map> take(const Source& source);
+    void retire(std::shared_ptr<Map> map);
+    // The source's file changed, drops its cached template and a map prepared from it,
+    // a build that is running starts over once it finishes
+    void forget(const Source& source);
+
+    uint64_t getPreparedTakes() const { return preparedTakes; }
+    uint64_t getInlineTakes() const { return inlineTakes; }
+
+private:
+    LevelPreparer() = default;
+    ~LevelPreparer() { stop(); }
+    LevelPreparer(const LevelPreparer&) = delete;
+    LevelPreparer& operator=(const LevelPreparer&) = delete;
+
+    std::shared_ptr<Map> build(const Source& source);
+    void workerLoop();
+    // Drops the retired maps only the preparer still holds, called with the lock held
+    void releaseRetired(std::unique_lock<std::mutex>& lock);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    Source pendingSource;
+    bool pending = false;
+    Source buildingSource;
+    bool building = false;
+    Source readySource;
+    std::shared_ptr<Map> ready;
+    std::vector<std::shared_ptr<Map>> retired;
+    Source templateSource;
+    std::shared_ptr<const MapTemplate> cachedTemplate;
+    // Bumped by forget(), a build that saw it change may have read the old file
+    uint64_t forgets = 0;
+
+    std::thread worker;
+    bool stopping = false;
+
+    std::atomic<uint64_t> preparedTakes{ 0 };
+    std::atomic<uint64_t> inlineTakes{ 0 };
+};
+
+#endif
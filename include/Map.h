@@ -6,8 +6,12 @@
 #include "Tile.h"
 #include "Point3D.h"
 #include "BoundingBox3D.h"
-#include "Map.h"
+#include "NavGraph.h"
+#include "HierarchicalPathfinder.h"
+#include "MapState.h"
 #include <memory>
+#include <cstdint>
+#include <atomic>
 
 struct MapCornerPoints {
     Point3D lowerLeft = Point3D();
@@ -16,6 +20,8 @@ struct MapCornerPoints {
     Point3D upperRight = Point3D();
 };
 
+class MapTemplate;
+
 enum class MapCorner {
     TOP_LEFT,
     TOP_RIGHT,
@@ -23,18 +29,25 @@ enum class MapCorner {
     BOTTOM_RIGHT
 };
 
-class Map {
+// Always owned by a shared_ptr, the pathfinding worker keeps it alive while it searches
+class Map : public std::enable_shared_from_this<Map> {
 public:
     static const std::vector<MapCorner> corners;
+    // From this size on path requests go through the cluster hierarchy instead of the NavGraph
+    static constexpr int HIERARCHY_MIN_TILES = 96 * 96;
     Map();
-    Map(const std::vector<std::vector<std::shared_ptr<Tile>>>& mapGrid, float tileSize, int totalPellets);
-    void render(bool resetHighlighted = false, int resetTimerMs = 5000);  // Draws the map
+    // navTables from a compiled map skip building the NavGraph
+    Map(const std::vector<std::vector<std::shared_ptr<Tile>>>& mapGrid, float tileSize, int totalPellets, const NavGraph::PackedView* navTables = nullptr);
+    // Draws the map, pellets and doors come from a (snapshot) state instead of the live tiles
+    void render(const MapState& state, bool resetHighlighted = false, int resetTimerMs = 5000);
     Tile* getTileWithPoint3D(Point3D point);
-    Tile* getTileAt(int row, int col);
+    Tile* getTileAt(int row, int col) const;
     std::vector<Tile*> getTilesWithBoundingBox(BoundingBox3D* boundingBox);
     void resetHighlightedTiles();
     void scheduleHighlightReset(int delay);
-    Tile* getRandomTile();
+    // Uniform over the walkable tiles connected to from (any walkable tile without one),
+    // one draw from a table built at load, nullptr only if there are none
+    Tile* getRandomTile(const Tile* from = nullptr);
     bool areAllPelletsCollected() const;
     bool collectPellet(Tile* tile);
     Tile* getPlayerSpawn();
@@ -42,19 +55,74 @@ public:
     Tile* getPinkySpawn();
     Tile* getInkySpawn();
     Tile* getClydeSpawn();
+    // False for a board without a level's spawns (one that failed to load)
+    bool hasAllSpawns();
     MapCornerPoints getMapCornerPoints() const { return mapCornerPoints; }
+    int getWidth() const { return width; }
+    // 1 up to the classic board, grows with the map's half diagonal. Zoom limits, clip
+    // planes and the sky sphere are multiplied by it so big maps fit in the view.
+    float getViewScale() const { return viewScale; }
+    // Junction graph built at load, ghosts search on this instead of single tiles
+    const NavGraph& getNavGraph() const { return navGraph; }
+    // HPA* on big maps, where the route may only cover the next few clusters (partial),
+    // NavGraph search otherwise. Safe to call from the pathfinding worker.
+    std::deque<Tile*> findPath(Tile* start, Tile* goal, bool& partial) const;
+    bool hasHierarchy() const { return hierarchy != nullptr; }
+    const HierarchicalPathfinder* getHierarchy() const { return hierarchy.get(); }
+    // Unique across all maps, changes whenever walkability changes (cached paths go stale)
+    uint64_t getTopologyVersion() const { return topologyVersion; }
+    void bumpTopologyVersion() { topologyVersion = nextTopologyVersion++; }
+    int getHeight() const { return height; }
+    const MapState& getState() const { return state; }
+    // As loaded, before anything was collected or toggled
+    const MapState& getInitialState() const { return initialState; }
+    // Pellets and doors back to the given state of this map, only tiles that differ are
+    // touched. Doors go through setDoorOpen, the topology version changes if one did.
+    bool restoreState(const MapState& target);
+    void resetState() { restoreState(initialState); }
+    // Board the map was built from, shared by every map of it (null if it was built straight from rows)
+    const std::shared_ptr<const MapTemplate>& getTemplate() const { return mapTemplate; }
+    void setTemplate(std::shared_ptr<const MapTemplate> source) { mapTemplate = std::move(source); }
+    const std::vector<Tile*>& getDoorTiles() const { return doorTiles; }
+    // Flags the door in the NavGraph instead of rebuilding it, so the topology version
+    // stays and callers repair their own paths. False if nothing changed.
+    bool setDoorOpen(Tile* door, bool open);
+    // Map hot reload (MapFactory::patchMap): the tiles take the place of the ones at their row
+    // and column, pellet and door bits follow their types as loaded. Replaced tiles live on
+    // until releaseReplacedTiles, old paths and searches may still point at them.
+    void replaceTiles(const std::vector<std::shared_ptr<Tile>>& tiles);
+    // Once routes are replanned and searches cancelled nobody points at the old tiles any more
+    void releaseReplacedTiles() { replacedTiles.clear(); replacedTiles.shrink_to_fit(); }
+    // After replaceTiles and relinking: NavGraph and tile tables built again, the hierarchy
+    // patched per tile (built again if a teleport changed), template dropped as stale
+    void rebuildNavigation(const std::vector<Tile*>& changed, bool teleportsChanged);
 private:
+    // Doors, NavGraph (from navTables if given), walkable tables and hierarchy from the grid
+    void buildNavigation(const NavGraph::PackedView* navTables);
+    std::vector<Tile*> gridTiles() const;
     Tile* getFirstTileOfType(TileType type);
     int totalPellets;
     std::vector<std::vector<std::shared_ptr<Tile>>> grid;
     int width;
     int height;
     float tileSize;
+    float viewScale = 1.0f;
     bool isHighlightResetScheduled = false;
     void renderWorldCoordinates(const Tile* tile);
     void renderTileCoordinates(const Tile* tile);
+    bool visibleTileRange(int& firstRow, int& lastRow, int& firstCol, int& lastCol) const;
     void drawCenterAxes(float length = 2.0f);
-    int mapCollectedPellets = 0;
+    MapState state;
+    MapState initialState;
+    std::shared_ptr<const MapTemplate> mapTemplate;
+    std::vector<Tile*> doorTiles;
+    std::vector<std::shared_ptr<Tile>> replacedTiles;
+    NavGraph navGraph;
+    std::shared_ptr<HierarchicalPathfinder> hierarchy;  // null below HIERARCHY_MIN_TILES
+    std::vector<Tile*> walkableTiles;                   // doors left out, no one should aim at them
+    std::vector<std::vector<Tile*>> componentTiles;     // the same split by NavGraph component
+    uint64_t topologyVersion = 0;
+    static std::atomic<uint64_t> nextTopologyVersion;
     MapCornerPoints mapCornerPoints;
 };
 
@@ -3,25 +3,58 @@
 
 #include "gl_includes.h"
 #include "Map.h"
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <vector>
+
+class MapTemplate;
+enum class WallType;
 
 class MapFactory {
 public:
-    MapFactory();
-    Map createMap();
-    static const int MAP_HEIGHT = 36;
-    static const int MAP_WIDTH = 28;
+    // Any size, the .pmap next to the text map is used when pacman_mapc compiled one
+    Map createMap(const std::string& mapPath = DEFAULT_MAP_PATH);
+    // Any size, one string per row in the .map character set, empty map if invalid. No template.
+    Map createMapFromRows(const std::vector<std::string>& rows);
+    // Board from MazeGenerator, the default map if no candidate passed
+    Map createGeneratedMap(uint32_t seed, int width = CLASSIC_WIDTH, int height = CLASSIC_HEIGHT);
+    // Fresh tiles from the template's tables, the map keeps the template. Empty map for null.
+    Map createMapFromTemplate(std::shared_ptr<const MapTemplate> source);
+    // Null if the map does not load, build as many maps from one template as needed
+    std::shared_ptr<const MapTemplate> loadTemplate(const std::string& mapPath = DEFAULT_MAP_PATH);
+    std::shared_ptr<const MapTemplate> generateTemplate(uint32_t seed, int width = CLASSIC_WIDTH, int height = CLASSIC_HEIGHT);
+    // Map hot reload: only tiles whose type differs from the rows are built anew, the walls
+    // around them classified again and the navigation patched (Map::replaceTiles). False with
+    // the map untouched if the rows are invalid or of another size, load those from scratch.
+    bool patchMap(Map& map, const std::vector<std::string>& rows, std::vector<Tile*>* changed = nullptr);
+    // Rows of a text map, false with a message if it can not be read or is too big
+    static bool readRows(const std::string& path, std::vector<std::string>& rows);
+    // False with a message if the rows would trip an assert or make an unplayable level
+    static bool validateRows(const std::vector<std::string>& rows, std::string& error);
+    // Forward slashes open on Windows too
+    static constexpr const char* DEFAULT_MAP_PATH = "assets/maps/1.map";
+    // The original board, the view scale (Map::getViewScale) and generated boards default to it
+    static const int CLASSIC_HEIGHT = 36;
+    static const int CLASSIC_WIDTH = 28;
     static constexpr float MAP_Y = 0.0f;
     static constexpr float TILE_SIZE = 1.0f;
 
 private:
     std::vector<std::vector<std::shared_ptr<Tile>>> grid;
+    int gridWidth = CLASSIC_WIDTH;
+    int gridHeight = CLASSIC_HEIGHT;
     bool isValidCoord(int x, int y);
     bool loadMapFile(const std::string& filename);
-    void generateEmptyMapFile(const std::string& filename);
-    void createDefaultGrid();
+    bool parseRows(const std::vector<std::string>& rows);
+    void clearGrid();
+    static bool tileTypeOf(char tileChar, TileType& type);
+    std::shared_ptr<Tile> createTile(TileType type, WallType wallType, int row, int col) const;
+    void setAdjacentNeighbors();
     void setTileNeighbors();
+    // Grid links of one tile of a live map, then its teleport pair if it is one
+    static void relinkTile(Map& map, Tile* tile);
+    static void linkTeleport(Map& map, Tile* tile);
     void setWallType();
     int getTotalGridPellets();
 };
@@ -0,0 +1,27 @@
+#ifndef MAPSTATE_H
+#define MAPSTATE_H
+
+#include <cstdint>
+#include <vector>
+
+// Everything about a map that changes while a level is played, the tiles, links and
+// graphs never do. One bit per tile (row * width + col), 128 bytes a bitset on the
+// classic board. Copied into every snapshot and restored to start a level over
+// without loading the map again (Map::restoreState).
+struct MapState {
+    std::vector<uint64_t> pelletBits;       // set while the pellet is still there
+    std::vector<uint64_t> closedDoorBits;   // set while the door is closed
+    int collectedPellets = 0;
+
+    static bool test(const std::vector<uint64_t>& bits, int index) {
+        return (size_t)index / 64 < bits.size() && (bits[index / 64] >> (index % 64)) & 1;
+    }
+    static void set(std::vector<uint64_t>& bits, int index, bool value) {
+        if (value) bits[index / 64] |= uint64_t(1) << (index % 64);
+        else bits[index / 64] &= ~(uint64_t(1) << (index % 64));
+    }
+    bool hasPellet(int index) const { return test(pelletBits, index); }
+    bool isDoorClosed(int index) const { return test(closedDoorBits, index); }
+};
+
+#endif
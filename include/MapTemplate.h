@@ -0,0 +1,76 @@
+#ifndef MAPTEMPLATE_H
+#define MAPTEMPLATE_H
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "CompiledMap.h"
+#include "MapState.h"
+#include "NavGraph.h"
+
+class Map;
+
+// A board as loaded, before anyone played on it: tile and wall types, teleport links,
+// spawns, the starting MapState and the NavGraph tables. Never changes once made, so
+// one template is shared by every Map built from it (each level, each session, any
+// number of game instances) and building one skips parsing, wall classification and
+// graph tracing (MapFactory::createMapFromTemplate). Reads a .pmap or a LevelPack
+// level in place through the mapping, or owns tables taken from a Map built from text
+// or the generator.
+class MapTemplate {
+public:
+    using Link = CompiledMap::Link;
+    using Spawn = CompiledMap::Spawn;
+
+    // Null if the file does not open or validate
+    static std::shared_ptr<const MapTemplate> open(const std::string& compiledPath);
+    // Compiled map inside someone else's mapping (LevelPack), owner keeps it mapped as long as the template lives
+    static std::shared_ptr<const MapTemplate> view(const uint8_t* data, size_t size, const std::string& name, std::shared_ptr<const void> owner);
+    // Tables of a map straight out of MapFactory, before anything was collected
+    static std::shared_ptr<const MapTemplate> capture(const Map& map);
+
+    MapTemplate(const MapTemplate&) = delete;
+    MapTemplate& operator=(const MapTemplate&) = delete;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getPelletCount() const { return pelletCount; }
+    // Row-major tile index, -1 if the map has none
+    int getSpawn(Spawn spawn) const { return spawns[spawn]; }
+    std::span<const uint8_t> getTileTypes() const { return tileTypes; }
+    std::span<const uint8_t> getWallTypes() const { return wallTypes; }
+    std::span<const Link> getLinks() const { return links; }
+    const NavGraph::PackedView& getNavTables() const { return navTables; }
+    const MapState& getInitialState() const { return initialState; }
+
+private:
+    MapTemplate() = default;
+    // Tables and initial state from the opened compiled map
+    void readCompiled();
+
+    int width = 0;
+    int height = 0;
+    int pelletCount = 0;
+    int spawns[CompiledMap::SPAWN_COUNT] = { -1, -1, -1, -1, -1 };
+    MapState initialState;
+
+    // Views into the mapping or the owned tables below
+    std::span<const uint8_t> tileTypes;
+    std::span<const uint8_t> wallTypes;
+    std::span<const Link> links;
+    NavGraph::PackedView navTables;
+
+    CompiledMap compiled;
+    std::shared_ptr<const void> owner;
+    std::vector<uint8_t> ownedTileTypes;
+    std::vector<uint8_t> ownedWallTypes;
+    std::vector<Link> ownedLinks;
+    std::vector<int32_t> ownedNavNodes;
+    std::vector<NavGraph::PackedEdge> ownedNavEdges;
+    std::vector<int32_t> ownedNavEdgeTiles;
+    std::vector<int32_t> ownedNavComponents;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef MAPWATCHER_H
+#define MAPWATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports .map files written in one directory, for reloading the map being played while
+// it is edited. inotify on Linux (writes and editors' rename-over saves), elsewhere the
+// modification times are compared every POLL_INTERVAL. poll() never blocks.
+class MapWatcher {
+public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{ 500 };
+
+    MapWatcher() = default;
+    ~MapWatcher();
+    MapWatcher(const MapWatcher&) = delete;
+    MapWatcher& operator=(const MapWatcher&) = delete;
+
+    bool start(const std::string& directory);
+    void stop();
+    bool isWatching() const { return watching; }
+
+    // Maps written since the last call, each once
+    std::vector<std::filesystem::path> poll();
+
+private:
+    static bool isMapFile(const std::filesystem::path& path) { return path.extension() == ".map"; }
+    // Fallback, files whose time differs from the last scan
+    void scan(std::vector<std::filesystem::path>* changed);
+
+    std::filesystem::path directory;
+    bool watching = false;
+#ifdef __linux__
+    int inotifyFd = -1;
+#endif
+    std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes;
+    std::chrono::steady_clock::time_point lastScan;
+};
+
+#endif
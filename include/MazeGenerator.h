@@ -0,0 +1,54 @@
+#ifndef MAZEGENERATOR_H
+#define MAZEGENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Left/right symmetric boards from a seed, as rows in the .map character set (feed them
+// to MapFactory::createMapFromRows). The left half is a depth-first maze on a lattice of
+// corridor cells around a fixed ghost house, braided so it has loops instead of dead
+// ends, then mirrored. One teleport row is mirrored too, so the pair is always on
+// opposite edges. A few candidates are built and validated on their own threads (all
+// pellets reachable from the player spawn, loop density, dead ends), the first one in
+// candidate order that passes wins, so a seed gives the same board however the threads
+// run. No std distributions, the same seed gives the same board on every platform.
+class MazeGenerator {
+public:
+    static constexpr int MAX_ROUNDS = 4;        // batches of candidates before giving up
+
+    struct Options {
+        int width = 28;                 // classic board, multiple of 4 and at least 20
+        int height = 36;                // even and at least 28, incl. 3 HUD rows on top and 2 below
+        int candidates = 4;             // generated and validated in parallel
+        float braidChance = 1.0f;       // per dead end, open a wall to another neighbour
+        float extraLoopChance = 0.04f;  // per remaining wall between two cells
+        float minLoopDensity = 5.0f;    // independent loops per 100 corridor tiles, 1.map has 7
+        int maxDeadEnds = 0;
+    };
+
+    struct Report {
+        int candidate = -1;             // index of the winner within its round
+        int rounds = 0;
+        float loopDensity = 0.0f;
+        int deadEnds = 0;
+        double ms = 0.0;                // wall time of the whole generate call
+    };
+
+    // False if the size is not supported or no candidate passed within MAX_ROUNDS
+    static bool generate(uint32_t seed, const Options& options, std::vector<std::string>& rows, Report* report = nullptr);
+    static bool isSupportedSize(int width, int height);
+
+private:
+    struct Candidate {
+        std::vector<std::string> rows;
+        bool valid = false;
+        float loopDensity = 0.0f;
+        int deadEnds = 0;
+    };
+
+    static void carve(uint64_t seed, const Options& options, std::vector<std::string>& rows);
+    static void validate(const Options& options, Candidate& candidate);
+};
+
+#endif
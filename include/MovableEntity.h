@@ -39,6 +39,8 @@ public:
     float getMoveSpeed() const;
     void setDirChangeRequestExpireAfterMs(uint64_t expireAfter) { this->dirChangeRequestExpireAfterMs = expireAfter; }
     float getMoveDirRotationAngle() const;
+    // Tile the entity counts as standing on
+    Tile* getCurrentTile() const { return currentTile(intersectingTiles(this)); }
 
 protected:
     // === State ===
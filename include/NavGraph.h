@@ -0,0 +1,120 @@
+#ifndef NAVGRAPH_H
+#define NAVGRAPH_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+#include "Tile.h"
+#include "SearchStats.h"
+#include "PortalHeuristic.h"
+
+// Corridor-compressed walkable graph of a map. Nodes are junctions and dead ends
+// (tiles without exactly two walkable neighbours), edges are the corridors between
+// them with their length and interior tiles. Searches only touch nodes, a corridor
+// tile as start or goal is spliced in through the edge it lies on.
+// Doors are always nodes and stay in the graph while closed, they are only flagged
+// as blocked, so toggling one never rebuilds anything.
+class NavGraph {
+public:
+    static constexpr int NONE = -1;
+
+    struct Edge {
+        int from = NONE;
+        int to = NONE;
+        int length = 0;                 // steps from node to node, interior tiles + 1
+        std::vector<Tile*> tiles;       // interior tiles, ordered from -> to
+    };
+
+    struct Node {
+        Tile* tile = nullptr;
+        std::vector<int> edges;         // a corridor looping back is listed twice
+    };
+
+    // Flat form of the tables for compiled maps, tiles as row-major indices
+    struct PackedEdge {
+        int32_t from;
+        int32_t to;
+        int32_t firstTile;              // into edgeTiles, the corridor is tileCount long
+        int32_t tileCount;
+    };
+
+    struct PackedView {
+        std::span<const int32_t> nodeTiles;
+        std::span<const PackedEdge> edges;
+        std::span<const int32_t> edgeTiles;
+        std::span<const int32_t> components;    // per tile
+        int componentCount = 0;
+    };
+
+    // grid is row-major with the given width, neighbour links (teleports too) must be set
+    void build(const std::vector<Tile*>& grid, int width, int height);
+    // Same graph as build() would give without tracing anything, false (and an empty
+    // graph) if the tables do not fit the grid
+    bool restore(const std::vector<Tile*>& grid, int width, int height, const PackedView& packed);
+    void pack(std::vector<int32_t>& nodeTiles, std::vector<PackedEdge>& packedEdges, std::vector<int32_t>& edgeTiles, std::vector<int32_t>& tileComponents) const;
+    void clear();
+    bool isEmpty() const { return nodes.empty(); }
+
+    // Tiles after start up to and including goal, empty if unreachable or start == goal
+    std::deque<Tile*> findPath(Tile* start, Tile* goal, SearchStats* stats = nullptr) const;
+
+    int getNodeCount() const { return (int)nodes.size(); }
+    int getEdgeCount() const { return (int)edges.size(); }
+    int getWalkableTileCount() const { return walkableTiles; }
+    const std::vector<Node>& getNodes() const { return nodes; }
+    const std::vector<Edge>& getEdges() const { return edges; }
+    bool isNode(const Tile* tile) const { return nodeAt(tile) != NONE; }
+    // Connected walkable area (teleports join areas), NONE for walls
+    int componentOf(const Tile* tile) const;
+    int getComponentCount() const { return componentCount; }
+    // Components treat doors as open, so this is only "maybe reachable" behind a closed one
+    bool isReachable(const Tile* from, const Tile* to) const;
+    // Teleport-aware distance estimates, also used by searches outside the graph
+    const PortalHeuristic& getPortals() const { return portals; }
+
+    // Safe against a search running on another thread, returns false if the tile is not a node
+    bool setBlocked(const Tile* tile, bool blocked);
+    bool isBlocked(int node) const { return blockedNodes[node].value.load(std::memory_order_relaxed); }
+
+private:
+    // Where a tile sits in the graph, either a node or position inside an edge
+    struct Location {
+        int node = NONE;
+        int edge = NONE;
+        int index = 0;                  // into Edge::tiles
+    };
+
+    // Copyable so the graph can still be copied along with its map
+    struct BlockedFlag {
+        std::atomic<bool> value{ false };
+        BlockedFlag() = default;
+        BlockedFlag(const BlockedFlag& other) : value(other.value.load()) {}
+        BlockedFlag& operator=(const BlockedFlag& other) { value = other.value.load(); return *this; }
+    };
+
+    int indexOf(const Tile* tile) const { return tile->getTileRow() * width + tile->getTileCol(); }
+    int nodeAt(const Tile* tile) const;
+    Location locate(const Tile* tile) const;
+    // Walkable or a door in any state, the structure the graph is built from
+    static bool isPassable(const Tile* tile);
+    static int walkableNeighborCount(const Tile* tile);
+    static std::vector<Tile*> walkableNeighbors(const Tile* tile);
+    int addNode(Tile* tile);
+    void traceEdges(int node);
+    void labelComponents(const std::vector<Tile*>& grid);
+
+    int width = 0;
+    int height = 0;
+    int walkableTiles = 0;
+    std::vector<Node> nodes;
+    std::vector<BlockedFlag> blockedNodes;  // per node, only doors are ever set
+    std::vector<Edge> edges;
+    std::vector<Location> locations;    // per tile, node == NONE && edge == NONE for walls
+    std::vector<int> components;        // per tile
+    int componentCount = 0;
+    PortalHeuristic portals;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Bounded LRU of searched paths keyed by (start, goal) tile index. Paths are
+// stored as tile indices back to back in one arena, compacted once evictions
+// have left it half empty. Everything is dropped when the map topology
+// version changes. Not thread safe, the owner locks around it.
+class PathCache {
+public:
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 512;
+    static constexpr size_t DEFAULT_MAX_ARENA_TILES = 64 * 1024;
+
+    explicit PathCache(size_t maxEntries = DEFAULT_MAX_ENTRIES, size_t maxArenaTiles = DEFAULT_MAX_ARENA_TILES)
+        : maxEntries(maxEntries), maxArenaTiles(maxArenaTiles) {}
+
+    // Clears the cache if the version differs from the cached one
+    void setVersion(uint64_t version);
+    uint64_t getVersion() const { return version; }
+
+    // Copies the path (tiles after start up to goal) and marks it recently used
+    bool find(uint32_t start, uint32_t goal, std::vector<uint32_t>& path);
+    // Unreachable goals are cached too, as empty paths
+    void insert(uint32_t start, uint32_t goal, const std::vector<uint32_t>& path);
+    void clear();
+    // Door closed: drops every path through the tile, the rest stay valid
+    size_t invalidateTile(uint32_t tile);
+    // Door opened: drops the cached "unreachable" answers. Paths that could now be
+    // shorter through the door are kept, they still lead to the goal.
+    size_t invalidateUnreachable();
+
+    size_t size() const { return entries.size(); }
+    // Read from the stats overlay on the render thread
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    uint64_t getEvictions() const { return evictions; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    static uint64_t makeKey(uint32_t start, uint32_t goal) { return (uint64_t(start) << 32) | goal; }
+    void evictOldest();
+    template <typename Predicate>
+    size_t eraseIf(Predicate predicate);
+    void compact();
+
+    size_t maxEntries;
+    size_t maxArenaTiles;
+    uint64_t version = 0;
+
+    std::list<Entry> entries;   // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> lookup;
+    std::vector<uint32_t> arena;
+    size_t liveTiles = 0;
+
+    std::atomic<uint64_t> hits{ 0 };
+    std::atomic<uint64_t> misses{ 0 };
+    std::atomic<uint64_t> evictions{ 0 };
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef PATHFINDINGQUEUE_H
+#define PATHFINDINGQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "Map.h"
+#include "PathCache.h"
+
+// Ghost path requests, searched on a worker thread over the map's NavGraph (or its
+// cluster hierarchy on big maps, see Map::findPath).
+// Callers get a ticket and poll it, the result is dropped if the ticket was
+// cancelled meanwhile (new request from the same ghost, new level). Without the
+// worker (headless) process() runs the queue inline within a time budget.
+// Repeated (start, goal) pairs are answered from a PathCache at submit time.
+// Door toggles only drop the cached paths they affect (see onDoorChanged).
+class PathfindingQueue {
+public:
+    static constexpr double DEFAULT_BUDGET_MS = 1.0;
+
+    enum class Status {
+        Pending,
+        Ready,
+        Unknown,    // cancelled or never submitted
+    };
+
+    static PathfindingQueue& getInstance() {
+        static PathfindingQueue instance;
+        return instance;
+    }
+
+    void start();
+    void stop();
+    bool isThreaded() const { return worker.joinable(); }
+
+    // Map is kept alive until the job is done, tiles must belong to it
+    uint64_t submit(std::shared_ptr<const Map> map, Tile* start, Tile* goal);
+    void cancel(uint64_t ticket);
+    void cancelAll();
+    // cancelAll, then waits for a search still running on the worker. Call before changing
+    // a map's tiles or graphs in place (map hot reload).
+    void cancelAllAndWait();
+    // Call after the door tile and the NavGraph flag changed. Searches already running
+    // finish on the old state and are not cached, their callers re-check the path.
+    void onDoorChanged(const Map& map, const Tile* door, bool open);
+    // On Ready the result is moved out and the ticket is forgotten. A partial path stops
+    // short of the goal, the caller asks again from its end.
+    Status take(uint64_t ticket, std::deque<Tile*>& path, Tile*& start, bool& partial);
+
+    // Inline mode, runs at least one job and stops once the budget is spent
+    void process(double budgetMs = DEFAULT_BUDGET_MS);
+
+    uint64_t getCompletedJobs() const { return completedJobs; }
+    uint64_t getCancelledJobs() const { return cancelledJobs; }
+    const PathCache& getCache() const { return cache; }
+
+private:
+    PathfindingQueue() = default;
+    ~PathfindingQueue() { stop(); }
+    PathfindingQueue(const PathfindingQueue&) = delete;
+    PathfindingQueue& operator=(const PathfindingQueue&) = delete;
+
+    struct Job {
+        uint64_t ticket = 0;
+        std::shared_ptr<const Map> map;
+        Tile* start = nullptr;
+        Tile* goal = nullptr;
+        uint64_t doorEpoch = 0;
+    };
+
+    struct Result {
+        Tile* start = nullptr;
+        std::deque<Tile*> path;
+        bool partial = false;
+    };
+
+    void workerLoop();
+    static uint32_t tileIndex(const Map& map, const Tile* tile) { return tile->getTileRow() * map.getWidth() + tile->getTileCol(); }
+    // Pops one live job and runs it, false if there was nothing to do
+    bool runOne(std::unique_lock<std::mutex>& lock);
+
+    std::mutex mutex;
+    std::condition_variable jobsAvailable;
+    std::condition_variable searchDone;
+    bool searching = false;             // a job runs without the lock
+    std::deque<Job> jobs;
+    std::unordered_set<uint64_t> liveTickets;
+    std::unordered_map<uint64_t, Result> results;
+    uint64_t nextTicket = 1;
+    uint64_t doorEpoch = 0;             // bumped per door toggle
+    PathCache cache;
+    std::vector<uint32_t> indexScratch;
+
+    std::thread worker;
+    bool stopping = false;
+
+    std::atomic<uint64_t> completedJobs{ 0 };
+    std::atomic<uint64_t> cancelledJobs{ 0 };
+};
+
+#endif
@@ -6,6 +6,17 @@
 #include <chrono>
 #include "SpeedoMeter.h"
 
+// Everything Player::render reads, copied out of the simulation every tick
+struct PlayerRenderState {
+    Point3D origin;
+    BoundingBox3D boundingBox;
+    MoveDir moveDir = MoveDir::NONE;
+    float mouthAnimationState = 0.0f;
+    float deathAnimationState = 0.0f;
+    bool deathAnimating = false;
+    float bodyColor[3] = { 1.0f, 1.0f, 0.0f };
+};
+
 class Player : public MovableEntity {
 private:
     bool invincibleBlink = false;
@@ -52,6 +63,10 @@ public:
     void forceSetMoveDir(MoveDir moveDir) { this->moveDir = moveDir; }
     void startDeathAnimation() { playerDeathAnimating = true, playerDeathAnimationState = 0.0f; };
 
+    // Snapshot exchange between the simulation and render thread
+    PlayerRenderState getRenderState() const;
+    void applyRenderState(const PlayerRenderState& state);
+
     uint64_t getBlinkDuration() const { return blinkDurationMs; }
     uint64_t getDirChangeRequestExpireAfterMs() const { return dirChangeRequestExpireAfterMs; }
     uint64_t getInvincibleEndTimeAfterMs() const { return invincibleEndTimeAfterMs; }
@@ -0,0 +1,21 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Minimal dependency-free PNG encoder (stored deflate blocks, no compression)
+// Meant for frame dumps / golden images, not for shipping assets
+class PngWriter {
+public:
+    // pixels: width * height * 4 bytes RGBA, flipVertically for bottom-up GL buffers
+    static bool writeRGBA(const std::string& path, int width, int height,
+                          const unsigned char* pixels, bool flipVertically = false);
+
+private:
+    static uint32_t crc32(const unsigned char* data, size_t length, uint32_t crc = 0);
+    static void appendChunk(std::vector<unsigned char>& out, const char type[4], const std::vector<unsigned char>& data);
+};
+
+#endif
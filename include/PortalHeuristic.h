@@ -0,0 +1,59 @@
+#ifndef PORTALHEURISTIC_H
+#define PORTALHEURISTIC_H
+
+#include <vector>
+#include "Tile.h"
+
+// Lower bound on the walking distance between two tiles that knows about teleports.
+// Plain Manhattan overestimates anything going through a tunnel, so A* both expands
+// most of the board and may miss the shorter wrap-around route. Portal tiles (tiles
+// linked to a neighbour that is not next to them on the grid) are collected once per
+// map and their distances to each other closed over, an estimate is then the minimum
+// of the direct distance and "walk to a portal, its best way on to the goal".
+class PortalHeuristic {
+public:
+    // Above this many portal tiles only the distance from the goal to its nearest portal is used
+    static constexpr int MAX_PORTALS = 64;
+
+    // Estimates toward one goal, portal costs folded in up front so each call is O(portals)
+    class Goal {
+    public:
+        int estimate(int fromRow, int fromCol) const;
+        int estimate(const Tile* tile) const { return estimate(tile->getTileRow(), tile->getTileCol()); }
+
+    private:
+        friend class PortalHeuristic;
+        struct Entry {
+            int row;
+            int col;
+            int toGoal;     // cheapest portal route from this portal tile to the goal
+        };
+        int row = 0;
+        int col = 0;
+        int viaNearest = -1;            // set instead of entries past MAX_PORTALS
+        std::vector<Entry> entries;
+    };
+
+    // grid is row-major, neighbour links (teleports too) must be set
+    void build(const std::vector<Tile*>& grid);
+    void clear();
+    bool isEmpty() const { return portals.empty(); }
+    int getPortalCount() const { return (int)portals.size(); }
+
+    Goal toward(const Tile* goal) const;
+    // One-off estimate, prefer toward() inside a search loop
+    int estimate(const Tile* from, const Tile* to) const { return toward(to).estimate(from); }
+
+private:
+    struct Portal {
+        int row;
+        int col;
+    };
+
+    static int manhattan(int rowA, int colA, int rowB, int colB) { return (rowA > rowB ? rowA - rowB : rowB - rowA) + (colA > colB ? colA - colB : colB - colA); }
+
+    std::vector<Portal> portals;
+    std::vector<int> distances;     // portals x portals, shortest over Manhattan hops and teleport links
+};
+
+#endif
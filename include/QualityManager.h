@@ -0,0 +1,85 @@
+#ifndef QUALITYMANAGER_H
+#define QUALITYMANAGER_H
+
+#include <chrono>
+
+enum class QualityLevel {
+    Low = 0,
+    Medium = 1,
+    High = 2,
+    Ultra = 3,      // the original hard-coded tessellation
+};
+
+// Tessellation and AA settings read by the renderers every frame
+struct QualitySettings {
+    int playerSegments;         // slices/stacks of the Pac-Man spheres
+    int ghostSegments;          // ghost head sphere
+    int skirtSegments;          // ghost skirt quad strip
+    int pelletSegments;
+    int cornerSegments;         // rounded wall corners
+    int worldSphereSegments;    // background sky sphere
+    bool multisample;
+};
+
+// Picks a quality level from the measured frame time against a refresh-rate budget.
+// Steps down when frames keep missing the budget, steps back up only after a long
+// run of comfortably fast frames, with a cooldown after every change (hysteresis).
+class QualityManager {
+public:
+    static constexpr int DEFAULT_TARGET_HZ = 60;
+    static constexpr float DOWNGRADE_RATIO = 1.15f;     // smoothed frame time above budget * this...
+    static constexpr int DOWNGRADE_FRAMES = 45;         // ...for this many frames in a row
+    static constexpr float UPGRADE_CPU_RATIO = 0.5f;    // render work below budget * this...
+    static constexpr int UPGRADE_FRAMES = 240;          // ...for this many frames in a row
+    static constexpr int COOLDOWN_FRAMES = 90;          // ignore frames after a change, they carry the old cost
+    static constexpr float SMOOTHING = 0.1f;            // EMA factor
+
+    static QualityManager& getInstance() {
+        static QualityManager instance;
+        return instance;
+    }
+
+    // Once per rendered frame with the CPU time of the frame (FrameStats)
+    void update(double cpuMs);
+    // Next update starts a new interval, e.g. after the game slept in a menu
+    void resetFrameTiming() { hasLastFrame = false; }
+
+    const QualitySettings& getSettings() const { return settings; }
+    QualityLevel getLevel() const { return level; }
+    void setLevel(QualityLevel newLevel);
+    static const char* levelName(QualityLevel level);
+
+    // Target refresh rate, e.g. 60, 120 or 144
+    void setTargetHz(int hz);
+    int getTargetHz() const { return targetHz; }
+    void cycleTargetHz();
+
+    // Fixed level when off (headless benchmarks want comparable frames)
+    void setAdaptive(bool enabled) { adaptive = enabled; }
+    bool isAdaptive() const { return adaptive; }
+
+    double getSmoothedFrameMs() const { return smoothedFrameMs; }
+    double getSmoothedCpuMs() const { return smoothedCpuMs; }
+    double getBudgetMs() const { return 1000.0 / targetHz; }
+
+private:
+    QualityManager() { setLevel(QualityLevel::Ultra); }
+    QualityManager(const QualityManager&) = delete;
+    QualityManager& operator=(const QualityManager&) = delete;
+
+    QualityLevel level = QualityLevel::Ultra;
+    QualitySettings settings = {};
+    int targetHz = DEFAULT_TARGET_HZ;
+    bool adaptive = true;
+
+    std::chrono::steady_clock::time_point lastFrame;
+    bool hasLastFrame = false;
+    bool seeded = false;
+    double smoothedFrameMs = 0.0;
+    double smoothedCpuMs = 0.0;
+    int slowFrames = 0;
+    int fastFrames = 0;
+    int cooldownFrames = COOLDOWN_FRAMES;
+};
+
+#endif
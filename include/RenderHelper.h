@@ -6,7 +6,7 @@
 #define RENDERHELPER_H
 
 // Helpers for rendering
-static class RenderHelper {
+class RenderHelper {
 private:
 public:
    static float cubicBezier(float p0, float p1, float p2, float p3, float t);
@@ -22,6 +22,9 @@ public:
    static void renderOuterRoundedCorner(float radius, float height,
        float startAngle, float endAngle,
        int segs);
+   // Drop-in replacements for glutSolidSphere/glutSolidCube, work without a GLUT window (headless)
+   static void solidSphere(double radius, int slices, int stacks);
+   static void solidCube(float size);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef SCENECACHE_H
+#define SCENECACHE_H
+
+#include "gl_includes.h"
+#include "CameraModels.h"
+
+// Last 3D frame copied into a texture, drawn behind the menus instead of the
+// whole scene while nothing in it moves (same camera, viewport and settings).
+class SceneCache {
+public:
+    SceneCache() = default;
+    ~SceneCache();
+    SceneCache(const SceneCache&) = delete;
+    SceneCache& operator=(const SceneCache&) = delete;
+
+    bool matches(const CameraGlu& camera, int width, int height, int settingsKey) const;
+    // Copies the current color buffer, call right after the 3D scene and before any 2D on top
+    void capture(const CameraGlu& camera, int width, int height, int settingsKey);
+    // Fullscreen quad of the captured frame, depth is left as cleared
+    void render() const;
+    void invalidate() { valid = false; }
+
+private:
+    GLuint texture = 0;
+    int textureWidth = 0;
+    int textureHeight = 0;
+
+    CameraGlu capturedCamera;
+    int capturedSettingsKey = -1;   // quality level plus anything else that changes the picture
+    bool valid = false;
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include <cstdint>
+
+// Optional out parameter of the path searches, filled in by benchmarks
+struct SearchStats {
+    uint64_t expanded = 0;      // nodes taken off the open list (stale entries not counted)
+};
+
+#endif
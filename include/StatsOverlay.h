@@ -0,0 +1,36 @@
+#ifndef STATSOVERLAY_H
+#define STATSOVERLAY_H
+
+#include "gl_includes.h"
+#include <string>
+#include <vector>
+
+// Top-left text panel with frame timings, draw calls and the current quality level.
+// Toggled with 'x', 't' cycles the quality target refresh rate while it is shown.
+class StatsOverlay {
+public:
+    static constexpr unsigned char TOGGLE_KEY = 'x';
+    static constexpr unsigned char TARGET_KEY = 't';
+
+    static StatsOverlay& getInstance() {
+        static StatsOverlay instance;
+        return instance;
+    }
+
+    void handleInput();
+    void render();
+
+    bool isVisible() const { return visible; }
+    void setVisible(bool value) { visible = value; }
+
+private:
+    StatsOverlay() = default;
+    StatsOverlay(const StatsOverlay&) = delete;
+    StatsOverlay& operator=(const StatsOverlay&) = delete;
+
+    std::vector<std::string> buildLines() const;
+
+    bool visible = false;
+};
+
+#endif
@@ -34,13 +34,16 @@ public:
     bool isWalkable() const;
     std::string getTileTypeString();
     TileType getTileType() const;
+    // Type the map was loaded with, never changes so the render thread can read it
+    TileType getInitialTileType() const { return initialTileType; }
     Point3D getCenterPoint() const;
     float distanceToCenter(const Tile& other) const;
    
     virtual void render() const;
     void renderEmpty() const;
     void renderPellet() const;
-    void renderDoorOpen() const;
+    // Open doors are pushed aside, closed ones sit in the middle of the tile
+    void renderDoor(bool closed) const;
     void renderHighlight() const;
 
     // Getter and Setter for neighboring tiles
@@ -65,11 +68,18 @@ public:
     bool isEqual(const Tile* other) const;
     bool isNeighbor(const Tile* other) const;
     bool isGhostHouseTile() const;
+    // Loaded as a door, open or closed
+    bool isDoor() const;
+    // No-op for anything that is not a door
+    void setDoorOpen(bool open);
+    // Back to the loaded type, puts an eaten pellet back
+    void resetTileType() { tileType = initialTileType; }
 private:
     void setTileType(TileType tileType);
     int tileRow;
     int tileCol;
     TileType tileType;
+    TileType initialTileType;
     Tile* tileUp = nullptr;
     Tile* tileDown = nullptr;
     Tile* tileLeft = nullptr;
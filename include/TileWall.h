@@ -31,7 +31,6 @@ public:
     // The remaining gap on each side, in fraction of tile
     static constexpr float GAP_FRAC = (MapFactory::TILE_SIZE - THICKNESS_FRAC) * 0.5f;
     static constexpr float INNER_RADIUS_FRAC = 0.3f;
-    static constexpr int   CYLINDER_SEGMENTS = 16;
 
     static constexpr float COLOR[3] = { 0.05f, 0.1f, 0.35f };
     static constexpr GLfloat LIGHT_AMBIENT[4] = { 0.05f, 0.1f, 0.2f, 1.0f };
@@ -64,6 +63,7 @@ public:
     ~TileWall() override = default;
     void render() const override;
     void setWallType(WallType wallType) { this->wallType = wallType; }
+    WallType getWallType() const { return wallType; }
     // Sets WallType according to neighbor tiles
     void setWallTypeByNeighbors();
 };
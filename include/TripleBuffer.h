@@ -0,0 +1,45 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer / single consumer triple buffer.
+// The writer fills writeBuffer() and publishes it, the reader grabs the newest
+// published slot with acquire() and reads it until the next acquire. Neither side
+// ever waits, the writer just overwrites a slot the reader has not picked up yet.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side
+    T& writeBuffer() { return slots[back]; }
+    void publish() {
+        // Hand the back slot over as the middle one and take the old middle for the next write
+        uint8_t previous = middle.exchange(uint8_t(back | DIRTY), std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // Reader side, returns true if a newer slot was published since the last call
+    bool acquire() {
+        if ((middle.load(std::memory_order_relaxed) & DIRTY) == 0) return false;
+        uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX_MASK;
+        return true;
+    }
+    const T& readBuffer() const { return slots[front]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    T slots[3];
+    uint8_t back = 0;                   // writer only
+    std::atomic<uint8_t> middle{ 1 };   // shared, slot index plus DIRTY bit
+    uint8_t front = 2;                  // reader only
+};
+
+#endif
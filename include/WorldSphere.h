@@ -24,7 +24,8 @@ public:
     ~WorldSphere();
 
     void init();
-    void render();
+    // Scale is the map's view scale, the sphere has to stay around the camera's zoom range
+    void render(float scale = 1.0f);
 
 private:
     WorldSphere() = default;
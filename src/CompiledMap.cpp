@@ -0,0 +1,172 @@
+#include "CompiledMap.h"
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "MapTemplate.h"
+#include "TileWall.h"
+
+static_assert(std::endian::native == std::endian::little, "Compiled maps are stored little endian");
+
+bool CompiledMap::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+    // Mappings start on a page boundary, the header and aligned sections can be read in place
+    if (!openBytes(file.data(), file.size(), path)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool CompiledMap::openBytes(const uint8_t* data, size_t size, const std::string& name) {
+    header = nullptr;
+    if (size < sizeof(Header)) {
+        std::cerr << "CompiledMap: " << name << " is too small" << std::endl;
+        return false;
+    }
+    if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+        std::cerr << "CompiledMap: " << name << " is not 8 byte aligned" << std::endl;
+        return false;
+    }
+    bytes = data;
+    length = size;
+    header = reinterpret_cast<const Header*>(data);
+    if (!validate(name)) {
+        header = nullptr;
+        bytes = nullptr;
+        length = 0;
+        return false;
+    }
+    return true;
+}
+
+void CompiledMap::close() {
+    header = nullptr;
+    bytes = nullptr;
+    length = 0;
+    file.close();
+}
+
+bool CompiledMap::validate(const std::string& path) const {
+    auto fail = [&](const std::string& what) {
+        std::cerr << "CompiledMap: " << path << ": " << what << std::endl;
+        return false;
+    };
+
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) return fail("not a compiled map");
+    if (header->version != VERSION) {
+        return fail("version " + std::to_string(header->version) + ", expected " + std::to_string(VERSION) + " (recompile with pacman_mapc)");
+    }
+    if (header->width <= 0 || header->height <= 0 || header->width > MAX_SIDE || header->height > MAX_SIDE) return fail("bad size");
+
+    for (int id = 0; id < SECTION_COUNT; ++id) {
+        const Section& s = header->sections[id];
+        if (s.offset % 8 != 0 || s.offset > length || s.size > length - s.offset) {
+            return fail("section " + std::to_string(id) + " out of bounds");
+        }
+    }
+
+    uint64_t tileCount = (uint64_t)header->width * header->height;
+    auto sizeIs = [&](SectionId id, uint64_t bytes) { return header->sections[id].size == bytes; };
+    auto multipleOf = [&](SectionId id, uint64_t bytes) { return header->sections[id].size % bytes == 0; };
+    if (!sizeIs(TILE_TYPES, tileCount) || !sizeIs(WALL_TYPES, tileCount) || !sizeIs(PELLETS, (tileCount + 63) / 64 * 8) ||
+        !sizeIs(NAV_COMPONENTS, tileCount * sizeof(int32_t)) || !multipleOf(LINKS, sizeof(Link)) ||
+        !multipleOf(NAV_NODES, sizeof(int32_t)) || !multipleOf(NAV_EDGES, sizeof(NavGraph::PackedEdge)) ||
+        !multipleOf(NAV_EDGE_TILES, sizeof(int32_t))) {
+        return fail("section sizes do not match the grid");
+    }
+
+    for (uint8_t type : getTileTypes()) {
+        if (type < (uint8_t)TileType::EMPTY || type > (uint8_t)TileType::EMPTY_UNWALKABLE) return fail("unknown tile type");
+    }
+    for (uint8_t type : getWallTypes()) {
+        if (type > (uint8_t)WallType::INNER_BOTTOM_RIGHT) return fail("unknown wall type");
+    }
+    for (const Link& link : getLinks()) {
+        if (link.tile < 0 || (uint64_t)link.tile >= tileCount || link.target < 0 || (uint64_t)link.target >= tileCount ||
+            link.direction < LINK_UP || link.direction > LINK_RIGHT) {
+            return fail("bad link");
+        }
+    }
+    for (int spawn = 0; spawn < SPAWN_COUNT; ++spawn) {
+        // Every level needs all of them, the game places the player and the ghosts there
+        if (header->spawns[spawn] < 0) return fail("missing spawn");
+        if (header->spawns[spawn] >= (int64_t)tileCount || spawnOf((TileType)getTileTypes()[header->spawns[spawn]]) != spawn) return fail("bad spawn");
+    }
+    // Map counts its pellets from the tile types, a bit anywhere else could never be eaten
+    std::span<const uint8_t> tileTypes = getTileTypes();
+    std::span<const uint64_t> pelletBits = getPelletBits();
+    int pellets = 0;
+    for (uint64_t index = 0; index < tileCount; ++index) {
+        bool bit = (pelletBits[index / 64] >> (index % 64)) & 1;
+        if (bit != (tileTypes[index] == (uint8_t)TileType::PELLET)) return fail("pellet bits do not match the pellet tiles");
+        pellets += bit;
+    }
+    if (tileCount % 64 != 0 && (pelletBits.back() >> (tileCount % 64)) != 0) return fail("pellet bits past the grid");
+    if (pellets != header->pelletCount) return fail("pellet count does not match the bitset");
+    // The NavGraph checks its own tables when restoring
+    return true;
+}
+
+CompiledMap::Spawn CompiledMap::spawnOf(TileType type) {
+    switch (type) {
+    case TileType::SPAWN_PLAYER: return SPAWN_PLAYER;
+    case TileType::SPAWN_BLINKY: return SPAWN_BLINKY;
+    case TileType::SPAWN_PINKY: return SPAWN_PINKY;
+    case TileType::SPAWN_INKY: return SPAWN_INKY;
+    case TileType::SPAWN_CLYDE: return SPAWN_CLYDE;
+    default: return SPAWN_COUNT;
+    }
+}
+
+NavGraph::PackedView CompiledMap::getNavTables() const {
+    NavGraph::PackedView view;
+    view.nodeTiles = section<int32_t>(NAV_NODES);
+    view.edges = section<NavGraph::PackedEdge>(NAV_EDGES);
+    view.edgeTiles = section<int32_t>(NAV_EDGE_TILES);
+    view.components = section<int32_t>(NAV_COMPONENTS);
+    view.componentCount = header->navComponentCount;
+    return view;
+}
+
+std::vector<uint8_t> CompiledMap::encode(const MapTemplate& source) {
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.width = source.getWidth();
+    header.height = source.getHeight();
+    header.pelletCount = source.getPelletCount();
+    for (int spawn = 0; spawn < SPAWN_COUNT; ++spawn) header.spawns[spawn] = source.getSpawn((Spawn)spawn);
+
+    const NavGraph::PackedView& nav = source.getNavTables();
+    header.navComponentCount = nav.componentCount;
+    std::span<const uint8_t> tileTypes = source.getTileTypes();
+    std::span<const uint8_t> wallTypes = source.getWallTypes();
+    std::span<const Link> links = source.getLinks();
+    const std::vector<uint64_t>& pelletBits = source.getInitialState().pelletBits;
+
+    std::vector<uint8_t> out(sizeof(Header));
+    auto append = [&](SectionId id, const void* data, size_t bytes) {
+        out.resize((out.size() + 7) & ~size_t(7), 0);
+        header.sections[id] = { out.size(), bytes };
+        const uint8_t* begin = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), begin, begin + bytes);
+    };
+    append(TILE_TYPES, tileTypes.data(), tileTypes.size());
+    append(WALL_TYPES, wallTypes.data(), wallTypes.size());
+    append(LINKS, links.data(), links.size() * sizeof(Link));
+    append(PELLETS, pelletBits.data(), pelletBits.size() * sizeof(uint64_t));
+    append(NAV_NODES, nav.nodeTiles.data(), nav.nodeTiles.size() * sizeof(int32_t));
+    append(NAV_EDGES, nav.edges.data(), nav.edges.size() * sizeof(NavGraph::PackedEdge));
+    append(NAV_EDGE_TILES, nav.edgeTiles.data(), nav.edgeTiles.size() * sizeof(int32_t));
+    append(NAV_COMPONENTS, nav.components.data(), nav.components.size() * sizeof(int32_t));
+    std::memcpy(out.data(), &header, sizeof(Header));
+    return out;
+}
+
+bool CompiledMap::write(const MapTemplate& source, const std::string& path) {
+    std::vector<uint8_t> out = encode(source);
+    // The game may have the old file mapped while a build recompiles it
+    return MappedFile::replace(path, out.data(), out.size());
+}
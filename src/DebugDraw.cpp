@@ -0,0 +1,375 @@
+#include "DebugDraw.h"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include "GameUserInput.h"
+#include "GameShaders.h"
+#include "FrameStats.h"
+
+namespace {
+
+struct Glyph {
+    char c;
+    uint8_t rows[7];    // top to bottom, bit 4 = leftmost column
+};
+
+// Enough for coordinates, tile types and short notes, lower case maps to upper
+const Glyph FONT[] = {
+    { '?', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 } },   // must stay first, fallback glyph
+    { ' ', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+    { '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+    { '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+    { '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+    { '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+    { '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+    { '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+    { '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+    { '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+    { '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+    { '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+    { 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } },
+    { 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+    { 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+    { 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+    { 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+    { 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+    { 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+    { 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+    { 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+    { 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+    { 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+    { 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+    { 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+    { 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+    { 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+    { 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+    { 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+    { 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+    { 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+    { 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+    { 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+    { 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+    { 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+    { 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+    { 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+    { 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+    { '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+    { ',', { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 } },
+    { ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+    { '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+    { '+', { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 } },
+    { '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+    { '_', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } },
+    { '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+    { '#', { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A } },
+    { '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } },
+    { ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+};
+
+constexpr int GLYPH_COUNT = sizeof(FONT) / sizeof(FONT[0]);
+
+int nextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+}
+
+void DebugDraw::handleInput() {
+    GameUserInput& guin = GameUserInput::getInstance();
+    if (guin.isKeyFlagPressedAndReleased(TOGGLE_KEY)) {
+        guin.resetKeyFlagPressedAndReleased(TOGGLE_KEY);
+        setEnabled(!enabled);
+    }
+}
+
+void DebugDraw::setEnabled(bool value) {
+    enabled = value;
+    if (!enabled) clear();
+}
+
+void DebugDraw::packColor(const DebugColor& color, GLubyte out[4]) {
+    auto toByte = [](float v) { return (GLubyte)(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f); };
+    out[0] = toByte(color.r);
+    out[1] = toByte(color.g);
+    out[2] = toByte(color.b);
+    out[3] = toByte(color.a);
+}
+
+void DebugDraw::line(const Point3D& a, const Point3D& b, const DebugColor& color) {
+    if (!enabled) return;
+    Vertex v;
+    packColor(color, v.rgba);
+    v.x = a.x; v.y = a.y; v.z = a.z;
+    lineVertices.push_back(v);
+    v.x = b.x; v.y = b.y; v.z = b.z;
+    lineVertices.push_back(v);
+}
+
+void DebugDraw::quad(const Point3D& a, const Point3D& b, const Point3D& c, const Point3D& d, const DebugColor& color) {
+    if (!enabled) return;
+    Vertex v;
+    packColor(color, v.rgba);
+    for (const Point3D* p : { &a, &b, &c, &a, &c, &d }) {
+        v.x = p->x; v.y = p->y; v.z = p->z;
+        triangleVertices.push_back(v);
+    }
+}
+
+void DebugDraw::box(const BoundingBox3D& abb, const DebugColor& color) {
+    if (!enabled) return;
+    const Point3D& lo = abb.min;
+    const Point3D& hi = abb.max;
+    Point3D c[8] = {
+        Point3D(lo.x, lo.y, lo.z), Point3D(hi.x, lo.y, lo.z), Point3D(hi.x, lo.y, hi.z), Point3D(lo.x, lo.y, hi.z),
+        Point3D(lo.x, hi.y, lo.z), Point3D(hi.x, hi.y, lo.z), Point3D(hi.x, hi.y, hi.z), Point3D(lo.x, hi.y, hi.z),
+    };
+
+    // Faces keep the old translucent look, edges make the box readable from above
+    quad(c[3], c[2], c[6], c[7], color);    // front (z = max)
+    quad(c[0], c[1], c[5], c[4], color);    // back (z = min)
+    quad(c[4], c[5], c[6], c[7], color);    // top
+    quad(c[0], c[1], c[2], c[3], color);    // bottom
+    quad(c[1], c[5], c[6], c[2], color);    // right
+    quad(c[0], c[4], c[7], c[3], color);    // left
+
+    DebugColor edge = color;
+    edge.a = 1.0f;
+    for (int i = 0; i < 4; i++) {
+        line(c[i], c[(i + 1) % 4], edge);
+        line(c[4 + i], c[4 + (i + 1) % 4], edge);
+        line(c[i], c[4 + i], edge);
+    }
+}
+
+void DebugDraw::cross(const Point3D& center, float size, const DebugColor& color) {
+    if (!enabled) return;
+    float h = size * 0.5f;
+    line(center - Point3D(h, 0.0f, 0.0f), center + Point3D(h, 0.0f, 0.0f), color);
+    line(center - Point3D(0.0f, h, 0.0f), center + Point3D(0.0f, h, 0.0f), color);
+    line(center - Point3D(0.0f, 0.0f, h), center + Point3D(0.0f, 0.0f, h), color);
+}
+
+void DebugDraw::label(const Point3D& position, const std::string& text, const DebugColor& color, int scale) {
+    if (!enabled || text.empty()) return;
+    Label l;
+    l.position = position;
+    l.textOffset = (uint32_t)labelText.size();
+    l.textLength = (uint32_t)text.size();
+    l.scale = std::max(scale, 1);
+    packColor(color, l.rgba);
+    labelText += text;
+    labels.push_back(l);
+}
+
+void DebugDraw::clear() {
+    lineVertices.clear();
+    triangleVertices.clear();
+    labels.clear();
+    labelText.clear();
+    textVertices.clear();
+}
+
+bool DebugDraw::initFont() {
+    atlasWidth = nextPowerOfTwo(ATLAS_COLS * CELL_W);
+    atlasHeight = nextPowerOfTwo(((GLYPH_COUNT + ATLAS_COLS - 1) / ATLAS_COLS) * CELL_H);
+
+    std::vector<GLubyte> pixels((size_t)atlasWidth * atlasHeight, 0);
+    for (int g = 0; g < GLYPH_COUNT; g++) {
+        int cellX = (g % ATLAS_COLS) * CELL_W;
+        int cellY = (g / ATLAS_COLS) * CELL_H;
+        for (int row = 0; row < GLYPH_H; row++) {
+            for (int col = 0; col < GLYPH_W; col++) {
+                if (FONT[g].rows[row] & (0x10 >> col)) {
+                    pixels[(size_t)(cellY + row) * atlasWidth + cellX + col] = 255;
+                }
+            }
+        }
+    }
+
+    // Unknown characters show up as '?'
+    for (int c = 0; c < 128; c++) glyphIndex[c] = 0;
+    for (int g = 0; g < GLYPH_COUNT; g++) {
+        glyphIndex[(unsigned char)FONT[g].c] = (uint8_t)g;
+        if (FONT[g].c >= 'A' && FONT[g].c <= 'Z') {
+            glyphIndex[(unsigned char)(FONT[g].c - 'A' + 'a')] = (uint8_t)g;
+        }
+    }
+
+    glGenTextures(1, &fontTexture);
+    if (!fontTexture) {
+        std::cerr << "DebugDraw: failed to create the font texture" << std::endl;
+        return false;
+    }
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlasWidth, atlasHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Drawn at whole pixel scales, nearest keeps the glyphs crisp
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+// Projects every label with the current matrices and lays out its glyph quads in window pixels
+void DebugDraw::buildTextVertices() {
+    textVertices.clear();
+    if (labels.empty()) return;
+
+    GLdouble modelview[16];
+    GLdouble projection[16];
+    GLint viewport[4];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    const float du = 1.0f / atlasWidth;
+    const float dv = 1.0f / atlasHeight;
+
+    for (const Label& l : labels) {
+        GLdouble wx, wy, wz;
+        if (gluProject(l.position.x, l.position.y, l.position.z, modelview, projection, viewport, &wx, &wy, &wz) != GL_TRUE) continue;
+        // Behind the camera or past the far plane
+        if (wz < 0.0 || wz > 1.0) continue;
+
+        float advance = (float)(CELL_W * l.scale);
+        float glyphW = (float)(GLYPH_W * l.scale);
+        float glyphH = (float)(GLYPH_H * l.scale);
+        // Snap to whole pixels so the nearest filter does not eat columns
+        float x = std::floor((float)wx - advance * l.textLength * 0.5f);
+        float y = std::floor((float)wy - glyphH * 0.5f);
+
+        for (uint32_t i = 0; i < l.textLength; i++, x += advance) {
+            unsigned char c = (unsigned char)labelText[l.textOffset + i];
+            if (c == ' ') continue;
+            int g = c < 128 ? glyphIndex[c] : 0;
+            float u0 = (g % ATLAS_COLS) * CELL_W * du;
+            float v0 = (g / ATLAS_COLS) * CELL_H * dv;
+            float u1 = u0 + GLYPH_W * du;
+            float v1 = v0 + GLYPH_H * dv;
+
+            // Atlas rows run top to bottom, window y runs up
+            TextVertex corners[4] = {
+                { x,          y,          u0, v1, {} },
+                { x + glyphW, y,          u1, v1, {} },
+                { x + glyphW, y + glyphH, u1, v0, {} },
+                { x,          y + glyphH, u0, v0, {} },
+            };
+            for (TextVertex& corner : corners) std::copy(l.rgba, l.rgba + 4, corner.rgba);
+            for (int index : { 0, 1, 2, 0, 2, 3 }) textVertices.push_back(corners[index]);
+        }
+    }
+}
+
+template <typename V>
+void DebugDraw::drawBatch(GLuint buffer, const std::vector<V>& vertices, GLenum mode) {
+    if (vertices.empty()) return;
+
+    const GLubyte* base = nullptr;
+    if (useBuffers) {
+        // Fresh storage every frame, the driver does not have to wait for last frame's draw
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(V), vertices.data(), GL_STREAM_DRAW);
+    }
+    else {
+        base = reinterpret_cast<const GLubyte*>(vertices.data());
+    }
+
+    if constexpr (std::is_same_v<V, TextVertex>) {
+        glVertexPointer(2, GL_FLOAT, sizeof(V), base + offsetof(TextVertex, x));
+        glTexCoordPointer(2, GL_FLOAT, sizeof(V), base + offsetof(TextVertex, u));
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(V), base + offsetof(TextVertex, rgba));
+    }
+    else {
+        glVertexPointer(3, GL_FLOAT, sizeof(V), base + offsetof(Vertex, x));
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(V), base + offsetof(Vertex, rgba));
+    }
+
+    glDrawArrays(mode, 0, (GLsizei)vertices.size());
+    FrameStats::getInstance().countDrawCalls(1);
+
+    if (useBuffers) glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void DebugDraw::flush() {
+    if (!enabled) {
+        clear();
+        return;
+    }
+    if (lineVertices.empty() && triangleVertices.empty() && labels.empty()) return;
+
+    if (!buffersReady) {
+        useBuffers = GLEW_VERSION_1_5;
+        if (useBuffers) {
+            glGenBuffers(1, &lineBuffer);
+            glGenBuffers(1, &triangleBuffer);
+            glGenBuffers(1, &textBuffer);
+        }
+        if (!initFont()) {
+            // Lines and quads still work without labels
+            labels.clear();
+        }
+        buffersReady = true;
+    }
+
+    // Text has to be laid out while the scene matrices are still current
+    if (fontTexture) buildTextVertices();
+
+    // Plain vertex colors, no lighting or shader programs
+    GameShaders::getInstance().unbind();
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_LINE_BIT | GL_TEXTURE_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Depth tested against the scene, but overlapping debug shapes must not hide each other
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glLineWidth(2.0f);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    drawBatch(triangleBuffer, triangleVertices, GL_TRIANGLES);
+    drawBatch(lineBuffer, lineVertices, GL_LINES);
+
+    if (!textVertices.empty()) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(viewport[0], viewport[0] + viewport[2], viewport[1], viewport[1] + viewport[3], -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, fontTexture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+        drawBatch(textBuffer, textVertices, GL_TRIANGLES);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glPopMatrix();  // modelview
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+    }
+
+    glPopClientAttrib();
+    glPopAttrib();
+
+    clear();
+}
@@ -1,5 +1,7 @@
 #include "Entity.h"
 #include <iostream>
+#include "DebugDraw.h"
+#include <cstdio>
 
 Entity::Entity(Point3D origin, BoundingBox3D boundingBox) {
 	this->origin = origin;
@@ -71,108 +73,18 @@ bool Entity::intersects(const Entity& otherEntity) const {
 }
 
 void Entity::renderBoundingBox(float r, float g, float b, float alpha) const {
-    BoundingBox3D abb = getAbsoluteBoundingBox();
-    glPushMatrix();
-
-    // Enable transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // Set the color with 10% opacity (red in this case)
-    glColor4f(r, g, b, alpha);
-
-    glBegin(GL_QUADS);
-
-    // Front face (z = max.z)
-    glVertex3f(abb.min.x, abb.min.y, abb.max.z);
-    glVertex3f(abb.max.x, abb.min.y, abb.max.z);
-    glVertex3f(abb.max.x, abb.max.y, abb.max.z);
-    glVertex3f(abb.min.x, abb.max.y, abb.max.z);
-
-    // Back face (z = min.z)
-    glVertex3f(abb.min.x, abb.min.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.min.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.max.y, abb.min.z);
-    glVertex3f(abb.min.x, abb.max.y, abb.min.z);
-
-    // Top face (y = max.y)
-    glVertex3f(abb.min.x, abb.max.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.max.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.max.y, abb.max.z);
-    glVertex3f(abb.min.x, abb.max.y, abb.max.z);
-
-    // Bottom face (y = min.y)
-    glVertex3f(abb.min.x, abb.min.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.min.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.min.y, abb.max.z);
-    glVertex3f(abb.min.x, abb.min.y, abb.max.z);
-
-    // Right face (x = max.x)
-    glVertex3f(abb.max.x, abb.min.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.max.y, abb.min.z);
-    glVertex3f(abb.max.x, abb.max.y, abb.max.z);
-    glVertex3f(abb.max.x, abb.min.y, abb.max.z);
-
-    // Left face (x = min.x)
-    glVertex3f(abb.min.x, abb.min.y, abb.min.z);
-    glVertex3f(abb.min.x, abb.max.y, abb.min.z);
-    glVertex3f(abb.min.x, abb.max.y, abb.max.z);
-    glVertex3f(abb.min.x, abb.min.y, abb.max.z);
-
-    glEnd();
-
-    // Disable transparency
-    glDisable(GL_BLEND);
-
-    glPopMatrix();
+    DebugDraw::getInstance().box(getAbsoluteBoundingBox(), DebugColor{ r, g, b, alpha });
 }
 
-// Debug function to render the origin as a small sphere
+// Debug marker at the origin, optionally with its coordinates next to it
 void Entity::renderOrigin(bool renderCoordinates) const {
-    glPushMatrix();
-
-    // Translate to the origin position
-    glTranslatef(origin.x, origin.y, origin.z);
-
-    // Color the origin as a debug marker (e.g., green)
-    glColor3f(0.0f, 1.0f, 0.0f);  // Green for origin
-
-    // Render a small sphere at the origin
-    glutSolidSphere(0.1f, 10, 10);  // A small sphere for the origin
-
-    glPopMatrix();
+    DebugDraw& debug = DebugDraw::getInstance();
+    debug.cross(origin, 0.2f, DebugColor{ 0.0f, 1.0f, 0.0f, 1.0f });
 
     if (renderCoordinates) {
-        // Switch to 2D text rendering
-        glDisable(GL_DEPTH_TEST);
-
-        glPushMatrix();
-        
-        // Offset the text from the origin by adding an offset to the x and y positions
-        float textOffsetX = 0.2f;  // X offset
-        float textOffsetY = 0.2f;  // Y offset
-        float textOffsetZ = 1.0f;
-        glTranslatef(origin.x + textOffsetX, origin.y + textOffsetY, origin.z + textOffsetZ); // Offset the text position
-
-        // Render the coordinates text
-        renderText("Origin: (" + std::to_string(origin.x) + ", " + std::to_string(origin.y) + ", " + std::to_string(origin.z) + ")");
-        
-        glPopMatrix();
-
-        glEnable(GL_DEPTH_TEST);
-
-        std::cout << "Origin: ("
-            << origin.x << ", "
-            << origin.y << ", "
-            << origin.z << ")"
-            << std::endl;
-    }
-}
-
-void Entity::renderText(const std::string& text) const {
-    // Use GLUT to render text
-    for (size_t i = 0; i < text.length(); ++i) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, text[i]);
+        char text[64];
+        std::snprintf(text, sizeof(text), "(%.2f, %.2f, %.2f)", origin.x, origin.y, origin.z);
+        debug.label(origin + Point3D(0.2f, 0.2f, 1.0f), text, DebugColor{ 0.0f, 1.0f, 0.0f, 1.0f });
     }
 }
 
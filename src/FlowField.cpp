@@ -0,0 +1,254 @@
+#include "FlowField.h"
+#include <algorithm>
+#include <queue>
+
+bool FlowField::update(Map* map, Tile* target, const std::vector<const Tile*>& reach) {
+    if (!map || !target || !target->isWalkable()) return false;
+    bool covered = true;
+    if (!complete) {
+        for (const Tile* tile : reach) {
+            if (tile && distanceTo(tile) == UNREACHABLE) covered = false;
+        }
+    }
+    if (map == builtMap && target == builtTarget && covered) return false;
+
+    builtMap = map;
+    builtTarget = target;
+    reachTiles = reach;
+    width = map->getWidth();
+    height = map->getHeight();
+    build();
+    version++;
+    return true;
+}
+
+void FlowField::buildLinks() {
+    linkedMap = builtMap;
+    linkedTopology = builtMap->getTopologyVersion();
+    size_t count = (size_t)width * height;
+    tiles.assign(count, nullptr);
+    links.assign(count * 4, NO_LINK);
+    doors.assign(count, 0);
+
+    auto linkable = [](const Tile* tile) { return tile && (tile->isWalkable() || tile->isDoor()); };
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            Tile* tile = builtMap->getTileAt(row, col);
+            int index = row * width + col;
+            tiles[index] = tile;
+            if (!linkable(tile)) continue;
+            doors[index] = tile->isDoor();
+            Tile* neighbors[4] = { tile->getTileUp(), tile->getTileDown(), tile->getTileLeft(), tile->getTileRight() };
+            for (int i = 0; i < 4; ++i) {
+                if (linkable(neighbors[i])) links[index * 4 + i] = indexOf(neighbors[i]);
+            }
+        }
+    }
+}
+
+void FlowField::build() {
+    size_t count = (size_t)width * height;
+    bool relinked = linkedMap != builtMap || linkedTopology != builtMap->getTopologyVersion();
+    if (relinked) buildLinks();
+
+    // Clearing only what the last search wrote keeps short searches short on big maps
+    if (relinked || repairedOutsideSearch || distances.size() != count) {
+        distances.assign(count, UNREACHABLE);
+        hops.assign(count, nullptr);
+    }
+    else {
+        for (int index : indexQueue) {
+            distances[index] = UNREACHABLE;
+            hops[index] = nullptr;
+        }
+    }
+    repairedOutsideSearch = false;
+    indexQueue.clear();
+    indexQueue.reserve(count);
+
+    std::vector<int> pending;
+    for (const Tile* tile : reachTiles) {
+        if (tile && (size_t)indexOf(tile) < count) pending.push_back(indexOf(tile));
+    }
+
+    int targetIndex = indexOf(builtTarget);
+    distances[targetIndex] = 0;
+    indexQueue.push_back(targetIndex);
+    complete = true;
+
+    // Moves are symmetric (teleport pairs link both ways), so searching out from the
+    // target gives every tile its distance to it
+    int settledDistance = 0;
+    for (size_t head = 0; head < indexQueue.size(); ++head) {
+        int current = indexQueue[head];
+        // Everything up to this distance is settled, hop chains included
+        if (!pending.empty() && distances[current] > settledDistance) {
+            settledDistance = distances[current];
+            bool reached = std::all_of(pending.begin(), pending.end(), [this](int index) { return distances[index] != UNREACHABLE; });
+            if (reached) {
+                complete = false;
+                break;
+            }
+        }
+        int nextDistance = distances[current] + 1;
+        for (int i = 0; i < 4; ++i) {
+            int index = links[current * 4 + i];
+            if (index == NO_LINK || distances[index] != UNREACHABLE) continue;
+            if (doors[index] && !tiles[index]->isWalkable()) continue;
+            distances[index] = nextDistance;
+            hops[index] = tiles[current];
+            indexQueue.push_back(index);
+        }
+    }
+}
+
+Tile* FlowField::nextHop(const Tile* from) const {
+    if (!from || !builtMap) return nullptr;
+    int index = indexOf(from);
+    if (index < 0 || (size_t)index >= hops.size()) return nullptr;
+    return hops[index];
+}
+
+int FlowField::distanceTo(const Tile* from) const {
+    if (!from || !builtMap) return UNREACHABLE;
+    int index = indexOf(from);
+    if (index < 0 || (size_t)index >= distances.size()) return UNREACHABLE;
+    return distances[index];
+}
+
+int FlowField::neighborsOf(const Tile* tile, Tile* out[4]) {
+    int count = 0;
+    for (Tile* neighbor : { tile->getTileUp(), tile->getTileDown(), tile->getTileLeft(), tile->getTileRight() }) {
+        if (neighbor && neighbor->isWalkable()) out[count++] = neighbor;
+    }
+    return count;
+}
+
+int FlowField::repair(Tile* changed) {
+    if (!builtMap || !changed) return 0;
+    int index = indexOf(changed);
+    if (index < 0 || (size_t)index >= distances.size()) return 0;
+
+    // The repairs need every reachable tile to have its distance, search again instead
+    if (!complete) {
+        if (builtTarget->isWalkable()) build();
+        else {
+            distances.assign(distances.size(), UNREACHABLE);
+            hops.assign(hops.size(), nullptr);
+            complete = true;
+        }
+        version++;
+        return (int)indexQueue.size();
+    }
+    repairedOutsideSearch = true;
+
+    // The target itself changed, nothing to keep
+    if (changed == builtTarget) {
+        if (changed->isWalkable()) build();
+        else {
+            distances.assign(distances.size(), UNREACHABLE);
+            hops.assign(hops.size(), nullptr);
+        }
+        version++;
+        return (int)distances.size();
+    }
+
+    int repaired = changed->isWalkable() ? repairOpened(changed) : repairClosed(changed);
+    if (repaired > 0) version++;
+    return repaired;
+}
+
+// Distances only shrink, a BFS out of the opened tile lowers everything it improves
+int FlowField::repairOpened(Tile* opened) {
+    Tile* neighbors[4];
+    int best = UNREACHABLE;
+    Tile* via = nullptr;
+    for (int i = 0, n = neighborsOf(opened, neighbors); i < n; ++i) {
+        int distance = distances[indexOf(neighbors[i])];
+        if (distance == UNREACHABLE) continue;
+        if (best == UNREACHABLE || distance + 1 < best) {
+            best = distance + 1;
+            via = neighbors[i];
+        }
+    }
+    int index = indexOf(opened);
+    if (!via || (distances[index] != UNREACHABLE && distances[index] <= best)) return 0;
+
+    distances[index] = best;
+    hops[index] = via;
+    queue.clear();
+    queue.push_back(opened);
+
+    int repaired = 1;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Tile* current = queue[head];
+        int nextDistance = distances[indexOf(current)] + 1;
+        for (int i = 0, n = neighborsOf(current, neighbors); i < n; ++i) {
+            int neighborIndex = indexOf(neighbors[i]);
+            if (distances[neighborIndex] != UNREACHABLE && distances[neighborIndex] <= nextDistance) continue;
+            distances[neighborIndex] = nextDistance;
+            hops[neighborIndex] = current;
+            queue.push_back(neighbors[i]);
+            repaired++;
+        }
+    }
+    return repaired;
+}
+
+// Only tiles whose hop chain ran through the closed tile lose their distance. They are
+// reset, seeded from their untouched neighbours and settled again in distance order.
+int FlowField::repairClosed(Tile* closed) {
+    int closedIndex = indexOf(closed);
+    if (distances[closedIndex] == UNREACHABLE) return 0;
+
+    // Subtree below the closed tile, hops point towards the target so children point at us
+    queue.clear();
+    queue.push_back(closed);
+    std::vector<bool> affected(distances.size(), false);
+    affected[closedIndex] = true;
+    Tile* neighbors[4];
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Tile* current = queue[head];
+        for (int i = 0, n = neighborsOf(current, neighbors); i < n; ++i) {
+            int index = indexOf(neighbors[i]);
+            if (affected[index] || hops[index] != current) continue;
+            affected[index] = true;
+            queue.push_back(neighbors[i]);
+        }
+    }
+    for (Tile* tile : queue) {
+        distances[indexOf(tile)] = UNREACHABLE;
+        hops[indexOf(tile)] = nullptr;
+    }
+
+    using Entry = std::pair<int, int>;  // distance, tile index
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    for (Tile* tile : queue) {
+        if (!tile->isWalkable()) continue;
+        int index = indexOf(tile);
+        for (int i = 0, n = neighborsOf(tile, neighbors); i < n; ++i) {
+            int neighborIndex = indexOf(neighbors[i]);
+            if (affected[neighborIndex] || distances[neighborIndex] == UNREACHABLE) continue;
+            if (distances[index] == UNREACHABLE || distances[neighborIndex] + 1 < distances[index]) {
+                distances[index] = distances[neighborIndex] + 1;
+                hops[index] = neighbors[i];
+            }
+        }
+        if (distances[index] != UNREACHABLE) open.push({ distances[index], index });
+    }
+
+    while (!open.empty()) {
+        auto [distance, index] = open.top();
+        open.pop();
+        if (distance > distances[index]) continue;    // stale entry
+        Tile* current = builtMap->getTileAt(index / width, index % width);
+        for (int i = 0, n = neighborsOf(current, neighbors); i < n; ++i) {
+            int neighborIndex = indexOf(neighbors[i]);
+            if (distances[neighborIndex] != UNREACHABLE && distances[neighborIndex] <= distance + 1) continue;
+            distances[neighborIndex] = distance + 1;
+            hops[neighborIndex] = current;
+            open.push({ distance + 1, neighborIndex });
+        }
+    }
+    return (int)queue.size();
+}
@@ -0,0 +1,174 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+void FrameStats::initGpuTimers() {
+    if (gpuTimersEnabled) return;
+    // GL_TIME_ELAPSED is core in 3.3, otherwise ARB_timer_query
+    if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query) {
+        std::cerr << "FrameStats: timer queries not available, GPU zones disabled" << std::endl;
+        return;
+    }
+    for (GpuFrame& gpuFrame : gpuFrames) {
+        glGenQueries(MAX_ZONES, gpuFrame.queries);
+        gpuFrame.pending = false;
+    }
+    gpuTimersEnabled = true;
+}
+
+void FrameStats::beginFrame() {
+    auto now = std::chrono::steady_clock::now();
+    if (!started) {
+        firstFrameStart = now;
+        started = true;
+    }
+    frameStart = now;
+    currentDrawCalls = 0;
+
+    currentFrame.zones.clear();
+    currentFrame.frame = frameCounter++;
+    currentFrame.startMs = msSince(firstFrameStart, now);
+    currentFrame.gpuMs = -1.0;
+    zoneOpen = false;
+
+    if (gpuTimersEnabled) {
+        // The slot comes around again after GPU_LATENCY_FRAMES frames, by then its queries are normally done
+        GpuFrame& gpuFrame = gpuFrames[currentFrame.frame % GPU_LATENCY_FRAMES];
+        resolveGpuFrame(gpuFrame, false);
+        gpuFrame.zoneCount = 0;
+        currentGpuFrame = &gpuFrame;
+    }
+}
+
+void FrameStats::endFrame() {
+    if (zoneOpen) endZone();
+
+    auto frameEnd = std::chrono::steady_clock::now();
+    currentFrame.cpuMs = msSince(frameStart, frameEnd);
+    currentFrame.drawCalls = currentDrawCalls;
+    lastFrame = currentFrame;
+    if (recording) {
+        history.push_back(lastFrame);
+    }
+
+    if (currentGpuFrame) {
+        currentGpuFrame->sample = lastFrame;
+        currentGpuFrame->historyIndex = recording ? (long long)history.size() - 1 : -1;
+        currentGpuFrame->pending = currentGpuFrame->zoneCount > 0;
+        currentGpuFrame = nullptr;
+    }
+}
+
+void FrameStats::beginZone(const char* name) {
+    // No nesting, close whatever is still open
+    if (zoneOpen) endZone();
+
+    zoneStart = std::chrono::steady_clock::now();
+    ZoneSample zone;
+    zone.name = name;
+    zone.cpuStartMs = msSince(frameStart, zoneStart);
+    currentFrame.zones.push_back(zone);
+    zoneOpen = true;
+
+    // Query i belongs to zone i, zones past MAX_ZONES stay CPU only
+    if (currentGpuFrame && currentGpuFrame->zoneCount == (int)currentFrame.zones.size() - 1 &&
+        currentGpuFrame->zoneCount < MAX_ZONES) {
+        glBeginQuery(GL_TIME_ELAPSED, currentGpuFrame->queries[currentGpuFrame->zoneCount]);
+    }
+}
+
+void FrameStats::endZone() {
+    if (!zoneOpen) return;
+    zoneOpen = false;
+
+    ZoneSample& zone = currentFrame.zones.back();
+    zone.cpuMs = msSince(zoneStart, std::chrono::steady_clock::now());
+
+    if (currentGpuFrame && currentGpuFrame->zoneCount == (int)currentFrame.zones.size() - 1 &&
+        currentGpuFrame->zoneCount < MAX_ZONES) {
+        glEndQuery(GL_TIME_ELAPSED);
+        currentGpuFrame->zoneCount++;
+    }
+}
+
+void FrameStats::resolveGpuFrame(GpuFrame& gpuFrame, bool wait) {
+    if (!gpuFrame.pending) return;
+    gpuFrame.pending = false;
+
+    // Queries finish in order, the last one being ready means all are.
+    // Still busy after GPU_LATENCY_FRAMES frames: drop the frame rather than stall the pipeline.
+    if (!wait) {
+        GLint available = 0;
+        glGetQueryObjectiv(gpuFrame.queries[gpuFrame.zoneCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+    }
+
+    FrameSample& sample = gpuFrame.sample;
+    double totalMs = 0.0;
+    for (int i = 0; i < gpuFrame.zoneCount && i < (int)sample.zones.size(); i++) {
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(gpuFrame.queries[i], GL_QUERY_RESULT, &elapsedNs);
+        sample.zones[i].gpuMs = elapsedNs / 1.0e6;
+        totalMs += sample.zones[i].gpuMs;
+    }
+    sample.gpuMs = totalMs;
+    lastGpuFrame = sample;
+
+    if (gpuFrame.historyIndex >= 0 && gpuFrame.historyIndex < (long long)history.size() &&
+        history[gpuFrame.historyIndex].frame == sample.frame) {
+        history[gpuFrame.historyIndex] = sample;
+    }
+}
+
+void FrameStats::flushGpuTimers() {
+    if (!gpuTimersEnabled) return;
+    // Oldest first so lastGpuFrame ends up being the newest
+    GpuFrame* order[GPU_LATENCY_FRAMES];
+    for (int i = 0; i < GPU_LATENCY_FRAMES; i++) order[i] = &gpuFrames[i];
+    std::sort(order, order + GPU_LATENCY_FRAMES, [](const GpuFrame* a, const GpuFrame* b) { return a->sample.frame < b->sample.frame; });
+    for (GpuFrame* gpuFrame : order) {
+        resolveGpuFrame(*gpuFrame, true);
+    }
+}
+
+// CPU zones on one track, GPU zones on another. TIME_ELAPSED has no start time, the GPU
+// track places each zone at its submission or right after the previous one (the GPU runs in order).
+bool FrameStats::writeTrace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "FrameStats: failed to open " << path << std::endl;
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n"
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    auto event = [&](const char* name, int tid, double startMs, double durationMs) {
+        file << ",\n{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+             << ",\"ts\":" << startMs * 1000.0 << ",\"dur\":" << durationMs * 1000.0;
+    };
+
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    double gpuCursorMs = 0.0;
+    for (const FrameSample& sample : history) {
+        event("frame", 1, sample.startMs, sample.cpuMs);
+        file << ",\"args\":{\"frame\":" << sample.frame << ",\"drawCalls\":" << sample.drawCalls
+             << ",\"gpuMs\":" << sample.gpuMs << "}}";
+
+        for (const ZoneSample& zone : sample.zones) {
+            event(zone.name, 1, sample.startMs + zone.cpuStartMs, zone.cpuMs);
+            file << "}";
+            if (zone.gpuMs >= 0.0) {
+                double gpuStartMs = std::max(gpuCursorMs, sample.startMs + zone.cpuStartMs);
+                event(zone.name, 2, gpuStartMs, zone.gpuMs);
+                file << "}";
+                gpuCursorMs = gpuStartMs + zone.gpuMs;
+            }
+        }
+    }
+    file << "\n]}\n";
+    return file.good();
+}
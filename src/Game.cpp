@@ -13,28 +13,55 @@
 #include <vector>      
 #include "GameSounds.h"
 #include "WorldSphere.h"
+#include "RenderHelper.h"
+#include "FrameStats.h"
+#include "QualityManager.h"
+#include "StatsOverlay.h"
+#include "DebugDraw.h"
+#include "PathfindingQueue.h"
+#include "LevelPreparer.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 
 // Global wrapper functions to be passed to GLUT
-static void keyboardCallback(unsigned char key, int x, int y) { GameUserInput::getInstance().keyboard(tolower(key), x, y); }
-static void keyboardUpCallback(unsigned char key, int x, int y) { GameUserInput::getInstance().keyboardUp(tolower(key), x, y); }
-static void mouseButtonCallback(int button, int state, int x, int y) { GameUserInput::getInstance().mouseButton(button, state, x, y); }
-static void mouseMotionCallback(int x, int y) { GameUserInput::getInstance().mouseMotion(x, y); }
+// (every input also wakes a sleeping update loop)
+static void keyboardCallback(unsigned char key, int x, int y) { GameUserInput::getInstance().keyboard(tolower(key), x, y); Game::wake(); }
+static void keyboardUpCallback(unsigned char key, int x, int y) { GameUserInput::getInstance().keyboardUp(tolower(key), x, y); Game::wake(); }
+static void mouseButtonCallback(int button, int state, int x, int y) { GameUserInput::getInstance().mouseButton(button, state, x, y); Game::wake(); }
+static void mouseMotionCallback(int x, int y) { GameUserInput::getInstance().mouseMotion(x, y); Game::wake(); }
 
 
 // Inits new game
 void Game::init() {
     GameSounds::getInstance().init();
 
+    // Load GL entry points, needed by the shader path
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK) {
+        std::cerr << "glewInit failed: " << glewGetErrorString(glewStatus) << std::endl;
+    }
+    else {
+        FrameStats::getInstance().initGpuTimers();
+    }
+
     // Register mouse callback functions
-    glutMouseFunc(mouseButtonCallback);
-    glutPassiveMotionFunc(mouseMotionCallback);
-    glutMotionFunc(mouseMotionCallback);
-    glutKeyboardFunc(keyboardCallback);
-    glutKeyboardUpFunc(keyboardUpCallback);
+    if (!headless) {
+        glutMouseFunc(mouseButtonCallback);
+        glutPassiveMotionFunc(mouseMotionCallback);
+        glutMotionFunc(mouseMotionCallback);
+        glutKeyboardFunc(keyboardCallback);
+        glutKeyboardUpFunc(keyboardUpCallback);
+    }
 
-    // Enable anti-aliasing (multisampling)
+    // Enable anti-aliasing (multisampling), QualityManager may turn it off per frame
     glEnable(GL_MULTISAMPLE);
 
+    // Benchmarks compare frames, keep the detail fixed there
+    if (headless) {
+        QualityManager::getInstance().setAdaptive(false);
+    }
+
     gameFont.init("assets/fonts/Roboto-Regular.ttf", 128);
     menuFont.init("assets/fonts/Roboto-Regular.ttf", 72);
 
@@ -42,19 +69,14 @@ void Game::init() {
     WorldSphere::getInstance().init();
 
     // After creating your window, but before setting the projection:
-    int w = glutGet(GLUT_WINDOW_WIDTH);
-    int h = glutGet(GLUT_WINDOW_HEIGHT);
+    // (viewport instead of glutGet so the offscreen context works too)
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    int w = viewport[2];
+    int h = viewport[3];
     if (h == 0) h = 1;  // guard against divide-by-zero
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(
-        45.0,               // vertical FOV in degrees
-        (double)w / (double)h,
-        0.1,                // near clip plane
-        1000.0              // far clip plane
-    );
-    glMatrixMode(GL_MODELVIEW);
+    applyProjection(w, h, 1.0f);
 
     Game::initNewLevel();
     Game& game = getInstance();
@@ -71,27 +93,79 @@ void Game::init() {
 
     GameLighting::init();
 
+    // Render needs a snapshot from the very first frame
+    publishSnapshot();
+    acquireSnapshot();
+
     gameLoading = false;
     gameLoaded = true;
+
+    // Headless runs tick the simulation from update to stay deterministic
+    if (!headless) {
+        startSimulation();
+    }
+
+    if (mapWatching && !generatedLevels && !levelPack) {
+        mapWatcher.start(std::filesystem::path(mapPath).parent_path().string());
+    }
 }
 
 void Game::initNewLevel(int level) {
     Game& game = getInstance();
     game.moveDir = MoveDir::NONE;
     if (level < 0) { level = getCurrentLevel(); }
-    mapFactory = MapFactory();
-    map = mapFactory.createMap();
+    LevelPreparer& preparer = LevelPreparer::getInstance();
+    LevelPreparer::Source source = levelSource(level);
+    std::shared_ptr<Map> previousMap;
+    if (map && source == mapSource) {
+        // Same board, only the pellets and doors go back to how they were loaded
+        map->resetState();
+    }
+    else {
+        // Built on the preparer's worker while the last level was played, the swap happens under the tick's lock
+        LevelPreparer::Source previousSource = mapSource;
+        previousMap = std::move(map);
+        map = preparer.take(source);
+        mapSource = source;
+        // A board that failed to load, play the last one again or the default one on the first level
+        if (!map || !map->hasAllSpawns()) {
+            preparer.retire(std::move(map));
+            if (previousMap) {
+                std::cerr << "Level " << level << " has no playable map, playing the last one again" << std::endl;
+                map = std::move(previousMap);
+                map->resetState();
+                mapSource = previousSource;
+            }
+            else {
+                std::cerr << "Level " << level << " has no playable map, playing " << MapFactory::DEFAULT_MAP_PATH << std::endl;
+                mapSource = LevelPreparer::Source();
+                mapSource.mapPath = MapFactory::DEFAULT_MAP_PATH;
+                map = preparer.take(mapSource);
+            }
+            // Not even the default one (run outside the build dir), the menu renders on a map too
+            if (!map || !map->hasAllSpawns()) {
+                std::cerr << "No playable map, run the game from the directory that holds assets/" << std::endl;
+                exit(1);
+            }
+        }
+    }
+    // The new map may land on the old one's address
+    playerFlowField.invalidate();
+    // Searches on the old map are of no use to anyone
+    PathfindingQueue::getInstance().cancelAll();
+    // HUD sits on map tiles, the render side re-bakes when it sees the new generation
+    mapGeneration++;
     GameControl& gc = GameControl::getInstance();
     // Press and release movement key to start the level
     gc.enableWasdAfterFullPressCycle();
     // Reset moveDir
     gc.setMoveDir(MoveDir::NONE);
 
-    Point3D playerSpawnOrigin = map.getPlayerSpawn()->getOrigin();
-    Point3D blinkySpawnOrigin = map.getBlinkySpawn()->getOrigin();
-    Point3D pinkySpawnOrigin = map.getPinkySpawn()->getOrigin();
-    Point3D inkySpawnOrigin = map.getInkySpawn()->getOrigin();
-    Point3D clydeSpawnOrigin = map.getClydeSpawn()->getOrigin();
+    Point3D playerSpawnOrigin = map->getPlayerSpawn()->getOrigin();
+    Point3D blinkySpawnOrigin = map->getBlinkySpawn()->getOrigin();
+    Point3D pinkySpawnOrigin = map->getPinkySpawn()->getOrigin();
+    Point3D inkySpawnOrigin = map->getInkySpawn()->getOrigin();
+    Point3D clydeSpawnOrigin = map->getClydeSpawn()->getOrigin();
 
     playerSpawnOrigin.move(MapFactory::TILE_SIZE / 2.0f, 0.0f, 0.0f);
     blinkySpawnOrigin.move(- MapFactory::TILE_SIZE / 2.0f, 0.0f, 0.0f);
@@ -99,10 +173,18 @@ void Game::initNewLevel(int level) {
     inkySpawnOrigin.move(- MapFactory::TILE_SIZE / 2.0f, 0.0f, 0.0f);
     clydeSpawnOrigin.move(- MapFactory::TILE_SIZE / 2.0f, 0.0f, 0.0f);
 
-    player = Player(&map, playerSpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)));
+    player = Player(map.get(), playerSpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)));
     
     float levelSpeed = game.getBaseSpeed() + level * LEVEL_SPEED_INCREMENT;
-    float ghostSpeed = levelSpeed * (1 + GHOST_SPEED_COMP);
+    float ghostSpeed = 0.0f;
+    // A pack sets its own speed curve, every time through it the levels get one step faster
+    if (levelPack) {
+        LevelPack::LevelInfo info = levelPack->getInfo(level % levelPack->getLevelCount());
+        float lap = (level / levelPack->getLevelCount()) * LEVEL_SPEED_INCREMENT;
+        if (info.playerSpeed > 0.0f) levelSpeed = info.playerSpeed + lap;
+        if (info.ghostSpeed > 0.0f) ghostSpeed = info.ghostSpeed + lap;
+    }
+    if (ghostSpeed <= 0.0f) ghostSpeed = levelSpeed * (1 + GHOST_SPEED_COMP);
 
     uint64_t blinkDurationMs = Player::DEFAULT_BLINK_DURATION_MS * std::pow(LEVEL_DURATION_MULTIPLIER, level);
     uint64_t dirChangeRequestExpireAfterMs = Player::DEFAULT_DIR_CHANGE_REQUEST_EXPIRE_AFTER_MS * std::pow(LEVEL_DURATION_MULTIPLIER, level);
@@ -113,16 +195,18 @@ void Game::initNewLevel(int level) {
     player.setBlinkDuration(blinkDurationMs);
     player.setInvincibleExpireAfterMs(invincibleExpireAfterMs);
 
-    pinky = Ghost(&map, pinkySpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "pinky");
+    pinky = Ghost(map.get(), pinkySpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "pinky");
     pinky.setColor(1.0, 0.5, 0.5);
     pinky.setMoveSpeed(ghostSpeed);
-    blinky = Ghost(&map, blinkySpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "blinky");
+    blinky = Ghost(map.get(), blinkySpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "blinky");
     blinky.setColor(1.0, 0.0, 0.0);
     blinky.setMoveSpeed(ghostSpeed);
-    inky = Ghost(&map, inkySpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "inky");
+    // Blinky chases the player after heading to his corner
+    blinky.followFlowField(&playerFlowField);
+    inky = Ghost(map.get(), inkySpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "inky");
     inky.setColor(0.0, 1.0, 1.0);
     inky.setMoveSpeed(ghostSpeed);
-    clyde = Ghost(&map, clydeSpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "clyde");
+    clyde = Ghost(map.get(), clydeSpawnOrigin, BoundingBox3D(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999)), "clyde");
     clyde.setColor(1, 0.6, 0);
     clyde.setMoveSpeed(ghostSpeed);
     
@@ -134,6 +218,86 @@ void Game::initNewLevel(int level) {
     ghosts.push_back(&clyde);
 
     GameLogic::initLevel();
+
+    // Entities are off the old map now, it is freed on the worker. A different next board builds meanwhile.
+    preparer.retire(std::move(previousMap));
+    LevelPreparer::Source next = levelSource(level + 1);
+    if (!(next == mapSource)) preparer.prepare(next);
+}
+
+LevelPreparer::Source Game::levelSource(int level) const {
+    LevelPreparer::Source source;
+    if (levelPack) {
+        source.pack = levelPack;
+        source.packLevel = level % levelPack->getLevelCount();
+    }
+    else if (generatedLevels) {
+        source.generated = true;
+        source.seed = levelSeed + (uint32_t)level;
+    }
+    else source.mapPath = mapPath;
+    return source;
+}
+
+bool Game::setLevelPack(const std::string& path) {
+    std::shared_ptr<const LevelPack> pack = LevelPack::open(path);
+    if (!pack) return false;
+    levelPack = std::move(pack);
+    return true;
+}
+
+// On the GLUT thread like render, so no frame draws a half patched map
+void Game::reloadMap() {
+    std::lock_guard<std::mutex> lock(simulationMutex);
+    if (!map || generatedLevels || levelPack) return;
+    std::vector<std::string> rows;
+    if (!MapFactory::readRows(mapPath, rows)) return;
+    // Editors may save a half done board, keep playing the last good one
+    std::string error;
+    if (!MapFactory::validateRows(rows, error)) {
+        std::cerr << "Not reloading " << mapPath << ": " << error << std::endl;
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    // Searches read the tiles and graphs without a lock, none may run during the patch
+    PathfindingQueue::getInstance().cancelAllAndWait();
+    LevelPreparer::getInstance().forget(mapSource);
+    MapFactory factory;
+    std::vector<Tile*> changed;
+    if (!factory.patchMap(*map, rows, &changed)) {
+        // Other size, the tiles can not be kept
+        mapSource = LevelPreparer::Source();
+        initNewLevel();
+        publishSnapshot();
+        return;
+    }
+    if (changed.empty()) return;
+
+    playerFlowField.invalidate();
+    // Whoever ended up inside a wall goes back to its spawn, everyone else stays
+    auto keepOrRespawn = [](MovableEntity& entity, Tile* spawn, float shift) {
+        Tile* tile = entity.getCurrentTile();
+        if (tile && tile->isWalkable()) return;
+        Point3D origin = spawn->getOrigin();
+        origin.move(shift, 0.0f, 0.0f);
+        entity.setOrigin(origin);
+    };
+    keepOrRespawn(player, map->getPlayerSpawn(), MapFactory::TILE_SIZE / 2.0f);
+    keepOrRespawn(blinky, map->getBlinkySpawn(), -MapFactory::TILE_SIZE / 2.0f);
+    keepOrRespawn(pinky, map->getPinkySpawn(), -MapFactory::TILE_SIZE / 2.0f);
+    keepOrRespawn(inky, map->getInkySpawn(), -MapFactory::TILE_SIZE / 2.0f);
+    keepOrRespawn(clyde, map->getClydeSpawn(), -MapFactory::TILE_SIZE / 2.0f);
+    // Routes may run through the changed tiles
+    GameLogic::replanGhosts();
+    mapGeneration++;
+    // Paused or in a menu nothing ticks, show the edit anyway
+    publishSnapshot();
+    // Snapshots hold the map and its bits, not tiles, and the ghosts were replanned above
+    map->releaseReplacedTiles();
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Reloaded " << mapPath << ": " << changed.size() << " tiles in " << elapsedMs << " ms" << std::endl;
 }
 
 void Game::resetLevelOnDeath() {
@@ -145,11 +309,11 @@ void Game::resetLevelOnDeath() {
     // Reset moveDir
     gc.setMoveDir(MoveDir::NONE);
 
-    Point3D playerSpawnOrigin = map.getPlayerSpawn()->getOrigin();
-    Point3D blinkySpawnOrigin = map.getBlinkySpawn()->getOrigin();
-    Point3D pinkySpawnOrigin = map.getPinkySpawn()->getOrigin();
-    Point3D inkySpawnOrigin = map.getInkySpawn()->getOrigin();
-    Point3D clydeSpawnOrigin = map.getClydeSpawn()->getOrigin();
+    Point3D playerSpawnOrigin = map->getPlayerSpawn()->getOrigin();
+    Point3D blinkySpawnOrigin = map->getBlinkySpawn()->getOrigin();
+    Point3D pinkySpawnOrigin = map->getPinkySpawn()->getOrigin();
+    Point3D inkySpawnOrigin = map->getInkySpawn()->getOrigin();
+    Point3D clydeSpawnOrigin = map->getClydeSpawn()->getOrigin();
 
     playerSpawnOrigin.move(MapFactory::TILE_SIZE / 2.0f, 0.0f, 0.0f);
     blinkySpawnOrigin.move(-MapFactory::TILE_SIZE / 2.0f, 0.0f, 0.0f);
@@ -190,47 +354,70 @@ void Game::startNewSandboxSession() {
     gc.setCameraMode(CameraMode::InteractiveMapView);
 }
 
-// First interface to handle game logic
+// First interface to handle game logic, runs on the GLUT thread
 void Game::update(int value) {
     Game& game = Game::getInstance();
     GameCamera& gcam = GameCamera::getInstance();
     GameUserInput& guin = GameUserInput::getInstance();
 
-    float newFrameTimeS = glutGet(GLUT_ELAPSED_TIME) / 1000.0f; // in s
+    // Nothing to update until the first render ran init
+    if (!game.gameLoaded) {
+        if (!game.headless) glutTimerFunc(UPDATE_INTERVAL_MS, Game::update, 0);
+        return;
+    }
+
+    float newFrameTimeS = game.headless ? game.headlessTimeS : glutGet(GLUT_ELAPSED_TIME) / 1000.0f; // in s
     
     // Update the frametime
-    game.lastFrameTimeDeltaS = newFrameTimeS - game.lastFrameTimeS;
+    game.lastUpdateDeltaS = newFrameTimeS - game.lastFrameTimeS;
     game.lastFrameTimeS = newFrameTimeS;
 
-    // HANDLE GAME LOGIC
-    // Update the game logic and control only if playing
+    // HANDLE GAME INPUT
+    // Game logic itself runs in simulateTick, here only the input it consumes
     if (game.gameState == GameState::Playing) { 
         if (guin.isKeyFlagPressed('\x1B')) {
             guin.resetKeyFlagPressed('\x1B');
-            game.gameState = GameState::Paused;
-            game.gameMenu.initPauseMenu();
+            // The simulation may have just ended the game, do not override that
+            GameState expected = GameState::Playing;
+            if (game.gameState.compare_exchange_strong(expected, GameState::Paused)) {
+                game.gameMenu.initPauseMenu();
+            }
         }
 
         // Unlock the user camera movement
         gcam.setLockUserUpdate(false);
 
-        GameLogic::updatePlayer();
-        GameLogic::updateGhosts();
-        GameLogic::updateScore();
-        GameLogic::updatePlayerLives();
-
         GameControl& gcon = GameControl::getInstance();
 
         // Update user input based logic
         gcon.update();
 
-        if (game.getPlayerLives() < 0) {
-            game.gameState = GameState::GameOver;
-            game.gameMenu.initGameOverMenu();
-            game.gameMenu.setUserScore(game.getTotalScore());
+        // Doors are flipped on the simulation side
+        if (guin.isKeyFlagPressedAndReleased(DOOR_TOGGLE_KEY)) {
+            guin.resetKeyFlagPressedAndReleased(DOOR_TOGGLE_KEY);
+            game.doorToggleRequested = true;
         }
     }
 
+    // A saved map is patched between ticks
+    if (game.mapWatcher.isWatching()) {
+        for (const std::filesystem::path& changed : game.mapWatcher.poll()) {
+            std::error_code error;
+            if (std::filesystem::equivalent(changed, game.mapPath, error)) game.reloadMap();
+        }
+    }
+
+    // No simulation thread (headless), tick inline with the frame
+    if (!game.simulationRunning) {
+        game.simulateTick(game.lastUpdateDeltaS);
+    }
+
+    if (game.gameOverPending.exchange(false)) {
+        std::lock_guard<std::mutex> lock(game.simulationMutex);
+        game.gameMenu.initGameOverMenu();
+        game.gameMenu.setUserScore(game.getTotalScore());
+    }
+
     // HANDLE MENU LOGIC
     if (game.gameState != GameState::Playing) {
         // Lock user camera updates when not in game
@@ -239,14 +426,17 @@ void Game::update(int value) {
         game.gameMenu.update();
         std::string enteredItem = game.gameMenu.getEnteredMenuItemString();
         if (enteredItem == "Play") {
+            std::lock_guard<std::mutex> lock(game.simulationMutex);
             game.gameState = GameState::Playing;
             game.startNewCasualSession();
         }
         if (enteredItem == "Sandbox") {
+            std::lock_guard<std::mutex> lock(game.simulationMutex);
             game.gameState = GameState::Playing;
             game.startNewSandboxSession();
         }
         if (enteredItem == "Exit") {
+            game.stopSimulation();
             exit(0);
         }
         if (enteredItem == "Resume") {
@@ -269,12 +459,170 @@ void Game::update(int value) {
         }
     }
 
-    // Always update the camera
-    gcam.update(game.lastFrameTimeDeltaS);
+    StatsOverlay::getInstance().handleInput();
+    DebugDraw::getInstance().handleInput();
+
+    // Always update the camera, it follows the render copy of the player
+    game.acquireSnapshot();
+    gcam.update(game.lastUpdateDeltaS);
+
+    // Headless runner drives update/render itself
+    if (game.headless) return;
 
     // Trigger the display update by calling this to schedule a render
     glutPostRedisplay();
-    glutTimerFunc(8, Game::update, 0);
+
+    // Menus with nothing moving: linger a bit after the last input, then sleep until wake()
+    if (!game.isIdleCandidate()) {
+        game.idleLingerUpdates = IDLE_LINGER_UPDATES;
+    }
+    else if (game.idleLingerUpdates > 0) {
+        game.idleLingerUpdates--;
+    }
+
+    if (game.idleLingerUpdates > 0) {
+        glutTimerFunc(UPDATE_INTERVAL_MS, Game::update, 0);
+    }
+    else {
+        game.updateSleeping = true;
+    }
+}
+
+bool Game::isIdleCandidate() {
+    return gameState != GameState::Playing &&
+        !gameOverPending &&
+        !GameCamera::getInstance().isTransitioning() &&
+        // Live numbers are the point of the overlay
+        !StatsOverlay::getInstance().isVisible();
+}
+
+void Game::wake() {
+    Game& game = Game::getInstance();
+    game.idleLingerUpdates = IDLE_LINGER_UPDATES;
+    if (game.updateSleeping) {
+        game.updateSleeping = false;
+        // The sleep is not a slow frame
+        QualityManager::getInstance().resetFrameTiming();
+        glutTimerFunc(0, Game::update, 0);
+    }
+}
+
+// One step of the game logic, on the simulation thread (or inline from update when headless)
+void Game::simulateTick(float deltaS) {
+    std::lock_guard<std::mutex> lock(simulationMutex);
+    lastFrameTimeDeltaS = deltaS;
+
+    if (gameState == GameState::Playing) {
+        if (doorToggleRequested.exchange(false)) {
+            GameLogic::toggleDoors();
+        }
+        GameLogic::updatePlayer();
+        GameLogic::updateGhosts();
+        GameLogic::updateScore();
+        GameLogic::updatePlayerLives();
+
+        // No worker thread (headless), run this tick's path requests here
+        PathfindingQueue& pathfinding = PathfindingQueue::getInstance();
+        if (!pathfinding.isThreaded()) {
+            pathfinding.process(PATHFINDING_BUDGET_MS);
+        }
+
+        if (getPlayerLives() < 0) {
+            gameState = GameState::GameOver;
+            gameOverPending = true;
+        }
+    }
+
+    publishSnapshot();
+}
+
+void Game::publishSnapshot() {
+    GameSnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.tick = ++simulationTick;
+    snapshot.mapGeneration = mapGeneration;
+    snapshot.map = map;
+    // Same size every tick within a level, so this reuses the slot's storage
+    snapshot.mapState = map->getState();
+    snapshot.player = player.getRenderState();
+    snapshot.ghosts.resize(ghosts.size());
+    for (size_t i = 0; i < ghosts.size(); ++i) {
+        snapshot.ghosts[i] = ghosts[i]->getRenderState();
+    }
+    snapshot.totalScore = totalScore;
+    snapshot.playerLives = playerLives;
+    snapshot.currentLevel = currentLevel;
+    snapshot.playerDying = playerDying;
+    snapshots.publish();
+}
+
+// Render thread side, picks up the newest tick if there is one
+bool Game::acquireSnapshot() {
+    if (!snapshots.acquire()) return false;
+    const GameSnapshot& snapshot = snapshots.readBuffer();
+
+    renderPlayer.applyRenderState(snapshot.player);
+    renderGhosts.resize(snapshot.ghosts.size());
+    for (size_t i = 0; i < snapshot.ghosts.size(); ++i) {
+        renderGhosts[i].applyRenderState(snapshot.ghosts[i]);
+    }
+
+    // HUD sits on map tiles, re-bake for a new map
+    if (snapshot.mapGeneration != hudMapGeneration) {
+        scoreHud.invalidate();
+        livesHud.invalidate();
+        hudMapGeneration = snapshot.mapGeneration;
+    }
+
+    // Scene changed, the menu background has to be redrawn
+    sceneCache.invalidate();
+    return true;
+}
+
+void Game::startSimulation() {
+    if (simulationRunning) return;
+    simulationRunning = true;
+    PathfindingQueue::getInstance().start();
+    LevelPreparer::getInstance().start();
+    simulationThread = std::thread(&Game::simulationLoop, this);
+}
+
+void Game::stopSimulation() {
+    simulationRunning = false;
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+    PathfindingQueue::getInstance().stop();
+    LevelPreparer::getInstance().stop();
+}
+
+// Fixed tick, sleeps until the next one instead of spinning
+void Game::simulationLoop() {
+    using clock = std::chrono::steady_clock;
+    const auto tickDuration = std::chrono::milliseconds(SIMULATION_TICK_MS);
+    auto lastTick = clock::now();
+    auto nextTick = lastTick + tickDuration;
+
+    while (simulationRunning) {
+        // Nothing to simulate in menus, check back at a slower pace
+        if (gameState != GameState::Playing) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(SIMULATION_IDLE_MS));
+            lastTick = clock::now();
+            nextTick = lastTick + tickDuration;
+            continue;
+        }
+
+        std::this_thread::sleep_until(nextTick);
+        auto now = clock::now();
+        float deltaS = std::chrono::duration<float>(now - lastTick).count();
+        lastTick = now;
+
+        // After a stall (debugger, window drag) do not catch up with a burst of ticks
+        nextTick += tickDuration;
+        if (nextTick < now) nextTick = now + tickDuration;
+
+        // Huge steps tunnel through walls
+        simulateTick(std::min(deltaS, MAX_SIMULATION_STEP_S));
+    }
 }
 
 struct Vec3 {
@@ -363,6 +711,23 @@ void Game::render() {
         return;
     }
 
+    FrameStats::getInstance().beginFrame();
+
+    // Newest simulation tick, everything below reads only the snapshot and render copies
+    game.acquireSnapshot();
+    const GameSnapshot& snapshot = game.getRenderSnapshot();
+
+    // Clip planes follow the map size, only touched when a level of another size comes in
+    if (snapshot.map->getViewScale() != game.projectionScale) {
+        GLint mapViewport[4];
+        glGetIntegerv(GL_VIEWPORT, mapViewport);
+        applyProjection(mapViewport[2], std::max(mapViewport[3], 1), snapshot.map->getViewScale());
+    }
+
+    const QualitySettings& quality = QualityManager::getInstance().getSettings();
+    if (quality.multisample) glEnable(GL_MULTISAMPLE);
+    else glDisable(GL_MULTISAMPLE);
+
     GLfloat clPos[4] = { cam.posX, cam.posY, cam.posZ, 1.0f };
 
     GLfloat clDir[3] = {
@@ -381,24 +746,76 @@ void Game::render() {
 
     GameLighting::updateCameraLight(clPos, clDir);
 
-    // Render game elements
-    game.getMap()->render(false);
-    game.getPlayer()->render();
-    for (Ghost* ghost : game.getGhosts()) { ghost->render(); }
+    bool menuShown = game.gameState != GameState::Playing;
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    // Debug drawing changes the picture as much as the quality level does
+    int sceneKey = (int)QualityManager::getInstance().getLevel() | (DebugDraw::getInstance().isEnabled() ? 0x100 : 0);
+
+    // Behind a menu the scene only changes with the camera or a new tick, reuse the last one
+    bool sceneCached = menuShown && game.sceneCache.matches(cam, viewport[2], viewport[3], sceneKey);
+    if (sceneCached) {
+        FrameZone zone("scene cache");
+        game.sceneCache.render();
+    }
+    else {
+        // Render game elements, one profiler zone (CPU + GPU time) per pass
+        {
+            FrameZone zone("map");
+            snapshot.map->render(snapshot.mapState, false);
+        }
+        {
+            FrameZone zone("entities");
+            game.renderPlayer.render();
+            for (Ghost& ghost : game.renderGhosts) { ghost.render(); }
+        }
+
+        if (!menuShown) {
+            FrameZone zone("hud");
+            game.renderScore();
+            game.renderLives();
+            game.renderCameraInfo();
+        }
+
+        {
+            FrameZone zone("sky");
+            WorldSphere::getInstance().render(snapshot.map->getViewScale());
+        }
+
+        // Everything the passes above submitted, still with the scene camera on the stack
+        {
+            FrameZone zone("debug");
+            DebugDraw::getInstance().flush();
+        }
 
-    if (game.gameState == GameState::Playing) {
-        game.renderScore();
-        game.renderLives();
-        game.renderCameraInfo();
+        // Menu goes on top of the copy, not into it
+        if (menuShown) {
+            game.sceneCache.capture(cam, viewport[2], viewport[3], sceneKey);
+        }
     }
-    
-    if (game.gameState != GameState::Playing) {
+
+    if (menuShown) {
+        FrameZone zone("menu");
         game.gameMenu.render();
     }
 
-    WorldSphere::getInstance().render();
+    {
+        FrameZone zone("overlay");
+        StatsOverlay::getInstance().render();
+    }
 
-    glutSwapBuffers();
+    FrameStats::getInstance().endFrame();
+    // Cached frames say nothing about what the scene costs
+    if (!sceneCached) {
+        QualityManager::getInstance().update(FrameStats::getInstance().getLastFrame().cpuMs);
+    }
+    else {
+        QualityManager::getInstance().resetFrameTiming();
+    }
+
+    if (!game.headless) {
+        glutSwapBuffers();
+    }
 }
 
 
@@ -418,22 +835,98 @@ void Game::reshape(int w, int h) {
 
     if (h == 0) h = 1;
     glViewport(0, 0, w, h);
+    Game::wake();
+    applyProjection(w, h, getInstance().projectionScale);
+}
+
+void Game::applyProjection(int w, int h, float viewScale) {
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    gluPerspective(45.0, (double)w / h, 0.1, 1000.0);
-    glMatrixMode(GL_MODELVIEW);
-
+    gluPerspective(
+        45.0,                           // vertical FOV in degrees
+        (double)w / (double)h,
+        NEAR_PLANE * viewScale,         // both scaled, keeps the depth precision of the classic board
+        FAR_PLANE * viewScale
+    );
     glMatrixMode(GL_MODELVIEW);
+    getInstance().projectionScale = viewScale;
 }
 
 void Game::renderScore() {
     Game& game = Game::getInstance();
-    Map* map = game.getMap();
+    int score = game.getRenderSnapshot().totalScore;
+
+    if (!game.scoreHud.isUsable()) {
+        renderScoreGeometry();
+        return;
+    }
+
+    // Re-measure and re-bake only when the score changed
+    if (game.scoreHud.isStale(score)) {
+        Point3D textOrigin = game.getRenderMap()->getTileAt(1, 1)->getOrigin();
+        std::string scoreText = "Total Score: " + std::to_string(score);
+
+        float textWidth;
+        float textHeight;
+        glft2::measureText(game.gameFont, scoreText, &textWidth, &textHeight, 0.008f);
+
+        // Text lies on the floor with the baseline at the tile below, glyphs grow toward -z
+        float baselineZ = textOrigin.z + MapFactory::TILE_SIZE;
+        float pad = MapFactory::TILE_SIZE * 0.25f;
+        HudRect rect;
+        rect.x0 = -textWidth / 2 - pad;
+        rect.x1 = textWidth / 2 + pad;
+        rect.z0 = baselineZ - textHeight - pad;
+        rect.z1 = baselineZ + textHeight * 0.5f + pad;
+        rect.y = textOrigin.y;
+
+        if (!game.scoreHud.bake(score, rect, renderScoreGeometry)) {
+            renderScoreGeometry();
+            return;
+        }
+    }
+    game.scoreHud.render();
+}
+
+void Game::renderLives() {
+    Game& game = Game::getInstance();
+    // Up to 6 Pac-Men plus the "+", everything above looks the same
+    int shownLives = std::min(game.getRenderSnapshot().playerLives, 7);
+
+    if (!game.livesHud.isUsable()) {
+        renderLivesGeometry();
+        return;
+    }
+
+    if (game.livesHud.isStale(shownLives)) {
+        Map* map = game.getRenderMap();
+        Point3D livesOrigin = map->getTileAt(map->getHeight() - 1, 1)->getOrigin();
+        float step = MapFactory::TILE_SIZE * 1.8f;
+
+        // Pac-Men are 1.5 tiles wide, centered half a tile into their origin
+        HudRect rect;
+        rect.x0 = livesOrigin.x - MapFactory::TILE_SIZE * 0.5f;
+        rect.x1 = livesOrigin.x + step * 6 + MapFactory::TILE_SIZE;
+        rect.z0 = livesOrigin.z - MapFactory::TILE_SIZE * 0.5f;
+        rect.z1 = livesOrigin.z + MapFactory::TILE_SIZE * 1.5f;
+        rect.y = livesOrigin.y;
+
+        if (!game.livesHud.bake(shownLives, rect, renderLivesGeometry)) {
+            renderLivesGeometry();
+            return;
+        }
+    }
+    game.livesHud.render();
+}
+
+void Game::renderScoreGeometry() {
+    Game& game = Game::getInstance();
+    Map* map = game.getRenderMap();
     Tile* tile = map->getTileAt(1, 1); // Get the target tile
 
     Point3D textOrigin = tile->getOrigin(); // Get the 3D position of the tile
 
-    std::string scoreText = "Total Score: " + std::to_string(game.getTotalScore());
+    std::string scoreText = "Total Score: " + std::to_string(game.getRenderSnapshot().totalScore);
 
     glPushMatrix();
 
@@ -450,15 +943,17 @@ void Game::renderScore() {
     // Single rotation to orient the text
     glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
 
+    FrameStats::getInstance().countDrawCalls(1);
     glft2::render3D(game.gameFont, scoreText, scale);
 
     glPopMatrix();
 }
 
-void Game::renderLives() {
+void Game::renderLivesGeometry() {
     Game& game = Game::getInstance();
-    Map* map = game.getMap();
-    Tile* tile = map->getTileAt(MapFactory::MAP_HEIGHT - 1, 1); // bottom-left corner
+    Map* map = game.getRenderMap();
+    int lives = game.getRenderSnapshot().playerLives;
+    Tile* tile = map->getTileAt(map->getHeight() - 1, 1); // bottom-left corner
 
     Point3D livesOrigin = tile->getOrigin();
 
@@ -470,7 +965,7 @@ void Game::renderLives() {
         Point3D dummyOrigin = livesOrigin;
         dummyOrigin.move(0.0f, 0.0f + MapFactory::TILE_SIZE / 2.0f, 0.0f);
 
-        for (int live = 0; live < game.getPlayerLives() && live < 6; ++live) {
+        for (int live = 0; live < lives && live < 6; ++live) {
             dummy.setOrigin(dummyOrigin);
             dummy.render();
 
@@ -479,7 +974,7 @@ void Game::renderLives() {
     glPopMatrix();
 
     // ----- Only render "+" if enough lives -----
-    if (game.getPlayerLives() < 7) return;
+    if (lives < 7) return;
 
     // ----- Material Setup for the "+"
     GLfloat crossAmbient[] = { 0.2f, 0.2f, 0.2f, 1.0f };
@@ -508,7 +1003,7 @@ void Game::renderLives() {
         glPushMatrix();
             glTranslatef(0.0f, H * 0.5f, 0.0f);
             glScalef(L, H, T);
-            glutSolidCube(1.0f);
+            RenderHelper::solidCube(1.0f);
         glPopMatrix();
 
         // Horizontal bar
@@ -516,7 +1011,7 @@ void Game::renderLives() {
             glTranslatef(0.0f, H * 0.5f, 0.0f);
             glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
             glScalef(L, H, T);
-            glutSolidCube(1.0f);
+            RenderHelper::solidCube(1.0f);
         glPopMatrix();
     glPopMatrix();
 
@@ -580,6 +1075,7 @@ void Game::renderCameraInfo() {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glColor4f(1, 1, 1, alpha);
     glPushMatrix();
+    FrameStats::getInstance().countDrawCalls(3);
     glft2::render2D(font, xMode, yMode, modeText, modeScale);
     glft2::render2D(font, xHint, yHint, hintText, hintScale);
     glft2::render2D(font, xMouse, yMouse, hintMouse, hintScale);
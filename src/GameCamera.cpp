@@ -34,6 +34,13 @@ void GameCamera::setNextCameraMode() {
     }
 }
 
+void GameCamera::applyCameraState(CameraState newCameraState) {
+    cameraMode = CameraMode::Free;
+    enableManualCamera();
+    setCameraState(newCameraState);
+    updateGluFromState();
+}
+
 std::string GameCamera::getCameraModeString() const {
     switch (cameraMode) {
     case CameraMode::Free:
@@ -75,7 +82,7 @@ void GameCamera::update(float frametimeS) {
 void GameCamera::updateFollowingPlayerTarget() {
     Game* game = &Game::getInstance();
     CameraState target = getCameraState();
-    Point3D playerCenter = game->getPlayer()->getAbsoluteCenterPoint();
+    Point3D playerCenter = game->getRenderPlayer()->getAbsoluteCenterPoint();
     target.lookAtX = playerCenter.x;
     target.lookAtY = playerCenter.y;
     target.lookAtZ = playerCenter.z;
@@ -103,8 +110,8 @@ float GameCamera::computeInteractivePitch(float centerFracZ) {
 void GameCamera::updateInteractiveMapViewTarget() {
     // Compute player-relative fractions
     Game* game = &Game::getInstance();
-    Point3D pc = game->getPlayer()->getAbsoluteCenterPoint();
-    auto cps = game->getMap()->getMapCornerPoints();
+    Point3D pc = game->getRenderPlayer()->getAbsoluteCenterPoint();
+    auto cps = game->getRenderMap()->getMapCornerPoints();
     float minX = cps.lowerLeft.x, maxX = cps.upperRight.x;
     float minZ = cps.lowerLeft.z, maxZ = cps.upperRight.z;
     float fracX = (pc.x - minX) / (maxX - minX);
@@ -134,8 +141,10 @@ void GameCamera::updateInteractiveMapViewTarget() {
     float hz = (maxZ - minZ) * 0.5f;
     float mapRadius = std::sqrt(hx * hx + hz * hz);
 
-    float aspect = static_cast<float>(glutGet(GLUT_WINDOW_WIDTH)) /
-        static_cast<float>(glutGet(GLUT_WINDOW_HEIGHT));
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    float aspect = static_cast<float>(viewport[2]) /
+        static_cast<float>(std::max(viewport[3], 1));
     constexpr float FOVY_DEG = 60.0f;
     float fovY_rad = FOVY_DEG * DEG_TO_RAD * 0.5f;
     float fovX_rad = atanf(tanf(fovY_rad) * aspect);
@@ -205,8 +214,8 @@ void GameCamera::handleCameraPosMoving() {
         return;
     }
 
-    float dx = gc.getMouseXDelta() * movingPosSensitivity;
-    float dy = -gc.getMouseYDelta() * movingPosSensitivity;
+    float dx = gc.getMouseXDelta() * movingPosSensitivity * mapViewScale();
+    float dy = -gc.getMouseYDelta() * movingPosSensitivity * mapViewScale();
 
     float yawRad = cameraState.yaw * GameCamera::DEG_TO_RAD;
     float c = cosf(yawRad), s = sinf(yawRad);
@@ -223,7 +232,7 @@ void GameCamera::handleCameraPosMoving() {
     float newPx = cameraGlu.posX + panX;
     float newPz = cameraGlu.posZ + panZ;
 
-    Map* map = Game::getInstance().getMap();
+    Map* map = Game::getInstance().getRenderMap();
     auto b = map->getMapCornerPoints();
     bool inBounds =
         newLAx >= b.lowerLeft.x && newLAx <= b.lowerRight.x &&
@@ -267,25 +276,32 @@ void GameCamera::handleCameraOrbitting() {
 // Handles camera zoom
 void GameCamera::handleCameraZooming() {
     GameUserInput& gc = GameUserInput::getInstance();
+    // Limits and steps grow with the map, the whole of a big map has to fit in too
+    float scale = mapViewScale();
     if (gc.isButtonFlagPressed(GLUT_WHEEL_UP)) {
         gc.resetButtonFlagPressed(GLUT_WHEEL_UP);
         autoCameraZooming = false;
-        float zoomStep = 0.5f;
+        float zoomStep = 0.5f * scale;
         cameraState.distance = cameraState.distance + zoomStep;
-        cameraState.distance = std::clamp(cameraState.distance + zoomStep, MIN_ZOOM_DISTANCE, MAX_ZOOM_DISTANCE);
+        cameraState.distance = std::clamp(cameraState.distance + zoomStep, MIN_ZOOM_DISTANCE * scale, MAX_ZOOM_DISTANCE * scale);
         updateGluFromState();
     }
 
     if (gc.isButtonFlagPressed(GLUT_WHEEL_DOWN)) {
         gc.resetButtonFlagPressed(GLUT_WHEEL_DOWN);
         autoCameraZooming = false;
-        float zoomStep = 0.5f;
+        float zoomStep = 0.5f * scale;
         cameraState.distance = cameraState.distance - zoomStep;
-        cameraState.distance = std::clamp(cameraState.distance - zoomStep, MIN_ZOOM_DISTANCE, MAX_ZOOM_DISTANCE);
+        cameraState.distance = std::clamp(cameraState.distance - zoomStep, MIN_ZOOM_DISTANCE * scale, MAX_ZOOM_DISTANCE * scale);
         updateGluFromState();
     }
 }
 
+float GameCamera::mapViewScale() {
+    Map* map = Game::getInstance().getRenderMap();
+    return map ? map->getViewScale() : 1.0f;
+}
+
 void GameCamera::updateGluFromState() {
     CameraGlu glu;
 
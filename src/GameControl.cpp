@@ -1,6 +1,10 @@
 #include "GameControl.h"
 
 void GameControl::update() {
+    // Requested by enableWasdAfterFullPressCycle, input state lives on this thread
+    if (wasdReleaseCheckPending.exchange(false) && isAnyWasdKeyPressed()) {
+        waitForKeyReleaseFirst = true;
+    }
     handleWasdMovementEnable();
     handleWasdMovement();
     changeCameraMode();
@@ -8,9 +12,7 @@ void GameControl::update() {
 
 void GameControl::enableWasdAfterFullPressCycle() {
     isWasdMovementEnabled = false;
-    if (isAnyWasdKeyPressed()) { 
-        waitForKeyReleaseFirst = true; 
-    }
+    wasdReleaseCheckPending = true;
 }
 
 void GameControl::handleWasdMovement() {
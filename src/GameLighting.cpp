@@ -1,5 +1,21 @@
 #include "GameLighting.h"
 #include <iostream>
+#include <cmath>
+#include <cstring>
+
+ShaderLight GameLighting::shaderCameraLight;
+
+// Fixed-function spot cutoff is in degrees, the shaders compare against its cosine
+static GLfloat spotCutoffCos(GLfloat cutoff) {
+    // GL only accepts [0, 90] or 180, anything else leaves the light omnidirectional
+    if (cutoff > 90.0f) return -1.0f;
+    return std::cos(cutoff * 3.14159265f / 180.0f);
+}
+
+static void copyColor(GLfloat dst[4], const GLfloat* src) {
+    static const GLfloat zeroColor[] = { 0.f, 0.f, 0.f, 1.f };
+    std::memcpy(dst, src ? src : zeroColor, sizeof(GLfloat) * 4);
+}
 
 void GameLighting::setMaterial(
     GLenum face,
@@ -7,8 +23,22 @@ void GameLighting::setMaterial(
     const GLfloat* diffuse,
     const GLfloat* specular,
     const GLfloat* emission,
-    GLfloat shininess
+    GLfloat shininess,
+    MaterialClass materialClass
 ) {
+    GameShaders& shaders = GameShaders::getInstance();
+    if (shaders.isEnabled()) {
+        // Unset colors end up zero, same as after resetMaterial
+        ShaderMaterial material;
+        copyColor(material.ambient, ambient);
+        copyColor(material.diffuse, diffuse);
+        copyColor(material.specular, specular);
+        copyColor(material.emission, emission);
+        material.shininess[0] = shininess;
+        shaders.bindMaterial(materialClass, material);
+        return;
+    }
+
     if (ambient)   glMaterialfv(face, GL_AMBIENT, ambient);
     if (diffuse)   glMaterialfv(face, GL_DIFFUSE, diffuse);
     if (specular)  glMaterialfv(face, GL_SPECULAR, specular);
@@ -16,7 +46,8 @@ void GameLighting::setMaterial(
     glMaterialf(face, GL_SHININESS, shininess);
 }
 
-void GameLighting::resetMaterial(GLenum face) {
+// Zero material, what the fixed-function path draws with between setMaterial calls
+static void resetFixedFunctionMaterial(GLenum face) {
     static const GLfloat zeroColor[] = { 0.f, 0.f, 0.f, 1.f };
 
     glMaterialfv(face, GL_AMBIENT, zeroColor);
@@ -26,6 +57,15 @@ void GameLighting::resetMaterial(GLenum face) {
     glMaterialf(face, GL_SHININESS, 0.0f);
 }
 
+void GameLighting::resetMaterial(GLenum face) {
+    GameShaders& shaders = GameShaders::getInstance();
+    if (shaders.isEnabled()) {
+        shaders.unbind();
+        return;
+    }
+    resetFixedFunctionMaterial(face);
+}
+
 void GameLighting::init() {
     glEnable(GL_LIGHTING);
     glEnable(GL_LIGHT1);
@@ -33,6 +73,17 @@ void GameLighting::init() {
     glEnable(GL_NORMALIZE);
     glEnable(GL_DEPTH_TEST);
 
+    if (!GameShaders::getInstance().init()) {
+        std::cerr << "GameLighting: shaders unavailable, using fixed-function lighting" << std::endl;
+    }
+    else {
+        // Anything lit outside setMaterial/resetMaterial still goes through fixed function
+        resetFixedFunctionMaterial(GL_FRONT_AND_BACK);
+        GLfloat modelAmbient[4];
+        glGetFloatv(GL_LIGHT_MODEL_AMBIENT, modelAmbient);
+        GameShaders::getInstance().setGlobalAmbient(modelAmbient);
+    }
+
     initSceneLight();
     initCameraLight();
 }
@@ -66,6 +117,15 @@ void GameLighting::initSceneLight() {
         glLoadIdentity();
         glLightfv(GL_LIGHT2, GL_POSITION, lightPos);
         glLightfv(GL_LIGHT2, GL_SPOT_DIRECTION, lightDir);
+
+        ShaderLight sceneLight;
+        std::memcpy(sceneLight.ambient, ambient, sizeof(ambient));
+        std::memcpy(sceneLight.diffuse, diffuse, sizeof(diffuse));
+        std::memcpy(sceneLight.specular, specular, sizeof(specular));
+        sceneLight.spot[0] = spotCutoffCos(120.0f);
+        sceneLight.spot[1] = 0.0f;
+        sceneLight.attenuation[0] = 0.3f;
+        mirrorLight(0, sceneLight, lightPos, lightDir);
     glPopMatrix();
 }
 
@@ -86,12 +146,38 @@ void GameLighting::initCameraLight() {
     glLightf(GL_LIGHT1, GL_CONSTANT_ATTENUATION, 0.80f);
     glLightf(GL_LIGHT1, GL_LINEAR_ATTENUATION, 0.f);
     glLightf(GL_LIGHT1, GL_QUADRATIC_ATTENUATION, 0.f);
+
+    // Position and direction follow in updateCameraLight
+    std::memcpy(shaderCameraLight.ambient, amb, sizeof(amb));
+    std::memcpy(shaderCameraLight.diffuse, dif, sizeof(dif));
+    std::memcpy(shaderCameraLight.specular, spc, sizeof(spc));
+    shaderCameraLight.spot[0] = spotCutoffCos(48.0f);
+    shaderCameraLight.spot[1] = 64.0f;
+    shaderCameraLight.attenuation[0] = 0.80f;
+}
+
+void GameLighting::mirrorLight(int index, ShaderLight light, const GLfloat pos[4], const GLfloat dir[3]) {
+    GameShaders& shaders = GameShaders::getInstance();
+    if (!shaders.isEnabled()) return;
+
+    // Column-major, same transform glLightfv applies to GL_POSITION / GL_SPOT_DIRECTION
+    GLfloat m[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, m);
+    for (int r = 0; r < 4; r++) {
+        light.position[r] = m[r] * pos[0] + m[4 + r] * pos[1] + m[8 + r] * pos[2] + m[12 + r] * pos[3];
+    }
+    for (int r = 0; r < 3; r++) {
+        light.direction[r] = m[r] * dir[0] + m[4 + r] * dir[1] + m[8 + r] * dir[2];
+    }
+    light.direction[3] = 1.0f;
+    shaders.setLight(index, light);
 }
 
 
 void GameLighting::updateCameraLight(GLfloat lightPos[4], GLfloat lightDir[3]) {
     glLightfv(GL_LIGHT1, GL_POSITION, lightPos);
     glLightfv(GL_LIGHT1, GL_SPOT_DIRECTION, lightDir);
+    mirrorLight(1, shaderCameraLight, lightPos, lightDir);
 
     // Debug, draw a glowing sphere at the light source
     //glPushMatrix();
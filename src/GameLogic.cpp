@@ -8,8 +8,14 @@
 #include "GameCamera.h"
 #include "GameControl.h"
 #include "GameSounds.h"
+#include "PathfindingQueue.h"
 
 void GameLogic::initLevel() {
+	replanGhosts();
+	Game::getInstance().getPlayer()->forceSetMoveDir(MoveDir::NONE);
+}
+
+void GameLogic::replanGhosts() {
 	// Create ghosts path to move them into corners
 	Game& game = Game::getInstance();
 	std::vector<Ghost*>& ghosts = game.getGhosts();
@@ -22,7 +28,22 @@ void GameLogic::initLevel() {
 			ghost->createAndSetPathToTileWhenPossible(targetTile);
 		}
 	}
-	game.getPlayer()->forceSetMoveDir(MoveDir::NONE);
+}
+
+void GameLogic::toggleDoors() {
+	Game& game = Game::getInstance();
+	Map* map = game.getMap();
+	if (!map) { return; }
+
+	for (Tile* door : map->getDoorTiles()) {
+		bool open = !door->isWalkable();
+		if (!map->setDoorOpen(door, open)) { continue; }
+		game.getPlayerFlowField().repair(door);
+		PathfindingQueue::getInstance().onDoorChanged(*map, door, open);
+		for (Ghost* ghost : game.getGhosts()) {
+			ghost->onDoorChanged(door, open);
+		}
+	}
 }
 
 void GameLogic::updateScore() {
@@ -52,7 +73,10 @@ void GameLogic::updatePlayer() {
 		return;
 	}
 
-	player.move(moveDir, gc.getMovementChanged(), lastframetimeS);
+	// Give the flag back if move did not get to it (no direction yet)
+	bool movementChanged = gc.consumeMovementChanged();
+	player.move(moveDir, movementChanged, lastframetimeS);
+	if (movementChanged) { gc.setMovementChanged(); }
 	player.update(game.gameCollectedPellets);
 }
 
@@ -69,10 +93,20 @@ void GameLogic::updateGhosts() {
 	// Move ghosts only when player is not dying
 	if (game.isPlayerDying()) { return; }
 
+	// One BFS per tile the player enters, chasers only look up their next hop. It only has
+	// to reach the chasers, on big maps that is a fraction of the board.
 	auto& ghosts = game.getGhosts();
+	std::vector<const Tile*> chaserTiles;
+	for (Ghost* ghost : ghosts) {
+		if (!ghost->isFollowingFlowField()) continue;
+		chaserTiles.push_back(ghost->getCurrentTile());
+		chaserTiles.push_back(ghost->getPathTail());
+	}
+	game.getPlayerFlowField().update(game.getMap(), game.getPlayer()->getCurrentTile(), chaserTiles);
+
 	for (size_t i = 0; i < ghosts.size(); ++i) {
 		Ghost* ghost = ghosts[i];
-		if (!ghost->isPathEmpty()) {
+		if (!ghost->isPathEmpty() || ghost->isFollowingFlowField()) {
 			ghost->moveOnPath(lastFrametimeS);
 			continue;
 		}
@@ -6,6 +6,7 @@
 #include "Game.h"
 #include "MenuItem.h"
 #include <glft2/TextRenderer.hpp>
+#include "FrameStats.h"
 
 GameMenu::GameMenu() {
 }
@@ -202,6 +203,7 @@ void GameMenu::render() {
     glPushMatrix();
     glColor3ub(255, 255, 0);
     
+    FrameStats::getInstance().countDrawCalls(1);
     glft2::render2D(font, centerX - titleW * 0.5f, startY, title, titleScale);
 
     glPopMatrix();
@@ -247,6 +249,7 @@ void GameMenu::renderMenuBackground() {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
+    FrameStats::getInstance().countDrawCalls(1);
     glBegin(GL_QUADS);
     glVertex2f(0.0f, 0.0f);
     glVertex2f(screenW, 0.0f);
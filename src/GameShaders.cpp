@@ -0,0 +1,188 @@
+#include "GameShaders.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+bool GameShaders::init() {
+    if (enabled) {
+        return true;
+    }
+
+    // Uniform blocks and #version 330 need a 3.3 context
+    if (!GLEW_VERSION_3_3) {
+        std::cerr << "GameShaders: OpenGL 3.3 not available" << std::endl;
+        return false;
+    }
+
+    std::string vertexSource, lightingSource, litSource, litTexturedSource;
+    if (!readFile(VERTEX_PATH, vertexSource) ||
+        !readFile(LIGHTING_PATH, lightingSource) ||
+        !readFile(LIT_FRAGMENT_PATH, litSource) ||
+        !readFile(LIT_TEXTURED_FRAGMENT_PATH, litTexturedSource)) {
+        return false;
+    }
+
+    const char* fragmentPaths[] = { LIT_FRAGMENT_PATH, LIT_TEXTURED_FRAGMENT_PATH };
+    const std::string* fragmentSources[] = { &litSource, &litTexturedSource };
+
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource, VERTEX_PATH);
+    if (!vertexShader) {
+        return false;
+    }
+
+    for (int i = 0; i < (int)MaterialClass::Count; i++) {
+        // lighting.glsl carries the #version line so it has to come first
+        GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, lightingSource + "\n" + *fragmentSources[i], fragmentPaths[i]);
+        if (!fragmentShader) {
+            glDeleteShader(vertexShader);
+            deletePrograms();
+            return false;
+        }
+        programs[i] = linkProgram(vertexShader, fragmentShader, fragmentPaths[i]);
+        glDeleteShader(fragmentShader);
+        if (!programs[i]) {
+            glDeleteShader(vertexShader);
+            deletePrograms();
+            return false;
+        }
+
+        GLuint lightIndex = glGetUniformBlockIndex(programs[i], "LightBlock");
+        GLuint materialIndex = glGetUniformBlockIndex(programs[i], "MaterialBlock");
+        if (lightIndex != GL_INVALID_INDEX) glUniformBlockBinding(programs[i], lightIndex, LIGHT_BLOCK_BINDING);
+        if (materialIndex != GL_INVALID_INDEX) glUniformBlockBinding(programs[i], materialIndex, MATERIAL_BLOCK_BINDING);
+
+        GLint textureLocation = glGetUniformLocation(programs[i], "diffuseTexture");
+        if (textureLocation >= 0) {
+            glUseProgram(programs[i]);
+            glUniform1i(textureLocation, 0);
+            glUseProgram(0);
+        }
+    }
+    glDeleteShader(vertexShader);
+
+    glGenBuffers(1, &lightUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), &lightBlock, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &materialUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, materialUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ShaderMaterial), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, lightUbo);
+    glBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, materialUbo);
+
+    lightsDirty = false;
+    materialValid = false;
+    boundProgram = 0;
+    enabled = true;
+    return true;
+}
+
+void GameShaders::setLight(int index, const ShaderLight& light) {
+    if (index < 0 || index >= MAX_LIGHTS) return;
+    lightBlock.lights[index] = light;
+    lightsDirty = true;
+}
+
+void GameShaders::setGlobalAmbient(const GLfloat ambient[4]) {
+    std::memcpy(lightBlock.globalAmbient, ambient, sizeof(lightBlock.globalAmbient));
+    lightsDirty = true;
+}
+
+void GameShaders::bindMaterial(MaterialClass materialClass, const ShaderMaterial& material) {
+    if (!enabled) return;
+
+    GLuint program = programs[(int)materialClass];
+    if (program != boundProgram) {
+        glUseProgram(program);
+        boundProgram = program;
+    }
+
+    // Lights change once per frame at most, upload lazily on the first draw
+    if (lightsDirty) {
+        glBindBuffer(GL_UNIFORM_BUFFER, lightUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightBlock), &lightBlock);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        lightsDirty = false;
+    }
+
+    // Walls and pellets push the same material over and over
+    if (materialValid && std::memcmp(&boundMaterial, &material, sizeof(ShaderMaterial)) == 0) {
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, materialUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShaderMaterial), &material);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    boundMaterial = material;
+    materialValid = true;
+}
+
+void GameShaders::unbind() {
+    if (!enabled || boundProgram == 0) return;
+    glUseProgram(0);
+    boundProgram = 0;
+}
+
+bool GameShaders::readFile(const char* path, std::string& out) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) {
+        std::cerr << "GameShaders: failed to open " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+GLuint GameShaders::compileShader(GLenum type, const std::string& source, const char* name) {
+    GLuint shader = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint logLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> log(logLength > 1 ? logLength : 1);
+        glGetShaderInfoLog(shader, (GLsizei)log.size(), nullptr, log.data());
+        std::cerr << "GameShaders: failed to compile " << name << "\n" << log.data() << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint GameShaders::linkProgram(GLuint vertexShader, GLuint fragmentShader, const char* name) {
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint logLength = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> log(logLength > 1 ? logLength : 1);
+        glGetProgramInfoLog(program, (GLsizei)log.size(), nullptr, log.data());
+        std::cerr << "GameShaders: failed to link " << name << "\n" << log.data() << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void GameShaders::deletePrograms() {
+    for (GLuint& program : programs) {
+        if (program) glDeleteProgram(program);
+        program = 0;
+    }
+}
@@ -1,12 +1,16 @@
 #include "Ghost.h"
 #include <GL/glut.h>
 #include <random>
+#include <algorithm>
 #include <queue>
 #include <iostream>
 #include <unordered_set>
 #include "RenderHelper.h"
 #include "GameLighting.h"
 #include "Pi.h"
+#include "FrameStats.h"
+#include "QualityManager.h"
+#include "PathfindingQueue.h"
 
 Ghost::Ghost() {
 }
@@ -43,7 +47,8 @@ void Ghost::render() {
     // Translate before rotation
     glTranslatef(centerPoint.x, centerPoint.y + 0.25, centerPoint.z);
 
-    glutSolidSphere(0.75f, 18, 18);
+    const QualitySettings& quality = QualityManager::getInstance().getSettings();
+    RenderHelper::solidSphere(0.75f, quality.ghostSegments, quality.ghostSegments);
 
     // Skirt
     glPushMatrix();
@@ -52,7 +57,7 @@ void Ghost::render() {
 
         const float radius = 0.75f;
         const float height = 0.45f;
-        const int   segments = 128;
+        const int   segments = quality.skirtSegments;
         const int   waves = 12;
         const float waveAmplitude = 0.3f;
 
@@ -69,6 +74,7 @@ void Ghost::render() {
         const float B2_P3 = 0.0f;                       // return to baseline
 
 
+        FrameStats::getInstance().countDrawCalls(1);
         glBegin(GL_QUAD_STRIP);
         for (int i = 0; i <= segments; ++i) {
             float theta = 2.0f * PI * i / segments;
@@ -129,7 +135,7 @@ void Ghost::render() {
                 glRotatef(rz, 0.0f, 0.0f, 1.0f);
                 glRotatef(ry, 0.0f, 1.0f, 0.0f);
                 glScalef(1.0f, 1.0f, 0.3f);
-                glutSolidSphere(0.20f, 12, 12);
+                RenderHelper::solidSphere(0.20f, 12, 12);
             glPopMatrix();
             };
 
@@ -146,7 +152,7 @@ void Ghost::render() {
             glRotatef(rz, 0.0f, 0.0f, 1.0f);
             glRotatef(ry, 0.0f, 1.0f, 0.0f);
             glScalef(1.0f, 1.0f, 0.3f);
-            glutSolidSphere(0.11f, 12, 12);
+            RenderHelper::solidSphere(0.11f, 12, 12);
             glPopMatrix();
             };
 
@@ -161,16 +167,27 @@ void Ghost::render() {
         GameLighting::resetMaterial(GL_FRONT_AND_BACK);
     glPopMatrix();
     glPopMatrix();
-    //renderBoundingBox();
-    //renderOrigin(); 
+    // Batched by DebugDraw, nothing happens while it is off
+    renderBoundingBox();
+    renderOrigin();
 }
 
 void Ghost::moveOnPath(float frameTimeMs) {
     std::vector<Tile*> tiles = intersectingTiles(this);
     Tile* tile = currentTile(tiles);
 
-    if (this->name == "blinky") {
-        std::cout << "";
+    // Stopped ghosts sit in a tile center, a finished search can be switched to right away
+    if (tile && movePath.empty() && hasPendingPath()) {
+        pollPathRequest(tile, true);
+    }
+
+    if (flowField && tile) {
+        topUpPathFromFlowField(tile);
+    }
+
+    // Big maps hand out only the next few clusters of a route, ask for the rest in time
+    if (continueTo && !hasPendingPath() && !movePath.empty() && movePath.size() <= CONTINUE_AHEAD) {
+        requestPath(continueTo, movePath.back());
     }
 
     if (!tile || movePath.empty()) {
@@ -198,11 +215,9 @@ void Ghost::moveOnPath(float frameTimeMs) {
     this->preciseMoveToNextTile(moveDir, frameTimeMs, moved, inCenter, tiles);
 
     // Check for pending tile path change
-    // Only generate new path and switch to it if in center
-    if (tileToSwitchPathTo != nullptr && inCenter) {
-        movePath.clear();
-        createPathToTile(tileToSwitchPathTo);
-        tileToSwitchPathTo = nullptr;
+    // Only switch to the searched path if in center
+    if (hasPendingPath() && inCenter) {
+        pollPathRequest(currentTile(intersectingTiles(this)), inCenter);
     }
 
     int pathSize = movePath.size();
@@ -228,6 +243,16 @@ void Ghost::moveOnPath(float frameTimeMs) {
     }
 }
 
+// Shared field lookups instead of a search per ghost, the hops continue from the queued tail
+void Ghost::topUpPathFromFlowField(Tile* tile) {
+    while (movePath.size() < FLOW_FIELD_LOOKAHEAD) {
+        Tile* from = movePath.empty() ? tile : movePath.back();
+        Tile* hop = flowField->nextHop(from);
+        if (!hop) return;
+        movePath.push_back(hop);
+    }
+}
+
 void Ghost::createPathToTile(Tile* tile) {
     this->movePath = shortestPathToTile(tile);
     auto tiles = this->intersectingTiles(this);
@@ -236,7 +261,99 @@ void Ghost::createPathToTile(Tile* tile) {
 }
 
 void Ghost::createAndSetPathToTileWhenPossible(Tile* tile) {
-    tileToSwitchPathTo = tile;
+    // Searched from the next tile center the ghost gets to
+    Tile* start = movePath.empty() ? getCurrentTile() : movePath.front();
+    requestPath(tile, start);
+}
+
+void Ghost::clearMovePath() {
+    movePath.clear();
+    continueTo = nullptr;
+    requestPath(nullptr, nullptr);
+}
+
+void Ghost::requestPath(Tile* target, Tile* start) {
+    PathfindingQueue& queue = PathfindingQueue::getInstance();
+    // Whatever was asked for before is stale now
+    if (pathTicket) queue.cancel(pathTicket);
+    pathTicket = 0;
+    hasReadyPath = false;
+    readyPath.clear();
+    continueTo = nullptr;
+
+    tileToSwitchPathTo = target;
+    if (!target || !start) return;
+    pathTicket = queue.submit(map->shared_from_this(), start, target);
+}
+
+void Ghost::pollPathRequest(Tile* tile, bool inCenter) {
+    if (!tile) return;
+
+    if (pathTicket) {
+        std::deque<Tile*> path;
+        Tile* start = nullptr;
+        bool partial = false;
+        PathfindingQueue::Status status = PathfindingQueue::getInstance().take(pathTicket, path, start, partial);
+        if (status == PathfindingQueue::Status::Pending) return;
+        pathTicket = 0;
+        if (status == PathfindingQueue::Status::Unknown) {
+            // Dropped by the queue, ask again
+            requestPath(tileToSwitchPathTo, movePath.empty() ? tile : movePath.front());
+            return;
+        }
+        hasReadyPath = true;
+        readyPath = std::move(path);
+        readyPathStart = start;
+        readyPathPartial = partial;
+    }
+
+    if (!hasReadyPath || !inCenter) return;
+
+    if (readyPathStart == tile) {
+        Tile* target = tileToSwitchPathTo;
+        // Searched before a door closed on it
+        if (std::any_of(readyPath.begin(), readyPath.end(), [](const Tile* step) { return !step->isWalkable(); })) {
+            requestPath(target, tile);
+            return;
+        }
+        hasReadyPath = false;
+        tileToSwitchPathTo = nullptr;
+        continueTo = readyPathPartial ? target : nullptr;
+        // No graph to search on the worker, do it here
+        if (readyPath.empty() && map->getNavGraph().isEmpty()) {
+            createPathToTile(target);
+        }
+        else {
+            movePath = std::move(readyPath);
+        }
+        readyPath.clear();
+        return;
+    }
+
+    // Ended up somewhere else, search again from where the ghost stopped
+    if (movePath.empty()) {
+        requestPath(tileToSwitchPathTo, tile);
+    }
+}
+
+// Only the part of the route behind a closed door is dropped and searched again
+void Ghost::onDoorChanged(Tile* door, bool open) {
+    // Queued routes stay valid, the next search may take the shortcut
+    if (open) return;
+
+    auto cut = std::find(movePath.begin(), movePath.end(), door);
+    if (cut != movePath.end()) {
+        Tile* target = tileToSwitchPathTo ? tileToSwitchPathTo : continueTo ? continueTo : movePath.back();
+        movePath.erase(cut, movePath.end());
+        // The field is repaired on its own, top ups continue from the new tail
+        if (flowField && !tileToSwitchPathTo) return;
+        requestPath(target, movePath.empty() ? getCurrentTile() : movePath.back());
+        return;
+    }
+
+    if (hasReadyPath && std::find(readyPath.begin(), readyPath.end(), door) != readyPath.end()) {
+        requestPath(tileToSwitchPathTo, readyPathStart);
+    }
 }
 
 void Ghost::randomMove(float frameTimeMs) {
@@ -256,14 +373,14 @@ void Ghost::moveOnRandomPath(float frameTimeMs) {
         moveDir = randomDirection();
     }
 
-    if (!movePath.empty()) {
+    if (!movePath.empty() || hasPendingPath()) {
         moveOnPath(frameTimeMs);
     }
 
-    // Pick new path
-    while (movePath.empty()) {
-        Tile* tile = map->getRandomTile();
-        this->createPathToTile(tile);
+    // Target from the ghost's own component, searched on the pathfinding worker and picked up in a later tick
+    if (movePath.empty() && !hasPendingPath()) {
+        Tile* tile = getCurrentTile();
+        requestPath(map->getRandomTile(tile), tile);
     }
 }
 
@@ -320,6 +437,13 @@ std::deque<Tile*> Ghost::shortestPathToTile(Tile* targetTile) {
     Tile* startTile = this->currentTile(currentTiles);
     if (!startTile) return {};
 
+    // Junctions only, corridors are walked as a whole
+    const NavGraph& navGraph = map->getNavGraph();
+    if (!navGraph.isEmpty()) {
+        return navGraph.findPath(startTile, targetTile);
+    }
+
+    // Per tile A* for maps without a graph
     std::unordered_map<Tile*, Tile*> cameFrom;
     std::unordered_map<Tile*, float> gScore;
     std::unordered_map<Tile*, float> fScore;
@@ -369,8 +493,9 @@ float Ghost::distance(Tile* a, Tile* b) {
     return 1.0f; // constant for grid-based movement
 }
 
+// Manhattan distance, or less through a teleport, so the A* above stays optimal
 float Ghost::heuristicCost(Tile* a, Tile* b) {
-    return std::abs(a->getTileRow() - b->getTileRow()) + std::abs(a->getTileCol() - b->getTileCol()); // Manhattan Distance
+    return (float)map->getNavGraph().getPortals().estimate(a, b);
 }
 
 std::vector<Tile*> Ghost::getNeighbors(Tile* tile) {
@@ -397,16 +522,20 @@ std::deque<Tile*> Ghost::reconstructPath(std::unordered_map<Tile*, Tile*> cameFr
     return path;
 }
 
+// Walkable tile in the corner's quadrant furthest (Manhattan) from the ghost that
+// it can actually reach, component labels stand in for a search per candidate
 Tile* Ghost::furthestTileTowardCorner(MapCorner corner) {
     auto currentTiles = intersectingTiles(this);
     Tile* startTile = currentTile(currentTiles);
     if (!startTile) return nullptr;
 
+    const NavGraph& navGraph = map->getNavGraph();
+
     int startRow = startTile->getTileRow();
     int startCol = startTile->getTileCol();
 
-    int numRows = MapFactory::MAP_HEIGHT;
-    int numCols = MapFactory::MAP_WIDTH;
+    int numRows = map->getHeight();
+    int numCols = map->getWidth();
 
     // Define corner bounds
     int rowStart = (corner == MapCorner::TOP_LEFT || corner == MapCorner::TOP_RIGHT) ? 0 : startRow;
@@ -415,34 +544,44 @@ Tile* Ghost::furthestTileTowardCorner(MapCorner corner) {
     int colStart = (corner == MapCorner::TOP_LEFT || corner == MapCorner::BOTTOM_LEFT) ? 0 : startCol;
     int colEnd = (corner == MapCorner::TOP_LEFT || corner == MapCorner::BOTTOM_LEFT) ? startCol : numCols;
 
-    struct Candidate {
-        Tile* tile;
-        float distance;
-    };
-    std::vector<Candidate> candidates;
+    if (rowStart >= rowEnd || colStart >= colEnd) return nullptr;
+
+    // Walk the quadrant in bands of equal distance, furthest first, and stop at the first
+    // reachable tile. Within a band rows go top down, which keeps the old tie-break (first
+    // tile in scan order) without scanning the whole quadrant on big maps.
+    bool leftSide = colEnd == startCol;
+    int maxRowDistance = std::max(std::abs(rowStart - startRow), std::abs(rowEnd - 1 - startRow));
+    int maxColDistance = leftSide ? startCol - colStart : colEnd - 1 - startCol;
+    for (int distance = maxRowDistance + maxColDistance; distance > 0; --distance) {
+        for (int r = rowStart; r < rowEnd; ++r) {
+            int colDistance = distance - std::abs(r - startRow);
+            if (colDistance < 0) continue;
+            int c = leftSide ? startCol - colDistance : startCol + colDistance;
+            if (c < colStart || c >= colEnd) continue;
 
-    // Gather all valid walkable tiles within the direction range
-    for (int r = rowStart; r < rowEnd; ++r) {
-        for (int c = colStart; c < colEnd; ++c) {
             Tile* tile = map->getTileAt(r, c);
             if (!tile || !tile->isWalkable()) continue;
-
-            float distance = heuristicCost(startTile, tile);
-            candidates.push_back({ tile, distance });
+            bool reachable = navGraph.isEmpty() ? !shortestPathToTile(tile).empty() : navGraph.isReachable(startTile, tile);
+            if (reachable) return tile;
         }
     }
+    return nullptr;
+}
 
-    // Sort by descending distance
-    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
-        return a.distance > b.distance;
-        });
-
-    // Return the first reachable candidate
-    for (const Candidate& c : candidates) {
-        if (!shortestPathToTile(c.tile).empty()) {
-            return c.tile;
-        }
-    }
+GhostRenderState Ghost::getRenderState() const {
+    GhostRenderState state;
+    state.origin = origin;
+    state.boundingBox = boundingBox;
+    state.moveDir = moveDir;
+    state.color[0] = colorR;
+    state.color[1] = colorG;
+    state.color[2] = colorB;
+    return state;
+}
 
-    return nullptr;
-}
\ No newline at end of file
+void Ghost::applyRenderState(const GhostRenderState& state) {
+    origin = state.origin;
+    boundingBox = state.boundingBox;
+    moveDir = state.moveDir;
+    setColor(state.color[0], state.color[1], state.color[2]);
+}
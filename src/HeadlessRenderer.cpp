@@ -0,0 +1,282 @@
+#include "HeadlessRenderer.h"
+
+#ifdef PACMAN_HEADLESS
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <SDL3/SDL.h>
+#include "Game.h"
+#include "GameCamera.h"
+#include "GameUserInput.h"
+#include "FrameStats.h"
+#include "PngWriter.h"
+
+HeadlessRenderer::~HeadlessRenderer() {
+    if (context) {
+        OSMesaDestroyContext(context);
+    }
+}
+
+bool HeadlessRenderer::init() {
+    // Ask for 3.3 compatibility so the shader path runs too, fall back to whatever OSMesa offers
+    const int attribs[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 24,
+        OSMESA_STENCIL_BITS, 8,
+        OSMESA_PROFILE, OSMESA_COMPAT_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+    context = OSMesaCreateContextAttribs(attribs, nullptr);
+    if (!context) {
+        context = OSMesaCreateContextExt(OSMESA_RGBA, 24, 8, 0, nullptr);
+    }
+    if (!context) {
+        std::cerr << "HeadlessRenderer: failed to create OSMesa context" << std::endl;
+        return false;
+    }
+
+    colorBuffer.assign((size_t)options.width * options.height * 4, 0);
+    if (!OSMesaMakeCurrent(context, colorBuffer.data(), GL_UNSIGNED_BYTE, options.width, options.height)) {
+        std::cerr << "HeadlessRenderer: OSMesaMakeCurrent failed" << std::endl;
+        return false;
+    }
+    glViewport(0, 0, options.width, options.height);
+
+    std::cout << "GL_RENDERER: " << glGetString(GL_RENDERER) << "\n"
+              << "GL_VERSION:  " << glGetString(GL_VERSION) << std::endl;
+
+    if (!options.replayPath.empty() && !loadReplay(options.replayPath)) {
+        return false;
+    }
+
+    // No sound card on CI, SDL still has to open a device for GameSounds
+    SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+    return true;
+}
+
+bool HeadlessRenderer::loadReplay(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "HeadlessRenderer: failed to open replay " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream in(line);
+        std::string kind;
+        in >> kind;
+        if (kind == "camera") {
+            CameraKeyframe keyframe;
+            CameraState& s = keyframe.state;
+            if (in >> keyframe.frame >> s.yaw >> s.pitch >> s.distance >> s.lookAtX >> s.lookAtY >> s.lookAtZ) {
+                cameraPath.push_back(keyframe);
+                continue;
+            }
+        }
+        else if (kind == "key") {
+            InputEvent event;
+            std::string key, state;
+            if (in >> event.frame >> key >> state && (state == "down" || state == "up")) {
+                event.key = key == "esc" ? '\x1B' : (unsigned char)std::tolower(key[0]);
+                event.pressed = state == "down";
+                inputEvents.push_back(event);
+                continue;
+            }
+        }
+        std::cerr << "HeadlessRenderer: " << path << ":" << lineNumber << ": cannot parse \"" << line << "\"" << std::endl;
+        return false;
+    }
+
+    auto byFrame = [](const auto& a, const auto& b) { return a.frame < b.frame; };
+    std::stable_sort(cameraPath.begin(), cameraPath.end(), byFrame);
+    std::stable_sort(inputEvents.begin(), inputEvents.end(), byFrame);
+    return true;
+}
+
+// Linear interpolation between keyframes, clamped at both ends
+CameraState HeadlessRenderer::cameraStateAt(int frame) const {
+    if (frame <= cameraPath.front().frame) return cameraPath.front().state;
+    if (frame >= cameraPath.back().frame) return cameraPath.back().state;
+
+    size_t next = 1;
+    while (cameraPath[next].frame < frame) next++;
+    const CameraKeyframe& a = cameraPath[next - 1];
+    const CameraKeyframe& b = cameraPath[next];
+    float t = (b.frame == a.frame) ? 1.0f : float(frame - a.frame) / float(b.frame - a.frame);
+
+    auto lerp = [t](float x, float y) { return x + (y - x) * t; };
+    CameraState s;
+    s.yaw = lerp(a.state.yaw, b.state.yaw);
+    s.pitch = lerp(a.state.pitch, b.state.pitch);
+    s.distance = lerp(a.state.distance, b.state.distance);
+    s.lookAtX = lerp(a.state.lookAtX, b.state.lookAtX);
+    s.lookAtY = lerp(a.state.lookAtY, b.state.lookAtY);
+    s.lookAtZ = lerp(a.state.lookAtZ, b.state.lookAtZ);
+    return s;
+}
+
+// One full orbit around the map center over the whole run
+CameraState HeadlessRenderer::defaultOrbitAt(int frame) const {
+    Map* map = Game::getInstance().getRenderMap();
+    auto corners = map->getMapCornerPoints();
+    CameraState s = GameCamera::DEFAULT_CAMERA_STATE;
+    s.lookAtX = (corners.lowerLeft.x + corners.upperRight.x) * 0.5f;
+    s.lookAtZ = (corners.lowerLeft.z + corners.upperRight.z) * 0.5f;
+    s.yaw = 360.0f * float(frame) / float(std::max(options.frames, 1));
+    s.pitch = 55.0f;
+    s.distance = 45.0f * map->getViewScale();
+    return s;
+}
+
+void HeadlessRenderer::feedInput(int frame) {
+    GameUserInput& guin = GameUserInput::getInstance();
+    while (nextInputEvent < inputEvents.size() && inputEvents[nextInputEvent].frame <= frame) {
+        const InputEvent& event = inputEvents[nextInputEvent++];
+        if (event.pressed) guin.keyboard(event.key, 0, 0);
+        else guin.keyboardUp(event.key, 0, 0);
+    }
+}
+
+bool HeadlessRenderer::run() {
+    Game& game = Game::getInstance();
+    GameCamera& gcam = GameCamera::getInstance();
+    FrameStats& stats = FrameStats::getInstance();
+
+    game.setHeadless(true);
+    if (!options.mapPath.empty()) game.setMapPath(options.mapPath);
+    if (options.generate) game.setGeneratedLevels(true, options.seed);
+    if (!options.packPath.empty() && !game.setLevelPack(options.packPath)) return false;
+    game.setMapWatching(options.watch);
+    game.init();
+
+    if (options.play) {
+        game.setGameState(GameState::Playing);
+        game.startNewSandboxSession();
+    }
+
+    // Without a replay the game camera is left alone while playing, otherwise orbit the map
+    bool orbit = cameraPath.empty() && !options.play;
+
+    results.clear();
+    results.reserve(options.frames);
+    for (int frame = 0; frame < options.warmupFrames + options.frames; frame++) {
+        int replayFrame = frame - options.warmupFrames;
+
+        // Record only the measured frames, history index == result index
+        if (replayFrame == 0) {
+            stats.clearHistory();
+            stats.setRecording(true);
+        }
+
+        feedInput(replayFrame);
+        game.advanceHeadlessClock(options.frameTimeS);
+        Game::update();
+
+        if (!cameraPath.empty()) gcam.applyCameraState(cameraStateAt(replayFrame));
+        else if (orbit) gcam.applyCameraState(defaultOrbitAt(replayFrame));
+
+        auto start = std::chrono::steady_clock::now();
+        Game::render();
+        glFinish();
+        auto end = std::chrono::steady_clock::now();
+
+        if (replayFrame < 0) continue;
+
+        FrameResult result;
+        result.cpuMs = stats.getLastFrame().cpuMs;
+        result.totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+        result.drawCalls = stats.getLastFrame().drawCalls;
+        result.gpuMs = -1.0;    // resolved after the run
+        results.push_back(result);
+
+        if (!options.dumpDir.empty() && options.dumpEvery > 0 && replayFrame % options.dumpEvery == 0) {
+            if (!dumpFrame(replayFrame)) return false;
+        }
+    }
+
+    // GPU timings arrive a few frames late, collect the stragglers and merge them in
+    stats.setRecording(false);
+    stats.flushGpuTimers();
+    const std::vector<FrameSample>& history = stats.getHistory();
+    for (size_t i = 0; i < results.size() && i < history.size(); i++) {
+        results[i].gpuMs = history[i].gpuMs;
+    }
+
+    if (!options.csvPath.empty() && !writeCsv()) {
+        return false;
+    }
+    if (!options.tracePath.empty() && !stats.writeTrace(options.tracePath)) {
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessRenderer::dumpFrame(int frame) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.png", frame);
+    std::string path = options.dumpDir + "/" + name;
+    // OSMesa buffers are bottom-up like glReadPixels
+    return PngWriter::writeRGBA(path, options.width, options.height, colorBuffer.data(), true);
+}
+
+bool HeadlessRenderer::writeCsv() const {
+    std::ofstream file(options.csvPath);
+    if (!file) {
+        std::cerr << "HeadlessRenderer: failed to open " << options.csvPath << std::endl;
+        return false;
+    }
+    file << "frame,cpu_ms,total_ms,gpu_ms,draw_calls\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        file << i << "," << results[i].cpuMs << "," << results[i].totalMs << "," << results[i].gpuMs << "," << results[i].drawCalls << "\n";
+    }
+    return file.good();
+}
+
+void HeadlessRenderer::printReport(std::ostream& out) const {
+    if (results.empty()) {
+        out << "No frames rendered" << std::endl;
+        return;
+    }
+
+    auto summarize = [&](const char* label, auto field) {
+        std::vector<double> values;
+        values.reserve(results.size());
+        for (const FrameResult& r : results) values.push_back(field(r));
+        std::sort(values.begin(), values.end());
+
+        double sum = 0.0;
+        for (double v : values) sum += v;
+        auto percentile = [&](double p) { return values[std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5))]; };
+
+        out << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(3)
+            << " avg " << std::setw(9) << sum / values.size()
+            << "  p50 " << std::setw(9) << percentile(0.50)
+            << "  p95 " << std::setw(9) << percentile(0.95)
+            << "  p99 " << std::setw(9) << percentile(0.99)
+            << "  max " << std::setw(9) << values.back() << "\n";
+    };
+
+    out << "Frames: " << results.size() << " (" << options.width << "x" << options.height
+        << ", warmup " << options.warmupFrames << ")\n";
+    summarize("cpu ms", [](const FrameResult& r) { return r.cpuMs; });
+    summarize("total ms", [](const FrameResult& r) { return r.totalMs; });
+    if (results.front().gpuMs >= 0.0) {
+        summarize("gpu ms", [](const FrameResult& r) { return r.gpuMs; });
+    }
+    summarize("draw calls", [](const FrameResult& r) { return (double)r.drawCalls; });
+    out.flush();
+}
+
+#endif // PACMAN_HEADLESS
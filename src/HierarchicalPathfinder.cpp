@@ -0,0 +1,398 @@
+#include "HierarchicalPathfinder.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <set>
+
+void HierarchicalPathfinder::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    tiles.clear();
+    walkable.clear();
+    clusters.clear();
+    borders.clear();
+    nodeTiles.clear();
+    nodeClusters.clear();
+    portals.clear();
+}
+
+void HierarchicalPathfinder::build(const std::vector<Tile*>& grid, int width, int height, int clusterSize) {
+    clear();
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    this->width = width;
+    this->height = height;
+    this->clusterSize = std::max(clusterSize, 2);
+    clusterCols = (width + this->clusterSize - 1) / this->clusterSize;
+    int clusterRows = (height + this->clusterSize - 1) / this->clusterSize;
+
+    tiles = grid;
+    portals.build(grid);
+    walkable.assign(tiles.size(), 0);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        walkable[i] = tiles[i] && tiles[i]->isWalkable();
+    }
+
+    for (int clusterRow = 0; clusterRow < clusterRows; ++clusterRow) {
+        for (int clusterCol = 0; clusterCol < clusterCols; ++clusterCol) {
+            Cluster cluster;
+            cluster.row = clusterRow * this->clusterSize;
+            cluster.col = clusterCol * this->clusterSize;
+            cluster.rows = std::min(this->clusterSize, height - cluster.row);
+            cluster.cols = std::min(this->clusterSize, width - cluster.col);
+            clusters.push_back(cluster);
+        }
+    }
+
+    // Every walkable link between two clusters, teleports included
+    std::set<uint64_t> pairs;
+    int neighbors[4];
+    for (int tile = 0; tile < (int)tiles.size(); ++tile) {
+        if (!walkable[tile]) continue;
+        for (int i = 0, n = neighborsOf(tile, neighbors); i < n; ++i) {
+            if (clusterOf(neighbors[i]) != clusterOf(tile)) pairs.insert(borderKey(clusterOf(tile), clusterOf(neighbors[i])));
+        }
+    }
+    for (uint64_t key : pairs) {
+        rebuildBorder((int)(key >> 32), (int)(uint32_t)key);
+    }
+    for (int cluster = 0; cluster < (int)clusters.size(); ++cluster) {
+        rebuildCluster(cluster);
+    }
+    renumberNodes();
+}
+
+bool HierarchicalPathfinder::contains(const Cluster& cluster, int tile) const {
+    int row = tile / width;
+    int col = tile % width;
+    return row >= cluster.row && row < cluster.row + cluster.rows && col >= cluster.col && col < cluster.col + cluster.cols;
+}
+
+int HierarchicalPathfinder::neighborsOf(int tile, int out[4]) const {
+    int count = 0;
+    const Tile* from = tiles[tile];
+    for (Tile* neighbor : { from->getTileUp(), from->getTileDown(), from->getTileLeft(), from->getTileRight() }) {
+        if (!neighbor) continue;
+        int index = indexOf(neighbor);
+        if (walkable[index]) out[count++] = index;
+    }
+    return count;
+}
+
+// Links between the two clusters in row-major order, runs of side by side links form one entrance
+void HierarchicalPathfinder::rebuildBorder(int a, int b) {
+    int low = std::min(a, b);
+    int high = std::max(a, b);
+    const Cluster& cluster = clusters[low];
+
+    std::vector<Transition> links;
+    int neighbors[4];
+    for (int row = cluster.row; row < cluster.row + cluster.rows; ++row) {
+        for (int col = cluster.col; col < cluster.col + cluster.cols; ++col) {
+            int tile = row * width + col;
+            if (!walkable[tile]) continue;
+            for (int i = 0, n = neighborsOf(tile, neighbors); i < n; ++i) {
+                if (clusterOf(neighbors[i]) == high) links.push_back({ tile, neighbors[i] });
+            }
+        }
+    }
+
+    auto adjacent = [this](int x, int y) { return std::abs(x / width - y / width) + std::abs(x % width - y % width) == 1; };
+    std::vector<Transition> transitions;
+    size_t runStart = 0;
+    for (size_t i = 0; i < links.size(); ++i) {
+        bool continues = i + 1 < links.size() && adjacent(links[i].inside, links[i + 1].inside) && adjacent(links[i].outside, links[i + 1].outside);
+        if (continues) continue;
+        size_t length = i - runStart + 1;
+        if (length <= (size_t)MAX_SINGLE_TRANSITION_WIDTH) {
+            transitions.push_back(links[runStart + length / 2]);
+        }
+        else {
+            transitions.push_back(links[runStart]);
+            transitions.push_back(links[i]);
+        }
+        runStart = i + 1;
+    }
+
+    uint64_t key = borderKey(low, high);
+    if (transitions.empty()) borders.erase(key);
+    else borders[key] = std::move(transitions);
+}
+
+// Collects the cluster's side of all its borders and the distances between them
+void HierarchicalPathfinder::rebuildCluster(int clusterId) {
+    Cluster& cluster = clusters[clusterId];
+    cluster.nodes.clear();
+    cluster.tileLinks.clear();
+
+    std::set<int> others;
+    int neighbors[4];
+    for (int row = cluster.row; row < cluster.row + cluster.rows; ++row) {
+        for (int col = cluster.col; col < cluster.col + cluster.cols; ++col) {
+            int tile = row * width + col;
+            if (!walkable[tile]) continue;
+            for (int i = 0, n = neighborsOf(tile, neighbors); i < n; ++i) {
+                if (clusterOf(neighbors[i]) != clusterId) others.insert(clusterOf(neighbors[i]));
+            }
+        }
+    }
+    for (int other : others) {
+        auto it = borders.find(borderKey(clusterId, other));
+        if (it == borders.end()) continue;
+        bool low = clusterId < other;
+        for (const Transition& transition : it->second) {
+            int here = low ? transition.inside : transition.outside;
+            int there = low ? transition.outside : transition.inside;
+            cluster.nodes.push_back(here);
+            cluster.tileLinks.push_back({ here, there });
+        }
+    }
+    std::sort(cluster.nodes.begin(), cluster.nodes.end());
+    cluster.nodes.erase(std::unique(cluster.nodes.begin(), cluster.nodes.end()), cluster.nodes.end());
+
+    size_t count = cluster.nodes.size();
+    cluster.distances.assign(count * count, -1);
+    std::vector<int> distances;
+    for (size_t i = 0; i < count; ++i) {
+        searchCluster(clusterId, cluster.nodes[i], distances, nullptr);
+        for (size_t j = 0; j < count; ++j) {
+            cluster.distances[i * count + j] = distances[localIndex(cluster, cluster.nodes[j])];
+        }
+    }
+}
+
+void HierarchicalPathfinder::setWalkable(const Tile* tile, bool value) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (clusters.empty() || !tile) return;
+    int index = indexOf(tile);
+    if (index < 0 || (size_t)index >= walkable.size() || (bool)walkable[index] == value) return;
+    walkable[index] = value;
+
+    // Only links to and from the tile changed
+    int clusterId = clusterOf(index);
+    std::set<int> touched = { clusterId };
+    for (Tile* neighbor : { tile->getTileUp(), tile->getTileDown(), tile->getTileLeft(), tile->getTileRight() }) {
+        if (neighbor) touched.insert(clusterOf(indexOf(neighbor)));
+    }
+    for (int other : touched) {
+        if (other != clusterId) rebuildBorder(clusterId, other);
+    }
+    for (int other : touched) {
+        rebuildCluster(other);
+    }
+    renumberNodes();
+}
+
+void HierarchicalPathfinder::replaceTiles(const std::vector<Tile*>& changed) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (clusters.empty()) return;
+    std::set<int> touched;
+    std::set<std::pair<int, int>> borders;
+    for (Tile* tile : changed) {
+        int index = indexOf(tile);
+        if (index < 0 || (size_t)index >= tiles.size()) continue;
+        tiles[index] = tile;
+        if ((bool)walkable[index] == tile->isWalkable()) continue;
+        walkable[index] = tile->isWalkable();
+
+        int clusterId = clusterOf(index);
+        touched.insert(clusterId);
+        for (Tile* neighbor : { tile->getTileUp(), tile->getTileDown(), tile->getTileLeft(), tile->getTileRight() }) {
+            if (!neighbor) continue;
+            int other = clusterOf(indexOf(neighbor));
+            touched.insert(other);
+            if (other != clusterId) borders.insert({ std::min(clusterId, other), std::max(clusterId, other) });
+        }
+    }
+    if (touched.empty()) return;
+    for (const auto& [a, b] : borders) {
+        rebuildBorder(a, b);
+    }
+    for (int cluster : touched) {
+        rebuildCluster(cluster);
+    }
+    renumberNodes();
+}
+
+// Ids shift whenever a cluster gains or loses a transition, cheap next to the BFS runs
+void HierarchicalPathfinder::renumberNodes() {
+    nodeTiles.clear();
+    nodeClusters.clear();
+    for (int clusterId = 0; clusterId < (int)clusters.size(); ++clusterId) {
+        Cluster& cluster = clusters[clusterId];
+        cluster.firstNode = (int)nodeTiles.size();
+        nodeTiles.insert(nodeTiles.end(), cluster.nodes.begin(), cluster.nodes.end());
+        nodeClusters.insert(nodeClusters.end(), cluster.nodes.size(), clusterId);
+    }
+
+    auto nodeIndex = [](const Cluster& cluster, int tile) {
+        return (int)(std::lower_bound(cluster.nodes.begin(), cluster.nodes.end(), tile) - cluster.nodes.begin());
+    };
+    for (Cluster& cluster : clusters) {
+        cluster.links.clear();
+        for (const auto& [here, there] : cluster.tileLinks) {
+            const Cluster& other = clusters[clusterOf(there)];
+            cluster.links.push_back({ nodeIndex(cluster, here), other.firstNode + nodeIndex(other, there) });
+        }
+        std::sort(cluster.links.begin(), cluster.links.end());
+
+        cluster.linkStarts.assign(cluster.nodes.size() + 1, 0);
+        for (const auto& link : cluster.links) cluster.linkStarts[link.first + 1]++;
+        for (size_t k = 0; k < cluster.nodes.size(); ++k) cluster.linkStarts[k + 1] += cluster.linkStarts[k];
+    }
+}
+
+void HierarchicalPathfinder::searchCluster(int clusterId, int from, std::vector<int>& distances, std::vector<int>* parents) const {
+    const Cluster& cluster = clusters[clusterId];
+    distances.assign((size_t)cluster.rows * cluster.cols, -1);
+    if (parents) parents->assign(distances.size(), -1);
+    if (!walkable[from]) return;
+
+    std::vector<int> queue;
+    queue.reserve(distances.size());
+    distances[localIndex(cluster, from)] = 0;
+    queue.push_back(from);
+    int neighbors[4];
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int tile = queue[head];
+        int next = distances[localIndex(cluster, tile)] + 1;
+        for (int i = 0, n = neighborsOf(tile, neighbors); i < n; ++i) {
+            int neighbor = neighbors[i];
+            if (!contains(cluster, neighbor)) continue;
+            int local = localIndex(cluster, neighbor);
+            if (distances[local] != -1) continue;
+            distances[local] = next;
+            if (parents) (*parents)[local] = tile;
+            queue.push_back(neighbor);
+        }
+    }
+}
+
+bool HierarchicalPathfinder::refineInCluster(int clusterId, int from, int to, std::deque<Tile*>& out) const {
+    if (from == to) return true;
+    const Cluster& cluster = clusters[clusterId];
+    std::vector<int> distances, parents;
+    searchCluster(clusterId, from, distances, &parents);
+    if (distances[localIndex(cluster, to)] < 0) return false;
+
+    std::vector<int> reversed;
+    for (int tile = to; tile != from; tile = parents[localIndex(cluster, tile)]) reversed.push_back(tile);
+    for (auto it = reversed.rbegin(); it != reversed.rend(); ++it) out.push_back(tiles[*it]);
+    return true;
+}
+
+int HierarchicalPathfinder::getTransitionCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    int count = 0;
+    for (const Cluster& cluster : clusters) count += (int)cluster.nodes.size();
+    return count;
+}
+
+HierarchicalPathfinder::Route HierarchicalPathfinder::findPath(Tile* start, Tile* goal, int refineClusters, SearchStats* stats) const {
+    Route route;
+    if (!start || !goal || start == goal) return route;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (clusters.empty()) return route;
+
+    int s = indexOf(start);
+    int g = indexOf(goal);
+    if (!walkable[s] || !walkable[g]) return route;
+    int startCluster = clusterOf(s);
+    int goalCluster = clusterOf(g);
+
+    // Same cluster and connected inside it, no abstract search needed
+    if (startCluster == goalCluster && refineInCluster(startCluster, s, g, route.tiles)) {
+        return route;
+    }
+
+    std::vector<int> fromStart, toGoal;
+    searchCluster(startCluster, s, fromStart, nullptr);
+    searchCluster(goalCluster, g, toGoal, nullptr);     // moves are symmetric
+
+    // A* over the transitions by global node id, start and goal take part as two extra ids
+    const int START = (int)nodeTiles.size();
+    const int GOAL = START + 1;
+    auto tileOf = [&](int id) { return id == START ? s : id == GOAL ? g : nodeTiles[id]; };
+    PortalHeuristic::Goal estimates = portals.toward(goal);
+    auto heuristic = [&](int id) {
+        int tile = tileOf(id);
+        return estimates.estimate(tile / width, tile % width);
+    };
+
+    std::vector<int> cost(nodeTiles.size() + 2, INT_MAX);
+    std::vector<int> cameFrom(nodeTiles.size() + 2, -1);
+    using Entry = std::pair<int, int>;  // f, id
+    std::vector<Entry> heap;
+    heap.reserve(256);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open(std::greater<Entry>(), std::move(heap));
+    cost[START] = 0;
+    open.push({ heuristic(START), START });
+
+    auto relax = [&](int from, int to, int stepCost) {
+        int tentative = cost[from] + stepCost;
+        if (tentative >= cost[to]) return;
+        cost[to] = tentative;
+        cameFrom[to] = from;
+        open.push({ tentative + heuristic(to), to });
+    };
+
+    bool found = false;
+    while (!open.empty()) {
+        auto [f, id] = open.top();
+        open.pop();
+        if (f - heuristic(id) > cost[id]) continue;    // stale entry
+        if (stats) stats->expanded++;
+        if (id == GOAL) {
+            found = true;
+            break;
+        }
+
+        if (id == START) {
+            const Cluster& cluster = clusters[startCluster];
+            for (size_t k = 0; k < cluster.nodes.size(); ++k) {
+                int distance = fromStart[localIndex(cluster, cluster.nodes[k])];
+                if (distance >= 0) relax(id, cluster.firstNode + (int)k, distance);
+            }
+            continue;
+        }
+
+        int clusterId = nodeClusters[id];
+        const Cluster& cluster = clusters[clusterId];
+        size_t count = cluster.nodes.size();
+        size_t k = id - cluster.firstNode;
+        for (size_t j = 0; j < count; ++j) {
+            int distance = cluster.distances[k * count + j];
+            if (j != k && distance > 0) relax(id, cluster.firstNode + (int)j, distance);
+        }
+        for (int link = cluster.linkStarts[k]; link < cluster.linkStarts[k + 1]; ++link) {
+            relax(id, cluster.links[link].second, 1);
+        }
+        if (clusterId == goalCluster) {
+            int distance = toGoal[localIndex(cluster, tileOf(id))];
+            if (distance >= 0) relax(id, GOAL, distance);
+        }
+    }
+    if (!found) return route;
+
+    std::vector<int> abstractPath;
+    for (int id = GOAL; id != START; id = cameFrom[id]) abstractPath.push_back(tileOf(id));
+
+    // Refine hop by hop, stop once the route enters the cluster after the last refined one
+    int entered = 1;
+    int previous = s;
+    for (auto it = abstractPath.rbegin(); it != abstractPath.rend(); ++it) {
+        int next = *it;
+        if (clusterOf(previous) == clusterOf(next)) {
+            refineInCluster(clusterOf(previous), previous, next, route.tiles);
+        }
+        else {
+            route.tiles.push_back(tiles[next]);
+            if (++entered > refineClusters && next != g) {
+                route.partial = true;
+                break;
+            }
+        }
+        previous = next;
+    }
+    return route;
+}
@@ -0,0 +1,149 @@
+#include "HudCache.h"
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+HudCache::~HudCache() {
+    release();
+}
+
+bool HudCache::isSupported() {
+    return GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object;
+}
+
+bool HudCache::isUsable() const {
+    return !broken && isSupported();
+}
+
+void HudCache::release() {
+    if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+    if (depthBuffer) glDeleteRenderbuffers(1, &depthBuffer);
+    if (colorTexture) glDeleteTextures(1, &colorTexture);
+    framebuffer = depthBuffer = colorTexture = 0;
+    textureWidth = textureHeight = 0;
+    valid = false;
+}
+
+bool HudCache::ensureTarget(int width, int height) {
+    if (framebuffer && width == textureWidth && height == textureHeight) {
+        return true;
+    }
+    release();
+
+    glGenTextures(1, &colorTexture);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "HudCache: framebuffer incomplete (0x" << std::hex << status << std::dec << ")" << std::endl;
+        release();
+        broken = true;
+        return false;
+    }
+
+    textureWidth = width;
+    textureHeight = height;
+    return true;
+}
+
+bool HudCache::bake(int key, const HudRect& rect, const std::function<void()>& drawFn) {
+    float width = rect.x1 - rect.x0;
+    float depth = rect.z1 - rect.z0;
+    if (width <= 0.0f || depth <= 0.0f) return false;
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    int texW = std::clamp((int)std::ceil(width * PIXELS_PER_UNIT), 1, maxSize);
+    int texH = std::clamp((int)std::ceil(depth * PIXELS_PER_UNIT), 1, maxSize);
+    if (!ensureTarget(texW, texH)) return false;
+
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    GLfloat previousClearColor[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, previousClearColor);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, texW, texH);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Top-down ortho camera over the rect, screen up = -z so the texture
+    // maps onto the floor the same way the geometry would have been seen
+    float cx = (rect.x0 + rect.x1) * 0.5f;
+    float cz = (rect.z0 + rect.z1) * 0.5f;
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(-width * 0.5f, width * 0.5f, -depth * 0.5f, depth * 0.5f, 0.1f, BAKE_EYE_HEIGHT * 2.0f);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    gluLookAt(cx, rect.y + BAKE_EYE_HEIGHT, cz,
+              cx, rect.y, cz,
+              0.0f, 0.0f, -1.0f);
+
+    drawFn();
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    glClearColor(previousClearColor[0], previousClearColor[1], previousClearColor[2], previousClearColor[3]);
+
+    bakedRect = rect;
+    cachedKey = key;
+    valid = true;
+    return true;
+}
+
+void HudCache::render() const {
+    if (!valid) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    // Baked over a transparent clear, so the colors are already premultiplied
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+    FrameStats::getInstance().countDrawCalls(1);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    float y = bakedRect.y + QUAD_LIFT;
+    glBegin(GL_QUADS);
+        glNormal3f(0.0f, 1.0f, 0.0f);
+        glTexCoord2f(0.0f, 0.0f); glVertex3f(bakedRect.x0, y, bakedRect.z1);
+        glTexCoord2f(1.0f, 0.0f); glVertex3f(bakedRect.x1, y, bakedRect.z1);
+        glTexCoord2f(1.0f, 1.0f); glVertex3f(bakedRect.x1, y, bakedRect.z0);
+        glTexCoord2f(0.0f, 1.0f); glVertex3f(bakedRect.x0, y, bakedRect.z0);
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glPopAttrib();
+}
@@ -0,0 +1,117 @@
+#include "LevelPack.h"
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include "CompiledMap.h"
+
+static_assert(std::endian::native == std::endian::little, "Level packs are stored little endian");
+
+std::shared_ptr<const LevelPack> LevelPack::open(const std::string& path) {
+    std::shared_ptr<LevelPack> pack(new LevelPack());
+    pack->path = path;
+    if (!pack->file.open(path)) return nullptr;
+    if (pack->file.size() < sizeof(Header)) {
+        std::cerr << "LevelPack: " << path << " is too small" << std::endl;
+        return nullptr;
+    }
+    pack->header = reinterpret_cast<const Header*>(pack->file.data());
+    if (!pack->validate()) return nullptr;
+    return pack;
+}
+
+// Index, names and every level's map, a bad level would otherwise only show up when it is played
+bool LevelPack::validate() const {
+    auto fail = [&](const std::string& what) {
+        std::cerr << "LevelPack: " << path << ": " << what << std::endl;
+        return false;
+    };
+
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) return fail("not a level pack");
+    if (header->version != VERSION) {
+        return fail("version " + std::to_string(header->version) + ", expected " + std::to_string(VERSION) + " (rebuild with pacman_mapc --pack)");
+    }
+    if (header->levelCount == 0) return fail("no levels");
+
+    uint64_t size = file.size();
+    if (header->indexOffset % 8 != 0 || header->indexOffset > size || (uint64_t)header->levelCount * sizeof(Entry) > size - header->indexOffset) {
+        return fail("index out of bounds");
+    }
+    if (header->namesOffset > size || header->namesSize > size - header->namesOffset) return fail("names out of bounds");
+    for (int level = 0; level < getLevelCount(); ++level) {
+        const Entry& e = entry(level);
+        if (e.offset % 8 != 0 || e.offset > size || e.size > size - e.offset) return fail("level " + std::to_string(level) + " out of bounds");
+        if ((uint64_t)e.nameOffset + e.nameLength > header->namesSize) return fail("name of level " + std::to_string(level) + " out of bounds");
+        CompiledMap board;
+        if (!board.openBytes(file.data() + e.offset, e.size, path + " level " + std::to_string(level))) {
+            return fail("level " + std::to_string(level) + " is not a valid map");
+        }
+    }
+    return true;
+}
+
+LevelPack::LevelInfo LevelPack::getInfo(int level) const {
+    const Entry& e = entry(level);
+    LevelInfo info;
+    info.name.assign(reinterpret_cast<const char*>(file.data() + header->namesOffset + e.nameOffset), e.nameLength);
+    info.difficulty = e.difficulty;
+    info.playerSpeed = e.playerSpeed;
+    info.ghostSpeed = e.ghostSpeed;
+    return info;
+}
+
+std::shared_ptr<const MapTemplate> LevelPack::loadTemplate(int level) const {
+    if (level < 0 || level >= getLevelCount()) return nullptr;
+    const Entry& e = entry(level);
+    return MapTemplate::view(file.data() + e.offset, e.size, path + " level " + std::to_string(level), shared_from_this());
+}
+
+bool LevelPack::write(const std::vector<Level>& levels, const std::string& path) {
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.levelCount = (uint32_t)levels.size();
+
+    std::vector<Entry> index(levels.size());
+    std::string names;
+    for (size_t level = 0; level < levels.size(); ++level) {
+        const LevelInfo& info = levels[level].info;
+        Entry& e = index[level];
+        e = {};
+        e.nameOffset = (uint32_t)names.size();
+        e.nameLength = (uint32_t)info.name.size();
+        e.difficulty = info.difficulty;
+        e.playerSpeed = info.playerSpeed;
+        e.ghostSpeed = info.ghostSpeed;
+        names += info.name;
+    }
+
+    std::vector<uint8_t> out(sizeof(Header));
+    auto align = [&]() { out.resize((out.size() + 7) & ~size_t(7), 0); };
+    auto append = [&](const void* data, size_t bytes) {
+        const uint8_t* begin = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), begin, begin + bytes);
+    };
+    // Index goes in once the level offsets are known
+    align();
+    header.indexOffset = out.size();
+    out.resize(out.size() + index.size() * sizeof(Entry), 0);
+    header.namesOffset = out.size();
+    header.namesSize = names.size();
+    append(names.data(), names.size());
+    for (size_t level = 0; level < levels.size(); ++level) {
+        if (!levels[level].board) {
+            std::cerr << "LevelPack: level " << level << " has no map" << std::endl;
+            return false;
+        }
+        std::vector<uint8_t> compiled = CompiledMap::encode(*levels[level].board);
+        align();
+        index[level].offset = out.size();
+        index[level].size = compiled.size();
+        append(compiled.data(), compiled.size());
+    }
+    std::memcpy(out.data(), &header, sizeof(Header));
+    std::memcpy(out.data() + header.indexOffset, index.data(), index.size() * sizeof(Entry));
+
+    // A running game may have the old pack mapped
+    return MappedFile::replace(path, out.data(), out.size());
+}
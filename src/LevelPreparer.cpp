@@ -0,0 +1,155 @@
+#include "LevelPreparer.h"
+#include "MapFactory.h"
+
+void LevelPreparer::start() {
+    if (worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    worker = std::thread(&LevelPreparer::workerLoop, this);
+}
+
+void LevelPreparer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    retired.clear();
+}
+
+void LevelPreparer::prepare(const Source& source) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Already there or on its way
+        if ((ready && readySource == source) || (building && buildingSource == source)) return;
+        pendingSource = source;
+        pending = true;
+    }
+    changed.notify_all();
+}
+
+std::shared_ptr<Map> LevelPreparer::take(const Source& source) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (worker.joinable()) {
+        // Half built is still closer than starting over
+        changed.wait(lock, [&] {
+            return stopping || !((building && buildingSource == source) || (pending && pendingSource == source));
+        });
+    }
+    if (ready && readySource == source) {
+        preparedTakes++;
+        return std::move(ready);
+    }
+    if (pending && pendingSource == source) pending = false;
+    lock.unlock();
+
+    inlineTakes++;
+    return build(source);
+}
+
+void LevelPreparer::retire(std::shared_ptr<Map> map) {
+    if (!map || !worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired.push_back(std::move(map));
+    }
+    changed.notify_all();
+}
+
+void LevelPreparer::forget(const Source& source) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (templateSource == source) cachedTemplate.reset();
+        if (ready && readySource == source) retired.push_back(std::move(ready));
+        forgets++;
+    }
+    changed.notify_all();
+}
+
+std::shared_ptr<Map> LevelPreparer::build(const Source& source) {
+    std::shared_ptr<const MapTemplate> board;
+    uint64_t started;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cachedTemplate && templateSource == source) board = cachedTemplate;
+        started = forgets;
+    }
+    // Own factory per build, the worker and the caller never share one
+    MapFactory factory;
+    if (!board) {
+        if (source.pack) board = source.pack->loadTemplate(source.packLevel);
+        else board = source.generated ? factory.generateTemplate(source.seed) : factory.loadTemplate(source.mapPath);
+        if (!board) return nullptr;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (forgets == started) {
+            templateSource = source;
+            cachedTemplate = board;
+        }
+    }
+    return std::make_shared<Map>(factory.createMapFromTemplate(board));
+}
+
+void LevelPreparer::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // Polls while a retired map is still in use somewhere
+        if (retired.empty()) changed.wait(lock, [&] { return stopping || pending || !retired.empty(); });
+        else changed.wait_for(lock, RETIRE_POLL, [&] { return stopping || pending; });
+        if (stopping) return;
+        // A waiting take comes first, freeing can wait
+        if (!pending) {
+            releaseRetired(lock);
+            continue;
+        }
+
+        buildingSource = pendingSource;
+        building = true;
+        pending = false;
+        uint64_t started = forgets;
+        lock.unlock();
+        std::shared_ptr<Map> map = build(buildingSource);
+        lock.lock();
+
+        // A forget() while it was built may have come after the file was read, build it again
+        if (forgets != started) {
+            if (map) retired.push_back(std::move(map));
+            building = false;
+            if (!pending) {
+                pendingSource = buildingSource;
+                pending = true;
+            }
+            changed.notify_all();
+            continue;
+        }
+        // An unused map from an older request goes the same way as the played ones
+        if (ready) retired.push_back(std::move(ready));
+        building = false;
+        readySource = buildingSource;
+        ready = std::move(map);
+        changed.notify_all();
+    }
+}
+
+void LevelPreparer::releaseRetired(std::unique_lock<std::mutex>& lock) {
+    std::vector<std::shared_ptr<Map>> unused;
+    for (size_t i = 0; i < retired.size();) {
+        // Nothing takes weak_from_this and nobody keeps a raw pointer to a retired map to call
+        // shared_from_this on, so a count of one can not go up again
+        if (retired[i].use_count() == 1) {
+            unused.push_back(std::move(retired[i]));
+            retired[i] = std::move(retired.back());
+            retired.pop_back();
+        }
+        else i++;
+    }
+    if (unused.empty()) return;
+    lock.unlock();
+    unused.clear();
+    lock.lock();
+}
@@ -1,10 +1,14 @@
 #include "Map.h"
 #include "gl_includes.h"
+#include <algorithm>
+#include <bit>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
 #include <iostream>
 #include "Game.h"
+#include "DebugDraw.h"
+#include "MapTemplate.h"
 #include <random>
 
 const std::vector<MapCorner> Map::corners = {
@@ -14,19 +18,123 @@ const std::vector<MapCorner> Map::corners = {
                                                 MapCorner::BOTTOM_RIGHT
                                             };
 
+std::atomic<uint64_t> Map::nextTopologyVersion{ 1 };
+
 Map::Map() {
 }
 
-Map::Map(const std::vector<std::vector<std::shared_ptr<Tile>>>& mapGrid, float tileSize, int totalPellets) {
+Map::Map(const std::vector<std::vector<std::shared_ptr<Tile>>>& mapGrid, float tileSize, int totalPellets, const NavGraph::PackedView* navTables) {
     this->grid = mapGrid;
     this->height = mapGrid.size();  // Number of rows
     this->width = (this->height > 0) ? mapGrid[0].size() : 0;  // Number of columns (checking if the grid is not empty)
     this->tileSize = tileSize;
     this->totalPellets = totalPellets;
-    mapCornerPoints.lowerLeft = Point3D(-MapFactory::MAP_WIDTH / 2.0f, MapFactory::MAP_Y, -MapFactory::MAP_HEIGHT / 2.0f);
-    mapCornerPoints.lowerRight = Point3D(MapFactory::MAP_WIDTH / 2.0f, MapFactory::MAP_Y, -MapFactory::MAP_HEIGHT / 2.0f);
-    mapCornerPoints.upperLeft = Point3D(-MapFactory::MAP_WIDTH / 2.0f, MapFactory::MAP_Y, MapFactory::MAP_HEIGHT / 2.0f);
-    mapCornerPoints.upperRight = Point3D(MapFactory::MAP_WIDTH / 2.0f, MapFactory::MAP_Y, MapFactory::MAP_HEIGHT / 2.0f);
+    float halfWidth = width * tileSize / 2.0f;
+    float halfHeight = height * tileSize / 2.0f;
+    mapCornerPoints.lowerLeft = Point3D(-halfWidth, MapFactory::MAP_Y, -halfHeight);
+    mapCornerPoints.lowerRight = Point3D(halfWidth, MapFactory::MAP_Y, -halfHeight);
+    mapCornerPoints.upperLeft = Point3D(-halfWidth, MapFactory::MAP_Y, halfHeight);
+    mapCornerPoints.upperRight = Point3D(halfWidth, MapFactory::MAP_Y, halfHeight);
+    // Half diagonal against the classic board's, never below 1 so small maps look as before
+    float classicHalfWidth = MapFactory::CLASSIC_WIDTH * MapFactory::TILE_SIZE / 2.0f;
+    float classicHalfHeight = MapFactory::CLASSIC_HEIGHT * MapFactory::TILE_SIZE / 2.0f;
+    viewScale = std::max(1.0f, std::sqrt(halfWidth * halfWidth + halfHeight * halfHeight) /
+                               std::sqrt(classicHalfWidth * classicHalfWidth + classicHalfHeight * classicHalfHeight));
+
+    state.pelletBits.assign((width * height + 63) / 64, 0);
+    state.closedDoorBits.assign((width * height + 63) / 64, 0);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            Tile* tile = grid[row][col].get();
+            if (!tile) continue;
+            int index = row * width + col;
+            if (tile->getTileType() == TileType::PELLET) MapState::set(state.pelletBits, index, true);
+            if (tile->isDoor() && !tile->isWalkable()) MapState::set(state.closedDoorBits, index, true);
+        }
+    }
+    initialState = state;
+    buildNavigation(navTables);
+}
+
+std::vector<Tile*> Map::gridTiles() const {
+    std::vector<Tile*> tiles;
+    tiles.reserve(width * height);
+    for (const auto& row : grid) {
+        for (const auto& tilePtr : row) tiles.push_back(tilePtr.get());
+    }
+    return tiles;
+}
+
+void Map::buildNavigation(const NavGraph::PackedView* navTables) {
+    std::vector<Tile*> tiles = gridTiles();
+    doorTiles.clear();
+    for (Tile* tile : tiles) {
+        if (tile && tile->isDoor()) doorTiles.push_back(tile);
+    }
+
+    bool restored = navTables && navGraph.restore(tiles, width, height, *navTables);
+    if (navTables && !restored) {
+        std::cerr << "Map: compiled nav tables do not match the grid, building them" << std::endl;
+    }
+    if (!restored) navGraph.build(tiles, width, height);
+
+    walkableTiles.clear();
+    componentTiles.assign(navGraph.getComponentCount(), {});
+    for (Tile* tile : tiles) {
+        if (!tile || !tile->isWalkable() || tile->isDoor()) continue;
+        walkableTiles.push_back(tile);
+        componentTiles[navGraph.componentOf(tile)].push_back(tile);
+    }
+    if (width * height >= HIERARCHY_MIN_TILES && !hierarchy) {
+        hierarchy = std::make_shared<HierarchicalPathfinder>();
+        hierarchy->build(tiles, width, height);
+    }
+    bumpTopologyVersion();
+}
+
+void Map::replaceTiles(const std::vector<std::shared_ptr<Tile>>& tiles) {
+    for (const std::shared_ptr<Tile>& tile : tiles) {
+        int row = tile->getTileRow();
+        int col = tile->getTileCol();
+        if (row < 0 || row >= height || col < 0 || col >= width) continue;
+        std::shared_ptr<Tile>& slot = grid[row][col];
+        int index = row * width + col;
+
+        // An eaten pellet that goes away no longer counts as collected
+        if (slot->getInitialTileType() == TileType::PELLET) {
+            totalPellets--;
+            if (!state.hasPellet(index)) state.collectedPellets--;
+        }
+        bool pellet = tile->getTileType() == TileType::PELLET;
+        if (pellet) totalPellets++;
+        bool closedDoor = tile->isDoor() && !tile->isWalkable();
+        MapState::set(state.pelletBits, index, pellet);
+        MapState::set(initialState.pelletBits, index, pellet);
+        MapState::set(state.closedDoorBits, index, closedDoor);
+        MapState::set(initialState.closedDoorBits, index, closedDoor);
+
+        replacedTiles.push_back(std::move(slot));
+        slot = tile;
+    }
+}
+
+void Map::rebuildNavigation(const std::vector<Tile*>& changed, bool teleportsChanged) {
+    // Tables no longer match the grid, spawns are looked up in it from now on
+    mapTemplate.reset();
+    if (hierarchy && teleportsChanged) hierarchy->build(gridTiles(), width, height);
+    else if (hierarchy) hierarchy->replaceTiles(changed);
+    // Junctions and edges may change anywhere along a corridor, tracing is cheap next to a reload
+    buildNavigation(nullptr);
+}
+
+std::deque<Tile*> Map::findPath(Tile* start, Tile* goal, bool& partial) const {
+    partial = false;
+    if (hierarchy) {
+        HierarchicalPathfinder::Route route = hierarchy->findPath(start, goal);
+        partial = route.partial;
+        return std::move(route.tiles);
+    }
+    return navGraph.findPath(start, goal);
 }
 
 Tile* Map::getTileWithPoint3D(Point3D point) {
@@ -43,7 +151,7 @@ Tile* Map::getTileWithPoint3D(Point3D point) {
 }
 
 
-Tile* Map::getTileAt(int row, int col) {
+Tile* Map::getTileAt(int row, int col) const {
     if (row >= 0 && row < height && col >= 0 && col < width) {
         return grid[row][col].get();
     }
@@ -77,64 +185,122 @@ std::vector<Tile*> Map::getTilesWithBoundingBox(BoundingBox3D* absoluteBoundingB
     return intersectedTiles;
 }
 
-void Map::render(bool resetHighlighted, int resetTimerMs) {
+void Map::render(const MapState& state, bool resetHighlighted, int resetTimerMs) {
     if (resetHighlighted) {
         Map::scheduleHighlightReset(resetTimerMs);
     }
 
-    for (const auto& tileRow : grid) {
-        for (const auto& tilePtr : tileRow) {
+    // Labels for every tile are cheap now, they all go into one DebugDraw batch
+    bool debugDraw = DebugDraw::getInstance().isEnabled();
+    if (debugDraw) {
+        drawCenterAxes();
+    }
+
+    // Only the tiles inside the view, on big maps that is a small part of the grid
+    int firstRow, lastRow, firstCol, lastCol;
+    if (!visibleTileRange(firstRow, lastRow, firstCol, lastCol)) return;
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            const auto& tilePtr = grid[row][col];
             if (tilePtr) {
-                // tilePtr->renderOrigin(); // Uncomment if needed
                 tilePtr->render();
-                // renderTileCoordinates(tilePtr.get()); // Uncomment if needed
+                if (debugDraw) {
+                    renderTileCoordinates(tilePtr.get());
+                }
+
+                // Tile type may change under us on the simulation thread, the bitsets do not
+                int index = row * width + col;
+                if (tilePtr->getInitialTileType() == TileType::PELLET && state.hasPellet(index)) {
+                    tilePtr->renderPellet();
+                }
+                if (tilePtr->isDoor()) {
+                    tilePtr->renderDoor(state.isDoorClosed(index));
+                }
             }
         }
     }
 }
 
-void Map::renderWorldCoordinates(const Tile* tile) {
-    BoundingBox3D abb = tile->getAbsoluteBoundingBox();
-    // Render tile coordinate text at center
-    float textX = abb.min.x + 0.1f;
-    float textY = abb.min.y + 0.01f; // Slightly above floor
-    float textZ = abb.min.z + 0.1f;
-    std::ostringstream oss;
-
-    oss << "("
-        << std::fixed << std::setprecision(2) << "X: " << abb.min.x << ", "
-        << std::fixed << std::setprecision(2) << "Z: " << abb.min.z
-        << ")";
-    std::string coordStr = oss.str();
-
-    glColor3f(1.0f, 1.0f, 1.0f); // White text
+// Bounds of the view frustum cut down to the slab the tiles are drawn in (walls, pellets
+// and doors stay within a tile of the floor). Its corners are the frustum corners inside
+// the slab plus where the frustum edges cross the slab planes. False if no tile is in view.
+bool Map::visibleTileRange(int& firstRow, int& lastRow, int& firstCol, int& lastCol) const {
+    firstRow = 0;
+    lastRow = height - 1;
+    firstCol = 0;
+    lastCol = width - 1;
+    if (width == 0 || height == 0) return false;
+
+    GLdouble modelview[16];
+    GLdouble projection[16];
+    GLint viewport[4];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    double corners[8][3];
+    for (int i = 0; i < 8; ++i) {
+        double windowX = viewport[0] + ((i & 1) ? viewport[2] : 0);
+        double windowY = viewport[1] + ((i & 2) ? viewport[3] : 0);
+        double windowZ = (i & 4) ? 1.0 : 0.0;
+        // Singular matrices, draw everything rather than guess
+        if (!gluUnProject(windowX, windowY, windowZ, modelview, projection, viewport, &corners[i][0], &corners[i][1], &corners[i][2])) {
+            return true;
+        }
+    }
 
-    glRasterPos3f(textX, textY, textZ);
-    for (char c : coordStr) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_10, c);
+    double slabMin = MapFactory::MAP_Y - tileSize;
+    double slabMax = MapFactory::MAP_Y + 2.0 * tileSize;
+    double minX = INFINITY, maxX = -INFINITY, minZ = INFINITY, maxZ = -INFINITY;
+    auto include = [&](double x, double z) {
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minZ = std::min(minZ, z);
+        maxZ = std::max(maxZ, z);
+    };
+    for (int i = 0; i < 8; ++i) {
+        if (corners[i][1] >= slabMin && corners[i][1] <= slabMax) include(corners[i][0], corners[i][2]);
+        // The 12 edges join corners that differ in one bit
+        for (int bit = 1; bit < 8; bit <<= 1) {
+            if (i & bit) continue;
+            const double* a = corners[i];
+            const double* b = corners[i | bit];
+            for (double plane : { slabMin, slabMax }) {
+                if ((a[1] - plane) * (b[1] - plane) >= 0.0) continue;
+                double t = (plane - a[1]) / (b[1] - a[1]);
+                include(a[0] + (b[0] - a[0]) * t, a[2] + (b[2] - a[2]) * t);
+            }
+        }
     }
+    if (minX > maxX) return false;
+
+    // Same origin as MapFactory: tile (row, col) starts at ((col - width / 2) * tileSize, (row - height / 2) * tileSize)
+    auto toIndex = [this](double world, int count) { return (int)std::floor(world / tileSize + count / 2.0); };
+    firstCol = std::max(0, toIndex(minX, width));
+    lastCol = std::min(width - 1, toIndex(maxX, width));
+    firstRow = std::max(0, toIndex(minZ, height));
+    lastRow = std::min(height - 1, toIndex(maxZ, height));
+    return firstCol <= lastCol && firstRow <= lastRow;
 }
 
-void Map::renderTileCoordinates(const Tile* tile) {
+void Map::renderWorldCoordinates(const Tile* tile) {
     BoundingBox3D abb = tile->getAbsoluteBoundingBox();
-    // Render tile coordinate text at center
-    float textX = abb.min.x + 0.1f;
-    float textY = abb.min.y + 0.01f; // Slightly above floor
-    float textZ = abb.min.z + 0.1f;
     std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << "X:" << abb.min.x << " Z:" << abb.min.z;
 
-    oss << "("
-        << std::fixed << std::setprecision(2) << "R: " << tile->getTileRow() << ", "
-        << std::fixed << std::setprecision(2) << "C: " << tile->getTileCol()
-        << ")";
-    std::string coordStr = oss.str();
+    // Centered on the tile, slightly above floor
+    Point3D center((abb.min.x + abb.max.x) / 2.0f, abb.min.y + 0.01f, (abb.min.z + abb.max.z) / 2.0f);
+    DebugDraw::getInstance().label(center, oss.str(), DebugColor{ 1.0f, 1.0f, 1.0f, 1.0f });
+}
 
-    glColor3f(1.0f, 1.0f, 1.0f); // White text
+void Map::renderTileCoordinates(const Tile* tile) {
+    BoundingBox3D abb = tile->getAbsoluteBoundingBox();
+    // Just "row,col", anything longer overlaps the neighbours in the overview camera
+    std::string coordStr = std::to_string(tile->getTileRow()) + "," + std::to_string(tile->getTileCol());
 
-    glRasterPos3f(textX, textY, textZ);
-    for (char c : coordStr) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_10, c);
-    }
+    Point3D center((abb.min.x + abb.max.x) / 2.0f, abb.min.y + 0.01f, (abb.min.z + abb.max.z) / 2.0f);
+    DebugDraw::getInstance().label(center, coordStr, DebugColor{ 1.0f, 1.0f, 1.0f, 0.8f });
 }
 
 void Map::resetHighlightedTiles() {
@@ -149,6 +315,8 @@ void Map::resetHighlightedTiles() {
 
 // Schedule a reset after a specified delay in milliseconds
 void Map::scheduleHighlightReset(int delay) {
+    // No GLUT timers without a window
+    if (Game::getInstance().isHeadless()) return;
     if (!isHighlightResetScheduled) {
         glutTimerFunc(delay, [](int value) {
             // Reset the highlight of tiles after the specified time
@@ -160,72 +328,40 @@ void Map::scheduleHighlightReset(int delay) {
     }
 }
 
-Tile* Map::getRandomTile() {
-    if (height == 0 || width == 0) return nullptr;
+Tile* Map::getRandomTile(const Tile* from) {
+    const std::vector<Tile*>* table = &walkableTiles;
+    int component = navGraph.componentOf(from);
+    if (component != NavGraph::NONE && (size_t)component < componentTiles.size()) {
+        table = &componentTiles[component];
+    }
+    if (table->empty()) return nullptr;
 
     static std::random_device rd;
     static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> rowDist(0, height - 1);
-    std::uniform_int_distribution<> colDist(0, width - 1);
-
-    Tile* tile = nullptr;
-    int attempts = 0;
-    const int maxAttempts = 100;
-
-    while (attempts < maxAttempts) {
-        int row = rowDist(gen);
-        int col = colDist(gen);
-        std::shared_ptr<Tile> tilePtr = grid[row][col];
-
-        if (tilePtr && tilePtr->isWalkable()) {
-            return tilePtr.get();  // Return raw Tile* from shared_ptr
-        }
-
-        attempts++;
-    }
-
-    return nullptr; // Fallback if no walkable tile found
+    std::uniform_int_distribution<size_t> dist(0, table->size() - 1);
+    return (*table)[dist(gen)];
 }
 
 
 void Map::drawCenterAxes(float length) {
-    glLineWidth(2.0f);
-    glBegin(GL_LINES);
-
-    // X-axis (Red)
-    glColor3f(1.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(length, 0.0f, 0.0f);
-
-    // Y-axis (Green)
-    glColor3f(0.0f, 1.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, length, 0.0f);
+    DebugDraw& debug = DebugDraw::getInstance();
+    const DebugColor red{ 1.0f, 0.0f, 0.0f, 1.0f };
+    const DebugColor green{ 0.0f, 1.0f, 0.0f, 1.0f };
+    const DebugColor blue{ 0.0f, 0.0f, 1.0f, 1.0f };
+    Point3D zero(0.0f, 0.0f, 0.0f);
 
-    // Z-axis (Blue)
-    glColor3f(0.0f, 0.0f, 1.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, length);
-
-    glEnd();
-    glLineWidth(1.0f); // Reset to default
+    debug.line(zero, Point3D(length, 0.0f, 0.0f), red);
+    debug.line(zero, Point3D(0.0f, length, 0.0f), green);
+    debug.line(zero, Point3D(0.0f, 0.0f, length), blue);
 
     // Axis labels
-    glColor3f(1.0f, 0.0f, 0.0f); // X label
-    glRasterPos3f(length + 0.1f, 0.0f, 0.0f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'X');
-
-    glColor3f(0.0f, 1.0f, 0.0f); // Y label
-    glRasterPos3f(0.0f, length + 0.1f, 0.0f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'Y');
-
-    glColor3f(0.0f, 0.0f, 1.0f); // Z label
-    glRasterPos3f(0.0f, 0.0f, length + 0.1f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'Z');
+    debug.label(Point3D(length + 0.1f, 0.0f, 0.0f), "X", red, 2);
+    debug.label(Point3D(0.0f, length + 0.1f, 0.0f), "Y", green, 2);
+    debug.label(Point3D(0.0f, 0.0f, length + 0.1f), "Z", blue, 2);
 }
 
 bool Map::areAllPelletsCollected() const {
-    if (totalPellets == mapCollectedPellets) {
+    if (totalPellets == state.collectedPellets) {
         return true;
     }
     return false;
@@ -233,12 +369,54 @@ bool Map::areAllPelletsCollected() const {
 
 bool Map::collectPellet(Tile* tile) {
     if (tile->collectPellet()) {
-        mapCollectedPellets++;
+        state.collectedPellets++;
+        MapState::set(state.pelletBits, tile->getTileRow() * width + tile->getTileCol(), false);
         return true;
     }
     return false;
 }
 
+bool Map::setDoorOpen(Tile* door, bool open) {
+    if (!door || !door->isDoor() || door->isWalkable() == open) return false;
+    door->setDoorOpen(open);
+    navGraph.setBlocked(door, !open);
+    if (hierarchy) hierarchy->setWalkable(door, open);
+
+    MapState::set(state.closedDoorBits, door->getTileRow() * width + door->getTileCol(), !open);
+    return true;
+}
+
+bool Map::restoreState(const MapState& target) {
+    if (target.pelletBits.size() != state.pelletBits.size() || target.closedDoorBits.size() != state.closedDoorBits.size()) {
+        std::cerr << "Map: state does not belong to a " << width << "x" << height << " map" << std::endl;
+        return false;
+    }
+
+    // Only the pellets that differ, a level restart mostly puts back what was eaten
+    for (size_t word = 0; word < state.pelletBits.size(); ++word) {
+        uint64_t changed = state.pelletBits[word] ^ target.pelletBits[word];
+        while (changed) {
+            int bit = std::countr_zero(changed);
+            changed &= changed - 1;
+            int index = (int)word * 64 + bit;
+            Tile* tile = grid[index / width][index % width].get();
+            if (!tile || tile->getInitialTileType() != TileType::PELLET) continue;
+            if ((target.pelletBits[word] >> bit) & 1) tile->resetTileType();
+            else tile->collectPellet();
+        }
+    }
+    state.pelletBits = target.pelletBits;
+    state.collectedPellets = target.collectedPellets;
+
+    bool doorsChanged = false;
+    for (Tile* door : doorTiles) {
+        int index = door->getTileRow() * width + door->getTileCol();
+        if (setDoorOpen(door, !target.isDoorClosed(index))) doorsChanged = true;
+    }
+    if (doorsChanged) bumpTopologyVersion();
+    return true;
+}
+
 Tile* Map::getPlayerSpawn() {
     return getFirstTileOfType(TileType::SPAWN_PLAYER);
 }
@@ -259,10 +437,20 @@ Tile* Map::getClydeSpawn() {
     return getFirstTileOfType(TileType::SPAWN_CLYDE);
 }
 
+bool Map::hasAllSpawns() {
+    return getPlayerSpawn() && getBlinkySpawn() && getPinkySpawn() && getInkySpawn() && getClydeSpawn();
+}
+
 // Helper function
 Tile* Map::getFirstTileOfType(TileType type) {
-    for (int y = 0; y < MapFactory::MAP_HEIGHT; ++y) {
-        for (int x = 0; x < MapFactory::MAP_WIDTH; ++x) {
+    // Spawns are in the template's table, no need to scan the grid
+    CompiledMap::Spawn spawn = CompiledMap::spawnOf(type);
+    if (mapTemplate && spawn != CompiledMap::SPAWN_COUNT) {
+        int index = mapTemplate->getSpawn(spawn);
+        return index >= 0 ? grid[index / width][index % width].get() : nullptr;
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
             if (grid[y][x]->getTileType() == type) {
                 return grid[y][x].get(); // returns raw Tile* from shared_ptr
             }
@@ -1,4 +1,5 @@
 #include "MapFactory.h"
+#include <algorithm>
 #include <vector>
 #include <fstream>    // For file I/O
 #include <sstream>    // For stringstream to parse lines
@@ -6,67 +7,282 @@
 #include "Tile.h"
 #include "Macro.h"
 #include "TileWall.h"
+#include "CompiledMap.h"
+#include "MapTemplate.h"
+#include "MazeGenerator.h"
+#include <filesystem>
 
-MapFactory::MapFactory() {
-    // Initialize the grid with the specified dimensions, filled with EMPTY tiles
-    createDefaultGrid();
+Map MapFactory::createMap(const std::string& mapPath) {
+    return createMapFromTemplate(loadTemplate(mapPath));
 }
 
-Map MapFactory::createMap() {
-    generateEmptyMapFile("assets\\maps\\blank.map");
-    loadMapFile("assets\\maps\\1.map");
+Map MapFactory::createMapFromRows(const std::vector<std::string>& rows) {
+    parseRows(rows);
     return Map(grid, TILE_SIZE, getTotalGridPellets());
 }
 
-void MapFactory::createDefaultGrid() {
-    // Initialize the grid with tiles of specific types or positions
-    for (int y = 0; y < MAP_HEIGHT; ++y) {  // Loop through rows (height)
-        std::vector<std::shared_ptr<Tile>> row;  // Temporary vector to hold a row of tiles
+Map MapFactory::createGeneratedMap(uint32_t seed, int width, int height) {
+    return createMapFromTemplate(generateTemplate(seed, width, height));
+}
 
-        for (int x = 0; x < MAP_WIDTH; ++x) {  // Loop through columns (width)
-            // Center the grid around (0,0) in world space
-            float xPosMin = (x - MAP_WIDTH / 2.0f) * TILE_SIZE;
-            float yPosMin = (y - MAP_HEIGHT / 2.0f) * TILE_SIZE;
+std::shared_ptr<const MapTemplate> MapFactory::loadTemplate(const std::string& mapPath) {
+    // Compiled by pacman_mapc at build time, the text map is the fallback
+    // Not one older than the text, that is a designer's edit the build has not seen yet
+    std::filesystem::path compiledPath = std::filesystem::path(mapPath).replace_extension(".pmap");
+    std::error_code error;
+    auto compiledTime = std::filesystem::last_write_time(compiledPath, error);
+    bool current = !error;
+    auto textTime = std::filesystem::last_write_time(mapPath, error);
+    if (current && (error || compiledTime >= textTime)) {
+        if (std::shared_ptr<const MapTemplate> compiled = MapTemplate::open(compiledPath.string())) return compiled;
+    }
+    if (!loadMapFile(mapPath)) return nullptr;
+    return MapTemplate::capture(Map(grid, TILE_SIZE, getTotalGridPellets()));
+}
 
-            // Set the origin of the tile at the bottom-left corner
-            Point3D tileOrigin = Point3D(xPosMin, MAP_Y, yPosMin);
+std::shared_ptr<const MapTemplate> MapFactory::generateTemplate(uint32_t seed, int width, int height) {
+    MazeGenerator::Options options;
+    options.width = width;
+    options.height = height;
+    std::vector<std::string> rows;
+    if (!MazeGenerator::generate(seed, options, rows)) return loadTemplate();
+    return MapTemplate::capture(createMapFromRows(rows));
+}
 
-            // Define the bounding box relative to the tile's origin
-            Point3D bbMin = Point3D(0.0f, 0.0f, 0.0f);  // Minimum of bounding box is the origin
-            Point3D bbMax = Point3D(TILE_SIZE, TILE_SIZE, TILE_SIZE);  // Max point of the bounding box is offset by TILE_SIZE
+// Tiles straight from the tables, no wall classification, neighbour search or graph tracing
+Map MapFactory::createMapFromTemplate(std::shared_ptr<const MapTemplate> source) {
+    clearGrid();
+    if (!source) return Map(grid, TILE_SIZE, 0);
+    gridWidth = source->getWidth();
+    gridHeight = source->getHeight();
+    std::span<const uint8_t> tileTypes = source->getTileTypes();
+    std::span<const uint8_t> wallTypes = source->getWallTypes();
+    grid.reserve(gridHeight);
+    for (int row = 0; row < gridHeight; ++row) {
+        std::vector<std::shared_ptr<Tile>> tileRow;
+        tileRow.reserve(gridWidth);
+        for (int col = 0; col < gridWidth; ++col) {
+            int index = row * gridWidth + col;
+            tileRow.push_back(createTile((TileType)tileTypes[index], (WallType)wallTypes[index], row, col));
+        }
+        grid.push_back(std::move(tileRow));
+    }
 
-            // Create the bounding box relative to the origin
-            BoundingBox3D tileBoundingBox = BoundingBox3D(bbMin, bbMax);
+    setAdjacentNeighbors();
+    for (const MapTemplate::Link& link : source->getLinks()) {
+        Tile* tile = grid[link.tile / gridWidth][link.tile % gridWidth].get();
+        Tile* target = grid[link.target / gridWidth][link.target % gridWidth].get();
+        switch (link.direction) {
+        case CompiledMap::LINK_UP: tile->setTileUp(target); break;
+        case CompiledMap::LINK_DOWN: tile->setTileDown(target); break;
+        case CompiledMap::LINK_LEFT: tile->setTileLeft(target); break;
+        case CompiledMap::LINK_RIGHT: tile->setTileRight(target); break;
+        }
+    }
+
+    Map map(grid, TILE_SIZE, source->getPelletCount(), &source->getNavTables());
+    map.setTemplate(std::move(source));
+    return map;
+}
 
-            // Add a tile to the row
-            row.push_back(std::make_shared<Tile>(TileType::EMPTY, tileOrigin, tileBoundingBox, y, x));
+bool MapFactory::patchMap(Map& map, const std::vector<std::string>& rows, std::vector<Tile*>* changed) {
+    std::string error;
+    if (!validateRows(rows, error)) {
+        std::cerr << "MapFactory: not patching the map, " << error << std::endl;
+        return false;
+    }
+    if ((int)rows.size() != map.getHeight() || (int)rows[0].size() != map.getWidth()) return false;
+    gridWidth = map.getWidth();
+    gridHeight = map.getHeight();
+
+    std::vector<std::shared_ptr<Tile>> tiles;
+    bool teleportsChanged = false;
+    for (int row = 0; row < gridHeight; ++row) {
+        for (int col = 0; col < gridWidth; ++col) {
+            TileType type;
+            tileTypeOf(rows[row][col], type);
+            TileType oldType = map.getTileAt(row, col)->getInitialTileType();
+            if (oldType == type) continue;
+            if (type == TileType::TELEPORT || oldType == TileType::TELEPORT) teleportsChanged = true;
+            tiles.push_back(createTile(type, WallType::BLOCK, row, col));
+        }
+    }
+    if (changed) changed->clear();
+    if (tiles.empty()) return true;
+    map.replaceTiles(tiles);
+
+    // The new tiles and whoever pointed at the old ones, teleport pairs after all grid links
+    std::vector<Tile*> relinked;
+    const int dr[5] = { 0, -1, 1, 0, 0 };
+    const int dc[5] = { 0, 0, 0, -1, 1 };
+    for (const std::shared_ptr<Tile>& tile : tiles) {
+        for (int i = 0; i < 5; ++i) {
+            Tile* neighbor = map.getTileAt(tile->getTileRow() + dr[i], tile->getTileCol() + dc[i]);
+            if (!neighbor) continue;
+            relinkTile(map, neighbor);
+            relinked.push_back(neighbor);
+        }
+    }
+    for (Tile* tile : relinked) linkTeleport(map, tile);
+
+    // Wall shapes look at the 3x3 around them, after every link is back
+    for (const std::shared_ptr<Tile>& tile : tiles) {
+        for (int row = tile->getTileRow() - 1; row <= tile->getTileRow() + 1; ++row) {
+            for (int col = tile->getTileCol() - 1; col <= tile->getTileCol() + 1; ++col) {
+                TileWall* wall = dynamic_cast<TileWall*>(map.getTileAt(row, col));
+                if (!wall) continue;
+                wall->setWallType(WallType::BLOCK);
+                wall->setWallTypeByNeighbors();
+            }
         }
+    }
+
+    std::vector<Tile*> changedTiles;
+    for (const std::shared_ptr<Tile>& tile : tiles) changedTiles.push_back(tile.get());
+    map.rebuildNavigation(changedTiles, teleportsChanged);
+    if (changed) *changed = std::move(changedTiles);
+    return true;
+}
+
+void MapFactory::relinkTile(Map& map, Tile* tile) {
+    int row = tile->getTileRow();
+    int col = tile->getTileCol();
+    tile->setTileUp(map.getTileAt(row - 1, col));
+    tile->setTileDown(map.getTileAt(row + 1, col));
+    tile->setTileLeft(map.getTileAt(row, col - 1));
+    tile->setTileRight(map.getTileAt(row, col + 1));
+}
 
-        // Add the completed row to the grid
-        grid.push_back(row);
+// validateRows made sure the opposite edge has one too
+void MapFactory::linkTeleport(Map& map, Tile* tile) {
+    if (tile->getTileType() != TileType::TELEPORT) return;
+    int row = tile->getTileRow();
+    int col = tile->getTileCol();
+    int lastRow = map.getHeight() - 1;
+    int lastCol = map.getWidth() - 1;
+    if (col == 0 || col == lastCol) {
+        Tile* left = col == 0 ? tile : map.getTileAt(row, 0);
+        Tile* right = col == 0 ? map.getTileAt(row, lastCol) : tile;
+        left->setTileLeft(right);
+        right->setTileRight(left);
+    }
+    if (row == 0 || row == lastRow) {
+        Tile* top = row == 0 ? tile : map.getTileAt(0, col);
+        Tile* bottom = row == 0 ? map.getTileAt(lastRow, col) : tile;
+        top->setTileUp(bottom);
+        bottom->setTileDown(top);
     }
-    // After creating the grid, set tile neighbors for optimized tile search
-    setTileNeighbors();
 }
 
-void MapFactory::setTileNeighbors() {
-    for (int y = 0; y < MAP_HEIGHT; ++y) {
-        for (int x = 0; x < MAP_WIDTH; ++x) {
+bool MapFactory::tileTypeOf(char tileChar, TileType& type) {
+    switch (tileChar) {
+    case 'x': type = TileType::WALL; break;
+    case '*': type = TileType::PELLET; break;
+    case 'o': type = TileType::EMPTY; break;
+    case 'd': type = TileType::DOOR_OPEN; break;
+    case 't': type = TileType::TELEPORT; break;
+    case 's': type = TileType::SPAWN_PLAYER; break;
+    case 'b': type = TileType::SPAWN_BLINKY; break;
+    case 'p': type = TileType::SPAWN_PINKY; break;
+    case 'c': type = TileType::SPAWN_CLYDE; break;
+    case 'i': type = TileType::SPAWN_INKY; break;
+    case 'g': type = TileType::GHOST_HOUSE; break;
+    case 'u': type = TileType::EMPTY_UNWALKABLE; break;
+    default: return false;
+    }
+    return true;
+}
+
+// Everything parseRows asserts on plus what a level needs to be playable
+bool MapFactory::validateRows(const std::vector<std::string>& rows, std::string& error) {
+    int height = (int)rows.size();
+    int width = height > 0 ? (int)rows[0].size() : 0;
+    if (width == 0) {
+        error = "empty map";
+        return false;
+    }
+
+    int spawns[CompiledMap::SPAWN_COUNT] = {};
+    int pellets = 0;
+    for (int row = 0; row < height; ++row) {
+        if ((int)rows[row].size() != width) {
+            error = "row " + std::to_string(row) + " is " + std::to_string(rows[row].size()) + " characters, expected " + std::to_string(width);
+            return false;
+        }
+        for (int col = 0; col < width; ++col) {
+            TileType type;
+            if (!tileTypeOf(rows[row][col], type)) {
+                error = std::string("invalid character '") + rows[row][col] + "' at row " + std::to_string(row) + ", column " + std::to_string(col);
+                return false;
+            }
+            if (type == TileType::PELLET) pellets++;
+            CompiledMap::Spawn spawn = CompiledMap::spawnOf(type);
+            if (spawn != CompiledMap::SPAWN_COUNT) spawns[spawn]++;
+            if (type != TileType::TELEPORT) continue;
+
+            bool onEdge = row == 0 || col == 0 || row == height - 1 || col == width - 1;
+            bool paired = (col == 0 && rows[row][width - 1] == 't') || (col == width - 1 && rows[row][0] == 't') ||
+                          (row == 0 && rows[height - 1][col] == 't') || (row == height - 1 && rows[0][col] == 't');
+            if (!onEdge || !paired) {
+                error = "teleport at row " + std::to_string(row) + ", column " + std::to_string(col) + " is not paired on the opposite edge";
+                return false;
+            }
+        }
+    }
+
+    const char* spawnNames[CompiledMap::SPAWN_COUNT] = { "player (s)", "blinky (b)", "pinky (p)", "inky (i)", "clyde (c)" };
+    for (int spawn = 0; spawn < CompiledMap::SPAWN_COUNT; ++spawn) {
+        if (spawns[spawn] != 1) {
+            error = std::string("expected one ") + spawnNames[spawn] + " spawn, found " + std::to_string(spawns[spawn]);
+            return false;
+        }
+    }
+    if (pellets == 0) {
+        error = "no pellets";
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<Tile> MapFactory::createTile(TileType type, WallType wallType, int row, int col) const {
+    // Centered tile positions (around the origin)
+    float xCentered = (col - gridWidth / 2.0f) * TILE_SIZE;
+    float yCentered = (row - gridHeight / 2.0f) * TILE_SIZE;
+
+    // Create the origin and bounding box for the tile
+    Point3D tileOrigin = Point3D(xCentered, MAP_Y, yCentered);
+    Point3D bbMin = Point3D(0.0f, 0.0f, 0.0f);  // Min point of bounding box at origin
+    Point3D bbMax = Point3D(TILE_SIZE, TILE_SIZE, TILE_SIZE);  // Max point offset by TILE_SIZE
+    BoundingBox3D tileBoundingBox = BoundingBox3D(bbMin, bbMax);
+
+    if (type == TileType::WALL) {
+        return std::make_shared<TileWall>(wallType, type, tileOrigin, tileBoundingBox, row, col);
+    }
+    return std::make_shared<Tile>(type, tileOrigin, tileBoundingBox, row, col);
+}
+
+void MapFactory::setAdjacentNeighbors() {
+    for (int y = 0; y < gridHeight; ++y) {
+        for (int x = 0; x < gridWidth; ++x) {
             // Access the Tile object through shared_ptr
             std::shared_ptr<Tile> tile = grid[y][x];
 
             // Set adjacent neighbors
             if (x > 0) tile->setTileLeft(grid[y][x - 1].get());
-            if (x < MAP_WIDTH - 1) tile->setTileRight(grid[y][x + 1].get());
+            if (x < gridWidth - 1) tile->setTileRight(grid[y][x + 1].get());
             if (y > 0) tile->setTileUp(grid[y - 1][x].get());
-            if (y < MAP_HEIGHT - 1) tile->setTileDown(grid[y + 1][x].get());
+            if (y < gridHeight - 1) tile->setTileDown(grid[y + 1][x].get());
         }
     }
+}
+
+void MapFactory::setTileNeighbors() {
+    setAdjacentNeighbors();
 
     // Set horizontal teleport neighbors (left <-> right)
-    for (int y = 0; y < MAP_HEIGHT; ++y) {
+    for (int y = 0; y < gridHeight; ++y) {
         std::shared_ptr<Tile> leftTile = grid[y][0];
-        std::shared_ptr<Tile> rightTile = grid[y][MAP_WIDTH - 1];
+        std::shared_ptr<Tile> rightTile = grid[y][gridWidth - 1];
 
         if (leftTile->getTileType() == TileType::TELEPORT ||
             rightTile->getTileType() == TileType::TELEPORT) {
@@ -83,9 +299,9 @@ void MapFactory::setTileNeighbors() {
     }
 
     // Set vertical teleport neighbors (top <-> bottom)
-    for (int x = 0; x < MAP_WIDTH; ++x) {
+    for (int x = 0; x < gridWidth; ++x) {
         std::shared_ptr<Tile> topTile = grid[0][x];
-        std::shared_ptr<Tile> bottomTile = grid[MAP_HEIGHT - 1][x];
+        std::shared_ptr<Tile> bottomTile = grid[gridHeight - 1][x];
 
         if (topTile->getTileType() == TileType::TELEPORT ||
             bottomTile->getTileType() == TileType::TELEPORT) {
@@ -103,8 +319,8 @@ void MapFactory::setTileNeighbors() {
 }
 
 void MapFactory::setWallType() {
-    for (int y = 0; y < MAP_HEIGHT; ++y) {
-        for (int x = 0; x < MAP_WIDTH; ++x) {
+    for (int y = 0; y < gridHeight; ++y) {
+        for (int x = 0; x < gridWidth; ++x) {
             std::shared_ptr<Tile> tile = grid[y][x];
 
             // Skip if null or not a wall tile
@@ -123,8 +339,8 @@ void MapFactory::setWallType() {
 
 int MapFactory::getTotalGridPellets() {
     int totalPellets = 0;
-    for (int y = 0; y < MAP_HEIGHT; ++y) {
-        for (int x = 0; x < MAP_WIDTH; ++x) {
+    for (int y = 0; y < gridHeight; ++y) {
+        for (int x = 0; x < gridWidth; ++x) {
             if (grid[y][x]->getTileType() == TileType::PELLET) {
                 totalPellets++;
             }
@@ -135,113 +351,92 @@ int MapFactory::getTotalGridPellets() {
 
 
 bool MapFactory::isValidCoord(int x, int y) {
-    return x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT;
+    return x >= 0 && x < gridWidth && y >= 0 && y < gridHeight;
 }
 
-bool MapFactory::loadMapFile(const std::string& filename) {
-    std::ifstream file(filename);
+bool MapFactory::readRows(const std::string& path, std::vector<std::string>& rows) {
+    std::ifstream file(path);
     if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << filename << std::endl;
+        std::cerr << "Failed to open file: " << path << std::endl;
         return false;
     }
 
-    grid.clear(); // Rebuild the grid from scratch
+    rows.clear();
     std::string line;
-    int row = 0;
 
-    // Read the map from the file line by line
-    while (std::getline(file, line) && row < MAP_HEIGHT) {
-        // Ensure the line has the correct width
-        if (line.length() != MAP_WIDTH) {
+    // Read the map from the file line by line, the size is whatever the file holds
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) rows.push_back(line);
+    }
+    file.close();
+
+    if (rows.empty()) {
+        std::cerr << "Map file is empty: " << path << std::endl;
+        return false;
+    }
+    if (std::max(rows.size(), rows[0].size()) > (size_t)CompiledMap::MAX_SIDE) {
+        std::cerr << "Map is larger than " << CompiledMap::MAX_SIDE << " tiles a side: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MapFactory::loadMapFile(const std::string& filename) {
+    std::vector<std::string> rows;
+    if (!readRows(filename, rows)) return false;
+
+    // parseRows checks that every row is as wide as the first
+    return parseRows(rows);
+}
+
+// A half built grid would be walked past its end, leave an empty map instead
+void MapFactory::clearGrid() {
+    grid.clear();
+    gridWidth = 0;
+    gridHeight = 0;
+}
+
+bool MapFactory::parseRows(const std::vector<std::string>& rows) {
+    grid.clear(); // Rebuild the grid from scratch
+    gridHeight = (int)rows.size();
+    gridWidth = gridHeight > 0 ? (int)rows[0].size() : 0;
+
+    for (int row = 0; row < gridHeight; row++) {
+        const std::string& line = rows[row];
+        if ((int)line.length() != gridWidth) {
             std::cerr << "Invalid line length at row " << row
-                << ". Expected " << MAP_WIDTH << " characters." << std::endl;
+                << ". Expected " << gridWidth << " characters." << std::endl;
+            clearGrid();
             return false;
         }
 
         std::vector<std::shared_ptr<Tile>> tileRow;
+        tileRow.reserve(gridWidth);
 
-        for (int col = 0; col < MAP_WIDTH; col++) {
+        for (int col = 0; col < gridWidth; col++) {
             char tileChar = line[col];
             TileType type;
-
-            // Map the character from file to TileType
-            switch (tileChar) {
-            case 'x': type = TileType::WALL; break;
-            case '*': type = TileType::PELLET; break;
-            case 'o': type = TileType::EMPTY; break;
-            case 'd': type = TileType::DOOR_OPEN; break;
-            case 't': type = TileType::TELEPORT; break;
-            case 's': type = TileType::SPAWN_PLAYER; break;
-            case 'b': type = TileType::SPAWN_BLINKY; break;
-            case 'p': type = TileType::SPAWN_PINKY; break;
-            case 'c': type = TileType::SPAWN_CLYDE; break;
-            case 'i': type = TileType::SPAWN_INKY; break;
-            case 'g': type = TileType::GHOST_HOUSE; break;
-            case 'u': type = TileType::EMPTY_UNWALKABLE; break;
-            default:
+            if (!tileTypeOf(tileChar, type)) {
                 std::cerr << "Invalid character '" << tileChar << "' at row "
                     << row << ", column " << col << std::endl;
+                clearGrid();
                 return false;
             }
 
-            // Centered tile positions (around the origin)
-            float xCentered = (col - MAP_WIDTH / 2.0f) * TILE_SIZE;
-            float yCentered = (row - MAP_HEIGHT / 2.0f) * TILE_SIZE;
-
-            // Create the origin and bounding box for the tile
-            Point3D tileOrigin = Point3D(xCentered, MAP_Y, yCentered);
-            Point3D bbMin = Point3D(0.0f, 0.0f, 0.0f);  // Min point of bounding box at origin
-            Point3D bbMax = Point3D(TILE_SIZE, TILE_SIZE, TILE_SIZE);  // Max point offset by TILE_SIZE
-            BoundingBox3D tileBoundingBox = BoundingBox3D(bbMin, bbMax);
-
             if (type == TileType::TELEPORT) {
-                ASSERT_MSG(row == 0 || col == 0 || row == MAP_HEIGHT - 1 || col == MAP_WIDTH - 1, "Teleports can be on the edge of the map only!");
+                ASSERT_MSG(row == 0 || col == 0 || row == gridHeight - 1 || col == gridWidth - 1, "Teleports can be on the edge of the map only!");
             }
 
-            if (type == TileType::WALL) {
-                tileRow.push_back(std::make_shared<TileWall>(
-                    WallType::BLOCK, type, tileOrigin, tileBoundingBox, row, col));
-            }
-            else {
-                tileRow.push_back(std::make_shared<Tile>(
-                    type, tileOrigin, tileBoundingBox, row, col));
-            }
+            tileRow.push_back(createTile(type, WallType::BLOCK, row, col));
         }
 
         grid.push_back(tileRow);
-        row++;
     }
 
     // After creating the grid, set tile neighbors for optimized tile search
     setTileNeighbors();
     // Set Wall type
     setWallType();
-
-    file.close();
-
-    if (row != MAP_HEIGHT) {
-        std::cerr << "File content does not match expected map height." << std::endl;
-        return false;
-    }
-
     return true;
 }
-
-
-// Method to generate a sample map file filled with '*' characters
-void MapFactory::generateEmptyMapFile(const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << filename << std::endl;
-        return;
-    }
-    // Create a map filled with '*' characters
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            file << '*';  // Write '*' for empty space
-        }
-        file << '\n';  // New line at the end of each row
-    }
-    file.close();
-    //std::cout << "Empty map generated and saved to " << filename << std::endl;
-}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "MapTemplate.h"
+#include <bit>
+#include <iostream>
+#include "Map.h"
+#include "TileWall.h"
+
+std::shared_ptr<const MapTemplate> MapTemplate::open(const std::string& compiledPath) {
+    std::shared_ptr<MapTemplate> result(new MapTemplate());
+    if (!result->compiled.open(compiledPath)) return nullptr;
+    result->readCompiled();
+    return result;
+}
+
+std::shared_ptr<const MapTemplate> MapTemplate::view(const uint8_t* data, size_t size, const std::string& name, std::shared_ptr<const void> owner) {
+    std::shared_ptr<MapTemplate> result(new MapTemplate());
+    if (!result->compiled.openBytes(data, size, name)) return nullptr;
+    result->owner = std::move(owner);
+    result->readCompiled();
+    return result;
+}
+
+void MapTemplate::readCompiled() {
+    width = compiled.getWidth();
+    height = compiled.getHeight();
+    pelletCount = compiled.getPelletCount();
+    for (int spawn = 0; spawn < CompiledMap::SPAWN_COUNT; ++spawn) spawns[spawn] = compiled.getSpawn((Spawn)spawn);
+    tileTypes = compiled.getTileTypes();
+    wallTypes = compiled.getWallTypes();
+    links = compiled.getLinks();
+    navTables = compiled.getNavTables();
+
+    std::span<const uint64_t> pellets = compiled.getPelletBits();
+    initialState.pelletBits.assign(pellets.begin(), pellets.end());
+    initialState.closedDoorBits.assign(pellets.size(), 0);
+    for (size_t index = 0; index < tileTypes.size(); ++index) {
+        if ((TileType)tileTypes[index] == TileType::DOOR_CLOSED) MapState::set(initialState.closedDoorBits, (int)index, true);
+    }
+}
+
+std::shared_ptr<const MapTemplate> MapTemplate::capture(const Map& map) {
+    int width = map.getWidth();
+    int height = map.getHeight();
+    if (width <= 0 || height <= 0 || width > CompiledMap::MAX_SIDE || height > CompiledMap::MAX_SIDE) {
+        std::cerr << "MapTemplate: cannot capture a " << width << "x" << height << " map" << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<MapTemplate> result(new MapTemplate());
+    result->width = width;
+    result->height = height;
+    size_t tileCount = (size_t)width * height;
+    auto indexOf = [width](const Tile* tile) { return (int32_t)(tile->getTileRow() * width + tile->getTileCol()); };
+    result->ownedTileTypes.resize(tileCount);
+    result->ownedWallTypes.assign(tileCount, (uint8_t)WallType::BLOCK);
+    const int dr[4] = { -1, 1, 0, 0 };
+    const int dc[4] = { 0, 0, -1, 1 };
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            const Tile* tile = map.getTileAt(row, col);
+            if (!tile) {
+                std::cerr << "MapTemplate: missing tile at " << row << ", " << col << std::endl;
+                return nullptr;
+            }
+            int32_t index = indexOf(tile);
+            result->ownedTileTypes[index] = (uint8_t)tile->getInitialTileType();
+            if (const TileWall* wall = dynamic_cast<const TileWall*>(tile)) result->ownedWallTypes[index] = (uint8_t)wall->getWallType();
+
+            // First in scan order, same as Map's spawn getters
+            int spawn = CompiledMap::spawnOf(tile->getInitialTileType());
+            if (spawn != CompiledMap::SPAWN_COUNT && result->spawns[spawn] == -1) result->spawns[spawn] = index;
+
+            // Anything but the plain grid neighbour is a teleport
+            const Tile* neighbors[4] = { tile->getTileUp(), tile->getTileDown(), tile->getTileLeft(), tile->getTileRight() };
+            for (int32_t direction = CompiledMap::LINK_UP; direction <= CompiledMap::LINK_RIGHT; ++direction) {
+                const Tile* neighbor = neighbors[direction];
+                if (!neighbor || neighbor == map.getTileAt(row + dr[direction], col + dc[direction])) continue;
+                result->ownedLinks.push_back({ index, direction, indexOf(neighbor) });
+            }
+        }
+    }
+
+    result->initialState = map.getInitialState();
+    for (uint64_t word : result->initialState.pelletBits) result->pelletCount += std::popcount(word);
+
+    map.getNavGraph().pack(result->ownedNavNodes, result->ownedNavEdges, result->ownedNavEdgeTiles, result->ownedNavComponents);
+    result->tileTypes = result->ownedTileTypes;
+    result->wallTypes = result->ownedWallTypes;
+    result->links = result->ownedLinks;
+    result->navTables.nodeTiles = result->ownedNavNodes;
+    result->navTables.edges = result->ownedNavEdges;
+    result->navTables.edgeTiles = result->ownedNavEdgeTiles;
+    result->navTables.components = result->ownedNavComponents;
+    result->navTables.componentCount = map.getNavGraph().getComponentCount();
+    return result;
+}
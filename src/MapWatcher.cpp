@@ -0,0 +1,87 @@
+#include "MapWatcher.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+MapWatcher::~MapWatcher() {
+    stop();
+}
+
+bool MapWatcher::start(const std::string& path) {
+    stop();
+    directory = path.empty() ? std::filesystem::path(".") : std::filesystem::path(path);
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error)) {
+        std::cerr << "MapWatcher: no directory " << directory.string() << std::endl;
+        return false;
+    }
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Editors save in place or write a temp file and rename it over the map
+    if (inotifyFd < 0 || inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "MapWatcher: inotify failed on " << directory.string() << ", polling instead" << std::endl;
+        if (inotifyFd >= 0) ::close(inotifyFd);
+        inotifyFd = -1;
+    }
+    if (inotifyFd < 0) scan(nullptr);
+#else
+    scan(nullptr);
+#endif
+    lastScan = std::chrono::steady_clock::now();
+    watching = true;
+    return true;
+}
+
+void MapWatcher::stop() {
+#ifdef __linux__
+    if (inotifyFd >= 0) ::close(inotifyFd);
+    inotifyFd = -1;
+#endif
+    writeTimes.clear();
+    watching = false;
+}
+
+std::vector<std::filesystem::path> MapWatcher::poll() {
+    std::vector<std::filesystem::path> changed;
+    if (!watching) return changed;
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = ::read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* at = buffer; at < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                at += sizeof(inotify_event) + event->len;
+                if (event->len == 0) continue;
+                std::filesystem::path file = directory / event->name;
+                if (isMapFile(file) && std::find(changed.begin(), changed.end(), file) == changed.end()) changed.push_back(file);
+            }
+        }
+        return changed;
+    }
+#endif
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastScan < POLL_INTERVAL) return changed;
+    lastScan = now;
+    scan(&changed);
+    return changed;
+}
+
+void MapWatcher::scan(std::vector<std::filesystem::path>* changed) {
+    std::error_code error;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (!isMapFile(entry.path())) continue;
+        std::filesystem::file_time_type time = entry.last_write_time(error);
+        if (error) continue;
+        // New since the last scan counts as written too
+        auto [it, inserted] = writeTimes.try_emplace(entry.path().string(), time);
+        if (!inserted && it->second == time) continue;
+        it->second = time;
+        if (changed) changed->push_back(entry.path());
+    }
+}
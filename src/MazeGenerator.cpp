@@ -0,0 +1,299 @@
+#include "MazeGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include "MapFactory.h"
+
+namespace {
+
+// splitmix64, fully specified unlike the std distributions
+struct Random {
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint32_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (uint32_t)((z ^ (z >> 31)) >> 32);
+    }
+    int below(int n) { return (int)(next() % (uint32_t)n); }
+    float unit() { return (float)(next() / 4294967296.0); }
+
+    template <typename T>
+    void shuffle(T* items, int count) {
+        for (int i = count - 1; i > 0; --i) std::swap(items[i], items[below(i + 1)]);
+    }
+};
+
+uint64_t candidateSeed(uint32_t seed, int round, int candidate) {
+    return ((uint64_t)seed << 32) | ((uint64_t)round << 16) | (uint64_t)candidate;
+}
+
+// Rows and columns of the ghost house ring, shared by carve and the checks
+struct Layout {
+    int width, height, half;
+    int firstRow, lastRow;      // cell rows between the border rows
+    int centerCol;              // last cell column of the left half, next to its mirror
+    int ringTop, ringBottom, ringCol;
+
+    Layout(int width, int height) : width(width), height(height), half(width / 2) {
+        firstRow = 4;
+        lastRow = height - 4;
+        centerCol = half - 1;
+        ringTop = (height / 2 - 3) & ~1;
+        ringBottom = ringTop + 6;
+        ringCol = half - 5;
+    }
+    bool isCell(int row, int col) const {
+        return row >= firstRow && row <= lastRow && row % 2 == 0 && col >= 1 && col <= centerCol && col % 2 == 1;
+    }
+    bool inHouse(int row, int col) const { return row > ringTop && row < ringBottom && col > ringCol; }
+};
+
+} // namespace
+
+bool MazeGenerator::isSupportedSize(int width, int height) {
+    return width >= 20 && width % 4 == 0 && height >= 28 && height % 2 == 0 && width <= 4096 && height <= 4096;
+}
+
+bool MazeGenerator::generate(uint32_t seed, const Options& options, std::vector<std::string>& rows, Report* report) {
+    auto start = std::chrono::steady_clock::now();
+    if (!isSupportedSize(options.width, options.height)) {
+        std::cerr << "MazeGenerator: cannot generate a " << options.width << "x" << options.height << " board" << std::endl;
+        return false;
+    }
+
+    int count = std::max(1, options.candidates);
+    std::vector<Candidate> candidates(count);
+    for (int round = 0; round < MAX_ROUNDS; ++round) {
+        auto build = [&](int index) {
+            Candidate& candidate = candidates[index];
+            carve(candidateSeed(seed, round, index), options, candidate.rows);
+            validate(options, candidate);
+        };
+        // The calling thread builds candidate 0 meanwhile
+        std::vector<std::thread> workers;
+        for (int index = 1; index < count; ++index) workers.emplace_back(build, index);
+        build(0);
+        for (std::thread& worker : workers) worker.join();
+
+        for (int index = 0; index < count; ++index) {
+            if (!candidates[index].valid) continue;
+            rows = std::move(candidates[index].rows);
+            if (report) {
+                report->candidate = index;
+                report->rounds = round + 1;
+                report->loopDensity = candidates[index].loopDensity;
+                report->deadEnds = candidates[index].deadEnds;
+                report->ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+            return true;
+        }
+    }
+    std::cerr << "MazeGenerator: no valid board for seed " << seed << std::endl;
+    return false;
+}
+
+void MazeGenerator::carve(uint64_t seed, const Options& options, std::vector<std::string>& rows) {
+    Random random(seed);
+    Layout layout(options.width, options.height);
+    int width = layout.width;
+    int height = layout.height;
+
+    rows.assign(height, std::string(width, 'x'));
+    for (int row = 0; row < 3; ++row) rows[row].assign(width, 'u');
+    for (int row = height - 2; row < height; ++row) rows[row].assign(width, 'u');
+
+    const int dr[4] = { -2, 0, 2, 0 };
+    const int dc[4] = { 0, -2, 0, 2 };
+    // No vertical corridors in the center column, it would make 2x2 blocks with its mirror
+    auto canLink = [&](int row, int col, int k) {
+        int nextRow = row + dr[k];
+        int nextCol = col + dc[k];
+        if (dr[k] != 0 && col == layout.centerCol) return false;
+        return layout.isCell(nextRow, nextCol) && !layout.inHouse(nextRow, nextCol);
+    };
+    auto isLinked = [&](int row, int col, int k) { return rows[row + dr[k] / 2][col + dc[k] / 2] != 'x'; };
+    auto link = [&](int row, int col, int k) {
+        rows[row + dr[k] / 2][col + dc[k] / 2] = '*';
+        rows[row + dr[k]][col + dc[k]] = '*';
+    };
+    // The center column always connects to its mirror
+    auto linkCount = [&](int row, int col) {
+        int links = col == layout.centerCol ? 1 : 0;
+        for (int k = 0; k < 4; ++k) {
+            if (canLink(row, col, k) && isLinked(row, col, k)) links++;
+        }
+        return links;
+    };
+
+    // Ring around the ghost house first, the maze grows out of it
+    std::vector<uint8_t> visited((size_t)width * height, 0);
+    std::vector<std::pair<int, int>> stack;
+    for (int col = layout.ringCol; col <= layout.centerCol; ++col) {
+        rows[layout.ringTop][col] = '*';
+        rows[layout.ringBottom][col] = '*';
+    }
+    for (int row = layout.ringTop; row <= layout.ringBottom; ++row) rows[row][layout.ringCol] = '*';
+    for (int row = layout.ringTop; row <= layout.ringBottom; row += 2) {
+        for (int col = layout.ringCol; col <= layout.centerCol; col += 2) {
+            if (layout.inHouse(row, col) || rows[row][col] != '*') continue;
+            visited[row * width + col] = 1;
+            stack.push_back({ row, col });
+        }
+    }
+
+    // Depth-first over the left half's cells
+    while (!stack.empty()) {
+        auto [row, col] = stack.back();
+        int order[4] = { 0, 1, 2, 3 };
+        random.shuffle(order, 4);
+        bool carved = false;
+        for (int k : order) {
+            if (!canLink(row, col, k) || visited[(row + dr[k]) * width + col + dc[k]]) continue;
+            link(row, col, k);
+            visited[(row + dr[k]) * width + col + dc[k]] = 1;
+            stack.push_back({ row + dr[k], col + dc[k] });
+            carved = true;
+            break;
+        }
+        if (!carved) stack.pop_back();
+    }
+
+    // Braid: dead ends get a second way out, preferably into another dead end
+    std::vector<std::pair<int, int>> cells;
+    for (int row = layout.firstRow; row <= layout.lastRow; row += 2) {
+        for (int col = 1; col <= layout.centerCol; col += 2) {
+            if (!layout.inHouse(row, col)) cells.push_back({ row, col });
+        }
+    }
+    random.shuffle(cells.data(), (int)cells.size());
+    for (auto [row, col] : cells) {
+        if (linkCount(row, col) != 1 || random.unit() >= options.braidChance) continue;
+        int choices[4];
+        int choiceCount = 0;
+        int deadEnd = -1;
+        for (int k = 0; k < 4; ++k) {
+            if (!canLink(row, col, k) || isLinked(row, col, k)) continue;
+            choices[choiceCount++] = k;
+            if (deadEnd < 0 && linkCount(row + dr[k], col + dc[k]) == 1) deadEnd = k;
+        }
+        if (choiceCount == 0) continue;
+        link(row, col, deadEnd >= 0 ? deadEnd : choices[random.below(choiceCount)]);
+    }
+    // And a few loops anywhere, down and right so every wall is seen once
+    for (auto [row, col] : cells) {
+        for (int k : { 2, 3 }) {
+            if (canLink(row, col, k) && !isLinked(row, col, k) && random.unit() < options.extraLoopChance) link(row, col, k);
+        }
+    }
+
+    // Tunnel row, not level with the house
+    std::vector<int> tunnelRows;
+    for (int row = layout.firstRow + 2; row <= layout.lastRow - 2; row += 2) {
+        if (row < layout.ringTop || row > layout.ringBottom) tunnelRows.push_back(row);
+    }
+    if (!tunnelRows.empty()) rows[tunnelRows[random.below((int)tunnelRows.size())]][0] = 't';
+
+    for (std::string& line : rows) {
+        for (int col = 0; col < layout.half; ++col) line[width - 1 - col] = line[col];
+    }
+
+    // Ghost house as on 1.map, the ring stays empty, blinky above the door, player below
+    const char* house[5] = { "xxxddxxx", "xggggggx", "xgigpgcx", "xggggggx", "xxxxxxxx" };
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 8; ++j) rows[layout.ringTop + 1 + i][layout.half - 4 + j] = house[i][j];
+    }
+    for (int col = layout.ringCol; col <= width - 1 - layout.ringCol; ++col) {
+        rows[layout.ringTop][col] = 'o';
+        rows[layout.ringBottom][col] = 'o';
+    }
+    for (int row = layout.ringTop; row <= layout.ringBottom; ++row) {
+        rows[row][layout.ringCol] = 'o';
+        rows[row][width - 1 - layout.ringCol] = 'o';
+    }
+    rows[layout.ringTop][layout.centerCol] = 'b';
+    rows[layout.ringBottom + 6][layout.centerCol] = 's';
+}
+
+void MazeGenerator::validate(const Options& options, Candidate& candidate) {
+    candidate.valid = false;
+    const std::vector<std::string>& rows = candidate.rows;
+    std::string error;
+    if (!MapFactory::validateRows(rows, error)) return;
+
+    int height = (int)rows.size();
+    int width = (int)rows[0].size();
+    // Anything the player walks on, the ghost house is not part of the board's corridors
+    auto isCorridor = [&](int row, int col) {
+        char tile = rows[row][col];
+        return tile == '*' || tile == 'o' || tile == 't' || tile == 's' || tile == 'b';
+    };
+    // Linked like MapFactory::setTileNeighbors, teleports wrap to the opposite edge
+    auto neighbors = [&](int row, int col, int out[4]) {
+        const int dr[4] = { -1, 1, 0, 0 };
+        const int dc[4] = { 0, 0, -1, 1 };
+        int count = 0;
+        for (int k = 0; k < 4; ++k) {
+            int nextRow = row + dr[k];
+            int nextCol = col + dc[k];
+            bool outside = nextRow < 0 || nextRow >= height || nextCol < 0 || nextCol >= width;
+            if (outside && rows[row][col] != 't') continue;
+            nextRow = (nextRow + height) % height;
+            nextCol = (nextCol + width) % width;
+            if (isCorridor(nextRow, nextCol)) out[count++] = nextRow * width + nextCol;
+        }
+        return count;
+    };
+
+    int tiles = 0;
+    int links = 0;
+    int deadEnds = 0;
+    int pellets = 0;
+    int spawn = -1;
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            if (!isCorridor(row, col)) continue;
+            int out[4];
+            int count = neighbors(row, col, out);
+            tiles++;
+            links += count;
+            if (count <= 1) deadEnds++;
+            if (rows[row][col] == '*') pellets++;
+            if (rows[row][col] == 's') spawn = row * width + col;
+        }
+    }
+    if (spawn < 0 || tiles == 0) return;
+
+    // Components over the corridors, the first one (from the spawn) has to hold every pellet
+    std::vector<int> component((size_t)width * height, -1);
+    std::vector<int> queue;
+    int components = 0;
+    int reachedPellets = 0;
+    for (int i = -1; i < width * height; ++i) {
+        int start = i < 0 ? spawn : i;
+        if (component[start] >= 0 || !isCorridor(start / width, start % width)) continue;
+        component[start] = components;
+        queue.assign(1, start);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int current = queue[head];
+            if (components == 0 && rows[current / width][current % width] == '*') reachedPellets++;
+            int out[4];
+            for (int k = 0, n = neighbors(current / width, current % width, out); k < n; ++k) {
+                if (component[out[k]] >= 0) continue;
+                component[out[k]] = components;
+                queue.push_back(out[k]);
+            }
+        }
+        components++;
+    }
+
+    // Independent loops (links - tiles + components) per 100 corridor tiles
+    candidate.loopDensity = 100.0f * (float)(links / 2 - tiles + components) / (float)tiles;
+    candidate.deadEnds = deadEnds;
+    candidate.valid = reachedPellets == pellets && candidate.loopDensity >= options.minLoopDensity && deadEnds <= options.maxDeadEnds;
+}
@@ -1,5 +1,6 @@
 #include "MenuItem.h"
 #include "glft2/TextRenderer.hpp"
+#include "FrameStats.h"
 
 MenuItem::MenuItem(std::shared_ptr<glft2::font_data> font, const std::string& txt, float x, float y, float width, float height, float textScale, float textX, float textY) {
     this->text = txt;
@@ -73,6 +74,7 @@ void MenuItem::render() {
 
     // --- Draw background rectangle with transparency ---
     glColor4ub(backgroundColorRGBA[0], backgroundColorRGBA[1], backgroundColorRGBA[2], backgroundColorRGBA[3]);
+    FrameStats::getInstance().countDrawCalls(1);
     glBegin(GL_QUADS);
     glVertex2f(x, y);
     glVertex2f(x + width, y);
@@ -88,6 +90,7 @@ void MenuItem::render() {
         glColor3ub(textColorRGB[0], textColorRGB[1], textColorRGB[2]);
     }
 
+    FrameStats::getInstance().countDrawCalls(1);
     glft2::render2D(*font, textX, textY, text, textScale);
 
     // --- Disable blending after rendering ---
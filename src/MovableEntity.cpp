@@ -3,6 +3,7 @@
 #include <iostream>
 #include <algorithm>
 #include <math.h>
+#include <cfloat>
 #include "Macro.h"
 
 
@@ -405,13 +406,13 @@ Point3D MovableEntity::furthestPossibleEntityOriginPoint(MoveDir moveDir, Tile*
     int row = currentTile->getTileRow();
     int col = currentTile->getTileCol();
 
-    if (row == MapFactory::MAP_HEIGHT - 1 && moveDir == MoveDir::FWD) {
+    if (row == map->getHeight() - 1 && moveDir == MoveDir::FWD) {
         origin = entityCenteredOrigin(currentTile);
         origin.move(0, 0, MapFactory::TILE_SIZE / 2.0f);
         return origin;
     }
 
-    if (col == MapFactory::MAP_WIDTH - 1 && moveDir == MoveDir::RIGHT) {
+    if (col == map->getWidth() - 1 && moveDir == MoveDir::RIGHT) {
         origin = entityCenteredOrigin(currentTile);
         origin.move(MapFactory::TILE_SIZE / 2.0f, 0, 0);
         return origin;
@@ -438,11 +439,11 @@ bool MovableEntity::headingOutOfMap(MoveDir moveDir, Tile* currentTile) {
     int row = currentTile->getTileRow();
     int col = currentTile->getTileCol();
 
-    if (row == MapFactory::MAP_HEIGHT - 1 && moveDir == MoveDir::FWD) {
+    if (row == map->getHeight() - 1 && moveDir == MoveDir::FWD) {
         return true;
     }
 
-    if (col == MapFactory::MAP_WIDTH - 1 && moveDir == MoveDir::RIGHT) {
+    if (col == map->getWidth() - 1 && moveDir == MoveDir::RIGHT) {
         return true;
     }
 
@@ -0,0 +1,338 @@
+#include "NavGraph.h"
+#include <climits>
+#include <cstdlib>
+#include <queue>
+
+void NavGraph::clear() {
+    nodes.clear();
+    blockedNodes.clear();
+    edges.clear();
+    locations.clear();
+    components.clear();
+    componentCount = 0;
+    walkableTiles = 0;
+    portals.clear();
+}
+
+void NavGraph::build(const std::vector<Tile*>& grid, int width, int height) {
+    clear();
+    this->width = width;
+    this->height = height;
+    locations.assign((size_t)width * height, Location());
+
+    for (Tile* tile : grid) {
+        if (!tile || !isPassable(tile)) continue;
+        walkableTiles++;
+        if (tile->isDoor() || walkableNeighborCount(tile) != 2) {
+            int node = addNode(tile);
+            blockedNodes[node].value = !tile->isWalkable();
+        }
+    }
+    for (int node = 0; node < (int)nodes.size(); ++node) {
+        traceEdges(node);
+    }
+
+    // Closed loops without any junction, pin a node anywhere on them
+    for (Tile* tile : grid) {
+        if (!tile || !isPassable(tile)) continue;
+        const Location& location = locations[indexOf(tile)];
+        if (location.node == NONE && location.edge == NONE) {
+            traceEdges(addNode(tile));
+        }
+    }
+
+    labelComponents(grid);
+    portals.build(grid);
+}
+
+bool NavGraph::restore(const std::vector<Tile*>& grid, int width, int height, const PackedView& packed) {
+    clear();
+    this->width = width;
+    this->height = height;
+    size_t tileCount = (size_t)width * height;
+    if (grid.size() != tileCount || packed.components.size() != tileCount) return false;
+    locations.assign(tileCount, Location());
+
+    auto fail = [this]() {
+        clear();
+        return false;
+    };
+    for (int32_t index : packed.nodeTiles) {
+        if (index < 0 || (size_t)index >= tileCount || !grid[index] || !isPassable(grid[index])) return fail();
+        if (locations[index].node != NONE) return fail();
+        int node = addNode(grid[index]);
+        blockedNodes[node].value = !grid[index]->isWalkable();
+    }
+
+    // Edges were added in id order and each one went onto both end nodes right away,
+    // replaying them gives the same per node edge order as tracing
+    int nodeCount = (int)nodes.size();
+    for (const PackedEdge& packedEdge : packed.edges) {
+        if (packedEdge.from < 0 || packedEdge.from >= nodeCount || packedEdge.to < 0 || packedEdge.to >= nodeCount) return fail();
+        if (packedEdge.firstTile < 0 || packedEdge.tileCount < 0 || (size_t)packedEdge.firstTile + packedEdge.tileCount > packed.edgeTiles.size()) return fail();
+
+        Edge edge;
+        edge.from = packedEdge.from;
+        edge.to = packedEdge.to;
+        edge.length = packedEdge.tileCount + 1;
+        edge.tiles.reserve(packedEdge.tileCount);
+        int id = (int)edges.size();
+        for (int i = 0; i < packedEdge.tileCount; ++i) {
+            int32_t index = packed.edgeTiles[packedEdge.firstTile + i];
+            if (index < 0 || (size_t)index >= tileCount || !grid[index]) return fail();
+            edge.tiles.push_back(grid[index]);
+            locations[index].edge = id;
+            locations[index].index = i;
+        }
+        edges.push_back(std::move(edge));
+        nodes[packedEdge.from].edges.push_back(id);
+        nodes[packedEdge.to].edges.push_back(id);
+    }
+
+    components.assign(packed.components.begin(), packed.components.end());
+    componentCount = packed.componentCount;
+    for (size_t i = 0; i < tileCount; ++i) {
+        if (components[i] < NONE || components[i] >= componentCount) return fail();
+        if (grid[i] && isPassable(grid[i])) walkableTiles++;
+    }
+    portals.build(grid);
+    return true;
+}
+
+void NavGraph::pack(std::vector<int32_t>& nodeTiles, std::vector<PackedEdge>& packedEdges, std::vector<int32_t>& edgeTiles, std::vector<int32_t>& tileComponents) const {
+    nodeTiles.clear();
+    packedEdges.clear();
+    edgeTiles.clear();
+    for (const Node& node : nodes) nodeTiles.push_back(indexOf(node.tile));
+    for (const Edge& edge : edges) {
+        packedEdges.push_back({ edge.from, edge.to, (int32_t)edgeTiles.size(), (int32_t)edge.tiles.size() });
+        for (const Tile* tile : edge.tiles) edgeTiles.push_back(indexOf(tile));
+    }
+    tileComponents.assign(components.begin(), components.end());
+}
+
+// Flood fill per unlabeled walkable tile, one pass over the grid
+void NavGraph::labelComponents(const std::vector<Tile*>& grid) {
+    components.assign((size_t)width * height, NONE);
+    std::vector<Tile*> stack;
+    for (Tile* seed : grid) {
+        if (!seed || !isPassable(seed) || components[indexOf(seed)] != NONE) continue;
+
+        int label = componentCount++;
+        components[indexOf(seed)] = label;
+        stack.push_back(seed);
+        while (!stack.empty()) {
+            Tile* tile = stack.back();
+            stack.pop_back();
+            for (Tile* neighbor : walkableNeighbors(tile)) {
+                int index = indexOf(neighbor);
+                if (components[index] != NONE) continue;
+                components[index] = label;
+                stack.push_back(neighbor);
+            }
+        }
+    }
+}
+
+int NavGraph::componentOf(const Tile* tile) const {
+    if (!tile) return NONE;
+    int index = indexOf(tile);
+    if (index < 0 || (size_t)index >= components.size()) return NONE;
+    return components[index];
+}
+
+bool NavGraph::isReachable(const Tile* from, const Tile* to) const {
+    int component = componentOf(from);
+    return component != NONE && component == componentOf(to);
+}
+
+int NavGraph::addNode(Tile* tile) {
+    Node node;
+    node.tile = tile;
+    nodes.push_back(node);
+    blockedNodes.emplace_back();
+    int id = (int)nodes.size() - 1;
+    locations[indexOf(tile)].node = id;
+    return id;
+}
+
+// Walks every corridor leaving the node until the next node, each corridor is added once
+void NavGraph::traceEdges(int node) {
+    Tile* start = nodes[node].tile;
+    for (Tile* first : walkableNeighbors(start)) {
+        Edge edge;
+        edge.from = node;
+
+        Tile* previous = start;
+        Tile* current = first;
+        while (nodeAt(current) == NONE) {
+            // Already traced from the other end
+            if (locations[indexOf(current)].edge != NONE) break;
+            edge.tiles.push_back(current);
+            locations[indexOf(current)].edge = (int)edges.size();
+            locations[indexOf(current)].index = (int)edge.tiles.size() - 1;
+
+            Tile* next = nullptr;
+            for (Tile* neighbor : walkableNeighbors(current)) {
+                if (neighbor != previous) next = neighbor;
+            }
+            if (!next) break;
+            previous = current;
+            current = next;
+        }
+
+        int end = nodeAt(current);
+        if (end == NONE) {
+            // Hit a traced corridor, nothing was added in this direction
+            if (edge.tiles.empty()) continue;
+            // Cannot happen on a consistent grid, undo the partial trace
+            for (Tile* tile : edge.tiles) locations[indexOf(tile)].edge = NONE;
+            continue;
+        }
+        // Node right next to node, keep one of the two directions
+        if (edge.tiles.empty() && end < node) continue;
+        if (edge.tiles.empty() && end == node) continue;
+
+        edge.to = end;
+        edge.length = (int)edge.tiles.size() + 1;
+        int id = (int)edges.size();
+        edges.push_back(std::move(edge));
+        nodes[node].edges.push_back(id);
+        nodes[end].edges.push_back(id);
+    }
+}
+
+int NavGraph::nodeAt(const Tile* tile) const {
+    if (!tile) return NONE;
+    int index = indexOf(tile);
+    if (index < 0 || (size_t)index >= locations.size()) return NONE;
+    return locations[index].node;
+}
+
+NavGraph::Location NavGraph::locate(const Tile* tile) const {
+    if (!tile) return Location();
+    int index = indexOf(tile);
+    if (index < 0 || (size_t)index >= locations.size()) return Location();
+    return locations[index];
+}
+
+bool NavGraph::setBlocked(const Tile* tile, bool blocked) {
+    int node = nodeAt(tile);
+    if (node == NONE) return false;
+    blockedNodes[node].value.store(blocked, std::memory_order_relaxed);
+    return true;
+}
+
+bool NavGraph::isPassable(const Tile* tile) {
+    return tile->isWalkable() || tile->isDoor();
+}
+
+int NavGraph::walkableNeighborCount(const Tile* tile) {
+    return (int)walkableNeighbors(tile).size();
+}
+
+std::vector<Tile*> NavGraph::walkableNeighbors(const Tile* tile) {
+    std::vector<Tile*> neighbors;
+    for (Tile* neighbor : { tile->getTileUp(), tile->getTileDown(), tile->getTileLeft(), tile->getTileRight() }) {
+        if (neighbor && isPassable(neighbor)) neighbors.push_back(neighbor);
+    }
+    return neighbors;
+}
+
+std::deque<Tile*> NavGraph::findPath(Tile* start, Tile* goal, SearchStats* stats) const {
+    if (!start || !goal || start == goal || nodes.empty()) return {};
+
+    Location s = locate(start);
+    Location g = locate(goal);
+    if ((s.node == NONE && s.edge == NONE) || (g.node == NONE && g.edge == NONE)) return {};
+    // Otherwise the search would exhaust the whole start area first
+    if (!isReachable(start, goal)) return {};
+    // Standing in a door that just closed is fine, walking into one is not
+    if (g.node != NONE && isBlocked(g.node)) return {};
+
+    // Corridor tiles take part as two extra search ids
+    const int count = (int)nodes.size();
+    const int startId = s.node != NONE ? s.node : count;
+    const int goalId = g.node != NONE ? g.node : count + 1;
+
+    struct Step {
+        int previous = NONE;
+        int edge = NONE;
+        bool forward = true;    // along Edge::tiles order
+    };
+    std::vector<int> cost(count + 2, INT_MAX);
+    std::vector<Step> cameFrom(count + 2);
+
+    auto tileOf = [&](int id) { return id == count ? start : id == count + 1 ? goal : nodes[id].tile; };
+    PortalHeuristic::Goal estimates = portals.toward(goal);
+    auto heuristic = [&](int id) { return estimates.estimate(tileOf(id)); };
+
+    using Entry = std::pair<int, int>;  // f, id
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    cost[startId] = 0;
+    open.push({ heuristic(startId), startId });
+
+    auto relax = [&](int from, int to, int stepCost, int edge, bool forward) {
+        if (to < count && isBlocked(to)) return;
+        int tentative = cost[from] + stepCost;
+        if (tentative >= cost[to]) return;
+        cost[to] = tentative;
+        cameFrom[to] = { from, edge, forward };
+        open.push({ tentative + heuristic(to), to });
+    };
+
+    bool found = false;
+    while (!open.empty()) {
+        auto [f, id] = open.top();
+        open.pop();
+        if (f - heuristic(id) > cost[id]) continue;    // stale entry
+        if (stats) stats->expanded++;
+        if (id == goalId) {
+            found = true;
+            break;
+        }
+
+        if (id == count) {
+            // Off a corridor tile, both ends of its edge and maybe the goal on the same edge
+            const Edge& edge = edges[s.edge];
+            relax(id, edge.from, s.index + 1, s.edge, false);
+            relax(id, edge.to, edge.length - (s.index + 1), s.edge, true);
+            if (g.edge == s.edge) relax(id, goalId, std::abs(g.index - s.index), s.edge, g.index > s.index);
+            continue;
+        }
+
+        for (int e : nodes[id].edges) {
+            const Edge& edge = edges[e];
+            if (edge.from == id) relax(id, edge.to, edge.length, e, true);
+            if (edge.to == id) relax(id, edge.from, edge.length, e, false);
+            if (g.edge == e) {
+                if (edge.from == id) relax(id, goalId, g.index + 1, e, true);
+                if (edge.to == id) relax(id, goalId, edge.length - (g.index + 1), e, false);
+            }
+        }
+    }
+    if (!found) return {};
+
+    std::vector<int> route;
+    for (int id = goalId; id != startId; id = cameFrom[id].previous) route.push_back(id);
+
+    // Expand the node hops back into tiles
+    std::deque<Tile*> path;
+    for (auto it = route.rbegin(); it != route.rend(); ++it) {
+        int id = *it;
+        const Step& step = cameFrom[id];
+        const std::vector<Tile*>& tiles = edges[step.edge].tiles;
+        int last = (int)tiles.size() - 1;
+
+        int from = step.previous == count ? s.index + (step.forward ? 1 : -1) : (step.forward ? 0 : last);
+        int to = id == count + 1 ? g.index : (step.forward ? last : 0);
+        if (step.forward) {
+            for (int i = from; i <= to; ++i) path.push_back(tiles[i]);
+        }
+        else {
+            for (int i = from; i >= to; --i) path.push_back(tiles[i]);
+        }
+        if (id != count + 1) path.push_back(nodes[id].tile);
+    }
+    return path;
+}
@@ -0,0 +1,113 @@
+#include "PathCache.h"
+#include <algorithm>
+
+void PathCache::setVersion(uint64_t newVersion) {
+    if (newVersion == version) return;
+    clear();
+    version = newVersion;
+}
+
+bool PathCache::find(uint32_t start, uint32_t goal, std::vector<uint32_t>& path) {
+    auto it = lookup.find(makeKey(start, goal));
+    if (it == lookup.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    const Entry& entry = *it->second;
+    path.assign(arena.begin() + entry.offset, arena.begin() + entry.offset + entry.length);
+    return true;
+}
+
+void PathCache::insert(uint32_t start, uint32_t goal, const std::vector<uint32_t>& path) {
+    if (maxEntries == 0 || path.size() > maxArenaTiles) return;
+
+    uint64_t key = makeKey(start, goal);
+    auto it = lookup.find(key);
+    if (it != lookup.end()) {
+        // Same search twice in flight, the first result is as good
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    while (!entries.empty() && (entries.size() >= maxEntries || liveTiles + path.size() > maxArenaTiles)) {
+        evictOldest();
+    }
+    if (arena.size() + path.size() > maxArenaTiles) {
+        compact();
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.offset = (uint32_t)arena.size();
+    entry.length = (uint32_t)path.size();
+    arena.insert(arena.end(), path.begin(), path.end());
+    liveTiles += path.size();
+
+    entries.push_front(entry);
+    lookup[key] = entries.begin();
+}
+
+void PathCache::clear() {
+    entries.clear();
+    lookup.clear();
+    arena.clear();
+    liveTiles = 0;
+}
+
+template <typename Predicate>
+size_t PathCache::eraseIf(Predicate predicate) {
+    size_t erased = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (!predicate(*it)) {
+            ++it;
+            continue;
+        }
+        liveTiles -= it->length;
+        lookup.erase(it->key);
+        it = entries.erase(it);
+        erased++;
+    }
+    if (liveTiles * 2 < arena.size()) {
+        compact();
+    }
+    return erased;
+}
+
+size_t PathCache::invalidateTile(uint32_t tile) {
+    return eraseIf([&](const Entry& entry) {
+        auto begin = arena.begin() + entry.offset;
+        return std::find(begin, begin + entry.length, tile) != begin + entry.length;
+    });
+}
+
+size_t PathCache::invalidateUnreachable() {
+    return eraseIf([](const Entry& entry) {
+        return entry.length == 0 && (uint32_t)(entry.key >> 32) != (uint32_t)entry.key;
+    });
+}
+
+void PathCache::evictOldest() {
+    const Entry& oldest = entries.back();
+    liveTiles -= oldest.length;
+    lookup.erase(oldest.key);
+    entries.pop_back();
+    evictions++;
+
+    if (liveTiles * 2 < arena.size()) {
+        compact();
+    }
+}
+
+// Moves the live paths to the front of the arena, in LRU order
+void PathCache::compact() {
+    std::vector<uint32_t> packed;
+    packed.reserve(liveTiles);
+    for (Entry& entry : entries) {
+        uint32_t offset = (uint32_t)packed.size();
+        packed.insert(packed.end(), arena.begin() + entry.offset, arena.begin() + entry.offset + entry.length);
+        entry.offset = offset;
+    }
+    arena.swap(packed);
+}
@@ -0,0 +1,144 @@
+#include "PathfindingQueue.h"
+#include <chrono>
+
+void PathfindingQueue::start() {
+    if (worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    worker = std::thread(&PathfindingQueue::workerLoop, this);
+}
+
+void PathfindingQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobsAvailable.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+uint64_t PathfindingQueue::submit(std::shared_ptr<const Map> map, Tile* start, Tile* goal) {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ticket = nextTicket++;
+        liveTickets.insert(ticket);
+
+        // A new map throws the old paths away
+        cache.setVersion(map->getTopologyVersion());
+        if (start && goal && cache.find(tileIndex(*map, start), tileIndex(*map, goal), indexScratch)) {
+            Result& result = results[ticket];
+            result.start = start;
+            int width = map->getWidth();
+            for (uint32_t index : indexScratch) {
+                result.path.push_back(map->getTileAt(index / width, index % width));
+            }
+            return ticket;
+        }
+
+        jobs.push_back({ ticket, std::move(map), start, goal, doorEpoch });
+    }
+    jobsAvailable.notify_one();
+    return ticket;
+}
+
+void PathfindingQueue::cancel(uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Queued jobs are skipped when popped, a running one drops its result
+    if (liveTickets.erase(ticket)) cancelledJobs++;
+    results.erase(ticket);
+}
+
+void PathfindingQueue::cancelAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelledJobs += liveTickets.size();
+    liveTickets.clear();
+    results.clear();
+    // Let go of old maps right away
+    jobs.clear();
+}
+
+void PathfindingQueue::cancelAllAndWait() {
+    cancelAll();
+    std::unique_lock<std::mutex> lock(mutex);
+    searchDone.wait(lock, [this] { return !searching; });
+}
+
+void PathfindingQueue::onDoorChanged(const Map& map, const Tile* door, bool open) {
+    std::lock_guard<std::mutex> lock(mutex);
+    doorEpoch++;
+    if (cache.getVersion() != map.getTopologyVersion()) return;
+    if (open) cache.invalidateUnreachable();
+    else cache.invalidateTile(tileIndex(map, door));
+}
+
+PathfindingQueue::Status PathfindingQueue::take(uint64_t ticket, std::deque<Tile*>& path, Tile*& start, bool& partial) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = results.find(ticket);
+    if (it != results.end()) {
+        path = std::move(it->second.path);
+        start = it->second.start;
+        partial = it->second.partial;
+        results.erase(it);
+        liveTickets.erase(ticket);
+        return Status::Ready;
+    }
+    return liveTickets.count(ticket) ? Status::Pending : Status::Unknown;
+}
+
+bool PathfindingQueue::runOne(std::unique_lock<std::mutex>& lock) {
+    while (!jobs.empty()) {
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        if (!liveTickets.count(job.ticket)) continue;
+
+        // The graph structure only changes after cancelAllAndWait and door flags are atomic,
+        // search without the lock
+        searching = true;
+        lock.unlock();
+        Result result;
+        result.start = job.start;
+        result.path = job.map->findPath(job.start, job.goal, result.partial);
+        lock.lock();
+        searching = false;
+        searchDone.notify_all();
+
+        // Cached even if nobody wants it anymore, the topology and doors have to match.
+        // Partial routes are not, a hit has to lead all the way.
+        if (job.start && job.goal && !result.partial && job.doorEpoch == doorEpoch && cache.getVersion() == job.map->getTopologyVersion()) {
+            indexScratch.clear();
+            for (Tile* tile : result.path) indexScratch.push_back(tileIndex(*job.map, tile));
+            cache.insert(tileIndex(*job.map, job.start), tileIndex(*job.map, job.goal), indexScratch);
+        }
+
+        completedJobs++;
+        if (liveTickets.count(job.ticket)) {
+            results[job.ticket] = std::move(result);
+        }
+        return true;
+    }
+    return false;
+}
+
+void PathfindingQueue::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (!runOne(lock)) {
+            jobsAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+        }
+    }
+}
+
+void PathfindingQueue::process(double budgetMs) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (runOne(lock)) {
+        double elapsedMs = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        if (elapsedMs >= budgetMs) break;
+    }
+}
@@ -5,6 +5,9 @@
 #include "Pi.h"
 #include "GameLighting.h"
 #include "GameSounds.h"
+#include "RenderHelper.h"
+#include "FrameStats.h"
+#include "QualityManager.h"
 
 using namespace std::chrono;
 
@@ -35,6 +38,10 @@ Player::Player(Map* map, Point3D playerOrigin, BoundingBox3D playerBoundingBox)
 }
 
 void Player::render() {
+    // Batched by DebugDraw, nothing happens while it is off
+    renderBoundingBox(1.0f, 1.0f, 0.0f);
+    renderOrigin();
+
     Point3D c = getAbsoluteCenterPoint();
     glPushMatrix();
         glTranslatef(c.x, c.y + 0.25f, c.z);
@@ -62,6 +69,7 @@ void Player::render() {
         GameLighting::setMaterial(GL_FRONT_AND_BACK, bodyAmbient, bodyDiffuse, bodySpecular, bodyEmission, shininess);
 
         float R = 0.75f;
+        int segments = QualityManager::getInstance().getSettings().playerSegments;
 
         // Compute clipping angles
         float invDeg = 180.0f - 60.0f - mouthDeg;
@@ -80,13 +88,13 @@ void Player::render() {
             // Draw two spheres separately for mouth
             glPushMatrix();
                 glClipPlane(GL_CLIP_PLANE0, eq0);  glEnable(GL_CLIP_PLANE0);
-                glutSolidSphere(R, 32, 32);
+                RenderHelper::solidSphere(R, segments, segments);
                 glDisable(GL_CLIP_PLANE0);
             glPopMatrix();
 
             glPushMatrix();
                 glClipPlane(GL_CLIP_PLANE1, eq1);  glEnable(GL_CLIP_PLANE1);
-                glutSolidSphere(R, 32, 32);
+                RenderHelper::solidSphere(R, segments, segments);
                 glDisable(GL_CLIP_PLANE1);
             glPopMatrix();
         }
@@ -100,7 +108,7 @@ void Player::render() {
                 glClipPlane(GL_CLIP_PLANE1, eq1);
                 glEnable(GL_CLIP_PLANE1);
 
-                glutSolidSphere(R, 32, 32);
+                RenderHelper::solidSphere(R, segments, segments);
 
                 glDisable(GL_CLIP_PLANE0);
                 glDisable(GL_CLIP_PLANE1);
@@ -124,7 +132,7 @@ void Player::render() {
             glPushMatrix();
                 glClipPlane(GL_CLIP_PLANE0, eq0);
                 glEnable(GL_CLIP_PLANE0);
-                glutSolidSphere(0.75f, 32, 32);
+                RenderHelper::solidSphere(0.75f, segments, segments);
                 glDisable(GL_CLIP_PLANE0);
             glPopMatrix();
 
@@ -132,7 +140,7 @@ void Player::render() {
             glPushMatrix();
                 glClipPlane(GL_CLIP_PLANE1, eq1);
                 glEnable(GL_CLIP_PLANE1);
-                glutSolidSphere(0.75f, 32, 32);
+                RenderHelper::solidSphere(0.75f, segments, segments);
                 glDisable(GL_CLIP_PLANE1);
             glPopMatrix();
 
@@ -141,10 +149,12 @@ void Player::render() {
             glDisable(GL_CULL_FACE);
             glPushMatrix();
                 glRotatef(invDeg, 0, 1, 0);
+                FrameStats::getInstance().countDrawCalls(1);
                 gluDisk(disk, 0.0, 0.75, 32, 1);
             glPopMatrix();
             glPushMatrix();
                 glRotatef(-invDeg, 0, 1, 0);
+                FrameStats::getInstance().countDrawCalls(1);
                 gluDisk(disk, 0.0, 0.75, 32, 1);
             glPopMatrix();
             gluDeleteQuadric(disk);
@@ -166,7 +176,7 @@ void Player::render() {
                 glRotatef(rz, 0.0f, 0.0f, 1.0f);
                 glRotatef(ry, 0.0f, 1.0f, 0.0f);
                 glScalef(1.0f, 1.0f, 0.3f);
-                glutSolidSphere(0.20f, 12, 12);
+                RenderHelper::solidSphere(0.20f, 12, 12);
             glPopMatrix();
             };
 
@@ -183,7 +193,7 @@ void Player::render() {
                 glRotatef(rz, 0.0f, 0.0f, 1.0f);
                 glRotatef(ry, 0.0f, 1.0f, 0.0f);
                 glScalef(1.0f, 1.0f, 0.3f);
-                glutSolidSphere(0.11f, 12, 12);
+                RenderHelper::solidSphere(0.11f, 12, 12);
             glPopMatrix();
             };
 
@@ -336,10 +346,35 @@ void Player::renderDeathAnimation() {
         //glClipPlane(GL_CLIP_PLANE1, eq1);
 
         // draw the body
-        glutSolidSphere(0.75f, 32, 32);
+        RenderHelper::solidSphere(0.75f, 32, 32);
 
         //glDisable(GL_CLIP_PLANE0);
         //glDisable(GL_CLIP_PLANE1);
     glPopMatrix();
     return;   // done
-}
\ No newline at end of file
+}
+PlayerRenderState Player::getRenderState() const {
+    PlayerRenderState state;
+    state.origin = origin;
+    state.boundingBox = boundingBox;
+    state.moveDir = moveDir;
+    state.mouthAnimationState = playerMouthAnimationState;
+    state.deathAnimationState = playerDeathAnimationState;
+    state.deathAnimating = playerDeathAnimating;
+    state.bodyColor[0] = playerBodyColorRed;
+    state.bodyColor[1] = playerBodyColorGreen;
+    state.bodyColor[2] = playerBodyColorBlue;
+    return state;
+}
+
+void Player::applyRenderState(const PlayerRenderState& state) {
+    origin = state.origin;
+    boundingBox = state.boundingBox;
+    moveDir = state.moveDir;
+    playerMouthAnimationState = state.mouthAnimationState;
+    playerDeathAnimationState = state.deathAnimationState;
+    playerDeathAnimating = state.deathAnimating;
+    playerBodyColorRed = state.bodyColor[0];
+    playerBodyColorGreen = state.bodyColor[1];
+    playerBodyColorBlue = state.bodyColor[2];
+}
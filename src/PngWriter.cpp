@@ -0,0 +1,102 @@
+#include "PngWriter.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+static void appendU32(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back((value >> 24) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+uint32_t PngWriter::crc32(const unsigned char* data, size_t length, uint32_t crc) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void PngWriter::appendChunk(std::vector<unsigned char>& out, const char type[4], const std::vector<unsigned char>& data) {
+    appendU32(out, (uint32_t)data.size());
+    size_t crcStart = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    appendU32(out, crc32(out.data() + crcStart, out.size() - crcStart));
+}
+
+bool PngWriter::writeRGBA(const std::string& path, int width, int height,
+                          const unsigned char* pixels, bool flipVertically) {
+    if (width <= 0 || height <= 0 || !pixels) return false;
+
+    // Raw scanlines, each prefixed with filter type 0
+    const size_t rowBytes = (size_t)width * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; y++) {
+        int srcY = flipVertically ? height - 1 - y : y;
+        const unsigned char* row = pixels + rowBytes * srcY;
+        raw.push_back(0);
+        raw.insert(raw.end(), row, row + rowBytes);
+    }
+
+    // zlib stream made of stored blocks (max 65535 bytes each)
+    std::vector<unsigned char> zlib;
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    size_t offset = 0;
+    do {
+        size_t blockSize = std::min<size_t>(65535, raw.size() - offset);
+        bool finalBlock = offset + blockSize == raw.size();
+        zlib.push_back(finalBlock ? 1 : 0);
+        zlib.push_back(blockSize & 0xFF);
+        zlib.push_back((blockSize >> 8) & 0xFF);
+        zlib.push_back(~blockSize & 0xFF);
+        zlib.push_back((~blockSize >> 8) & 0xFF);
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < raw.size());
+
+    uint32_t adlerA = 1, adlerB = 0;
+    for (unsigned char byte : raw) {
+        adlerA = (adlerA + byte) % 65521;
+        adlerB = (adlerB + adlerA) % 65521;
+    }
+    appendU32(zlib, (adlerB << 16) | adlerA);
+
+    std::vector<unsigned char> header;
+    appendU32(header, (uint32_t)width);
+    appendU32(header, (uint32_t)height);
+    header.push_back(8);    // bit depth
+    header.push_back(6);    // color type RGBA
+    header.push_back(0);    // compression
+    header.push_back(0);    // filter
+    header.push_back(0);    // interlace
+
+    std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlib);
+    appendChunk(png, "IEND", {});
+
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file) {
+        std::cerr << "PngWriter: failed to open " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(png.data()), png.size());
+    return file.good();
+}
@@ -0,0 +1,91 @@
+#include "PortalHeuristic.h"
+#include <algorithm>
+#include <climits>
+
+void PortalHeuristic::clear() {
+    portals.clear();
+    distances.clear();
+}
+
+void PortalHeuristic::build(const std::vector<Tile*>& grid) {
+    clear();
+
+    // Links to a tile that is not a grid neighbour are teleports, both ends get listed
+    std::vector<std::pair<const Tile*, const Tile*>> links;
+    for (const Tile* tile : grid) {
+        if (!tile) continue;
+        for (const Tile* neighbor : { tile->getTileUp(), tile->getTileDown(), tile->getTileLeft(), tile->getTileRight() }) {
+            if (!neighbor) continue;
+            if (manhattan(tile->getTileRow(), tile->getTileCol(), neighbor->getTileRow(), neighbor->getTileCol()) == 1) continue;
+            links.push_back({ tile, neighbor });
+        }
+    }
+    if (links.empty()) return;
+
+    std::vector<const Tile*> portalTiles;
+    for (const auto& [from, to] : links) portalTiles.push_back(from);
+    std::sort(portalTiles.begin(), portalTiles.end());
+    portalTiles.erase(std::unique(portalTiles.begin(), portalTiles.end()), portalTiles.end());
+    for (const Tile* tile : portalTiles) portals.push_back({ tile->getTileRow(), tile->getTileCol() });
+    if ((int)portals.size() > MAX_PORTALS) return;
+
+    // Floyd-Warshall over the portal tiles, fine for the handful a map has
+    size_t count = portals.size();
+    distances.assign(count * count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < count; ++j) {
+            distances[i * count + j] = manhattan(portals[i].row, portals[i].col, portals[j].row, portals[j].col);
+        }
+    }
+    auto portalIndex = [&](const Tile* tile) {
+        return std::lower_bound(portalTiles.begin(), portalTiles.end(), tile) - portalTiles.begin();
+    };
+    for (const auto& [from, to] : links) {
+        size_t i = portalIndex(from);
+        size_t j = portalIndex(to);
+        if (j < count && portalTiles[j] == to) distances[i * count + j] = std::min(distances[i * count + j], 1);
+    }
+    for (size_t k = 0; k < count; ++k) {
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = 0; j < count; ++j) {
+                int through = distances[i * count + k] + distances[k * count + j];
+                if (through < distances[i * count + j]) distances[i * count + j] = through;
+            }
+        }
+    }
+}
+
+PortalHeuristic::Goal PortalHeuristic::toward(const Tile* goal) const {
+    Goal result;
+    result.row = goal->getTileRow();
+    result.col = goal->getTileCol();
+    if (portals.empty()) return result;
+
+    // Too many to close over, any teleport still costs a step plus the walk from some portal
+    if (distances.empty()) {
+        int nearest = INT_MAX;
+        for (const Portal& portal : portals) nearest = std::min(nearest, manhattan(portal.row, portal.col, result.row, result.col));
+        result.viaNearest = nearest + 1;
+        return result;
+    }
+
+    size_t count = portals.size();
+    result.entries.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        int toGoal = INT_MAX;
+        for (size_t j = 0; j < count; ++j) {
+            toGoal = std::min(toGoal, distances[i * count + j] + manhattan(portals[j].row, portals[j].col, result.row, result.col));
+        }
+        result.entries.push_back({ portals[i].row, portals[i].col, toGoal });
+    }
+    return result;
+}
+
+int PortalHeuristic::Goal::estimate(int fromRow, int fromCol) const {
+    int best = manhattan(fromRow, fromCol, row, col);
+    if (viaNearest >= 0) return std::min(best, viaNearest);
+    for (const Entry& entry : entries) {
+        best = std::min(best, manhattan(fromRow, fromCol, entry.row, entry.col) + entry.toGoal);
+    }
+    return best;
+}
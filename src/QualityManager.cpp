@@ -0,0 +1,101 @@
+#include "QualityManager.h"
+#include <iostream>
+
+// Indexed by QualityLevel, Ultra matches what the renderers used to hard-code
+static const QualitySettings QUALITY_TABLE[] = {
+    //  player ghost skirt pellet corner sky  msaa
+    {   12,    10,   48,   6,     4,     16,  false },   // Low
+    {   16,    12,   72,   8,     8,     24,  false },   // Medium
+    {   24,    16,   96,   12,    12,    32,  true  },   // High
+    {   32,    18,   128,  16,    16,    32,  true  },   // Ultra
+};
+
+void QualityManager::update(double cpuMs) {
+    auto now = std::chrono::steady_clock::now();
+    if (!hasLastFrame) {
+        lastFrame = now;
+        hasLastFrame = true;
+        if (!seeded) {
+            smoothedCpuMs = cpuMs;
+            smoothedFrameMs = getBudgetMs();
+            seeded = true;
+        }
+        return;
+    }
+    double frameMs = std::chrono::duration<double, std::milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    smoothedFrameMs += (frameMs - smoothedFrameMs) * SMOOTHING;
+    smoothedCpuMs += (cpuMs - smoothedCpuMs) * SMOOTHING;
+
+    if (!adaptive) return;
+    if (cooldownFrames > 0) {
+        cooldownFrames--;
+        return;
+    }
+
+    double budgetMs = getBudgetMs();
+
+    // Frame interval includes vsync, so missing it means the target really is missed
+    if (smoothedFrameMs > budgetMs * DOWNGRADE_RATIO) {
+        slowFrames++;
+        fastFrames = 0;
+    }
+    // Render work alone has to leave plenty of room before paying for more detail
+    else if (smoothedCpuMs < budgetMs * UPGRADE_CPU_RATIO) {
+        fastFrames++;
+        slowFrames = 0;
+    }
+    else {
+        slowFrames = 0;
+        fastFrames = 0;
+    }
+
+    if (slowFrames >= DOWNGRADE_FRAMES && level != QualityLevel::Low) {
+        setLevel(QualityLevel((int)level - 1));
+    }
+    else if (fastFrames >= UPGRADE_FRAMES && level != QualityLevel::Ultra) {
+        setLevel(QualityLevel((int)level + 1));
+    }
+}
+
+void QualityManager::setLevel(QualityLevel newLevel) {
+    level = newLevel;
+    settings = QUALITY_TABLE[(int)newLevel];
+    slowFrames = 0;
+    fastFrames = 0;
+    cooldownFrames = COOLDOWN_FRAMES;
+}
+
+const char* QualityManager::levelName(QualityLevel level) {
+    switch (level) {
+    case QualityLevel::Low:     return "Low";
+    case QualityLevel::Medium:  return "Medium";
+    case QualityLevel::High:    return "High";
+    case QualityLevel::Ultra:   return "Ultra";
+    default:                    return "Unknown";
+    }
+}
+
+void QualityManager::setTargetHz(int hz) {
+    if (hz <= 0) {
+        std::cerr << "QualityManager: invalid target " << hz << " Hz" << std::endl;
+        return;
+    }
+    targetHz = hz;
+    slowFrames = 0;
+    fastFrames = 0;
+    cooldownFrames = COOLDOWN_FRAMES;
+}
+
+void QualityManager::cycleTargetHz() {
+    static const int targets[] = { 60, 120, 144 };
+    int next = targets[0];
+    for (int i = 0; i < 3; i++) {
+        if (targets[i] == targetHz) {
+            next = targets[(i + 1) % 3];
+            break;
+        }
+    }
+    setTargetHz(next);
+}
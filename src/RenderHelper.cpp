@@ -1,8 +1,21 @@
 #include "RenderHelper.h"
 #include "GameLighting.h"
 #include "TileWall.h"
+#include "FrameStats.h"
 #include <cmath>
 
+void RenderHelper::solidSphere(double radius, int slices, int stacks) {
+    // Shared quadric, GLU generates smooth normals by default
+    static GLUquadric* quadric = gluNewQuadric();
+    FrameStats::getInstance().countDrawCalls(1);
+    gluSphere(quadric, radius, slices, stacks);
+}
+
+void RenderHelper::solidCube(float size) {
+    float h = size * 0.5f;
+    renderBox(-h, h, -h, h, -h, h);
+}
+
 float RenderHelper::cubicBezier(float p0, float p1, float p2, float p3, float t) {
     float u = 1 - t;
     return u * u * u * p0 + 3 * u * u * t * p1 + 3 * u * t * t * p2 + t * t * t * p3;
@@ -15,6 +28,7 @@ void RenderHelper::renderBox(float x0, float x1,
     bool leftInward, bool rightInward,
     bool topInward, bool bottomInward)
 {
+    FrameStats::getInstance().countDrawCalls(1);
     glBegin(GL_QUADS);
 
     // Front face (+Z)
@@ -118,6 +132,7 @@ void RenderHelper::renderInnerRoundedCorner(float r, float height,
 {
     float halfH = height * 0.5f;
     float delta = (endAngle - startAngle) / segs;
+    FrameStats::getInstance().countDrawCalls(2);
 
     // Build the contour points for an inner rounded corner
     std::vector<std::pair<float, float>> pts;
@@ -168,6 +183,7 @@ void RenderHelper::renderInnerRoundedCorner(float r, float height,
 void RenderHelper::renderOuterRoundedCorner(float radius, float height, float angleStart, float angleEnd, int segments) {
     float delta = (angleEnd - angleStart) / segments;
     float halfH = height * 0.5f;
+    FrameStats::getInstance().countDrawCalls(4);
 
     // Curved outer wall
     glBegin(GL_QUAD_STRIP);
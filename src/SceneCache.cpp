@@ -0,0 +1,80 @@
+#include "SceneCache.h"
+#include "FrameStats.h"
+
+SceneCache::~SceneCache() {
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+bool SceneCache::matches(const CameraGlu& camera, int width, int height, int settingsKey) const {
+    return valid &&
+        width == textureWidth && height == textureHeight &&
+        settingsKey == capturedSettingsKey &&
+        camera == capturedCamera;
+}
+
+void SceneCache::capture(const CameraGlu& camera, int width, int height, int settingsKey) {
+    if (!texture) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        // Drawn 1:1, nearest keeps it sharp
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    else {
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+
+    // Reallocates on size change, otherwise just overwrites (multisampled back buffers resolve here)
+    if (width != textureWidth || height != textureHeight) {
+        glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 0, 0, width, height, 0);
+        textureWidth = width;
+        textureHeight = height;
+    }
+    else {
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    capturedCamera = camera;
+    capturedSettingsKey = settingsKey;
+    valid = true;
+}
+
+void SceneCache::render() const {
+    if (!valid) return;
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, 1.0, 0.0, 1.0, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+    FrameStats::getInstance().countDrawCalls(1);
+    glBegin(GL_QUADS);
+        glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+        glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, 0.0f);
+        glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
+        glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, 1.0f);
+    glEnd();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
@@ -0,0 +1,108 @@
+#include "StatsOverlay.h"
+#include <cstdio>
+#include "Game.h"
+#include "GameUserInput.h"
+#include "FrameStats.h"
+#include "QualityManager.h"
+#include "PathfindingQueue.h"
+#include "glft2/TextRenderer.hpp"
+
+void StatsOverlay::handleInput() {
+    GameUserInput& guin = GameUserInput::getInstance();
+    if (guin.isKeyFlagPressedAndReleased(TOGGLE_KEY)) {
+        guin.resetKeyFlagPressedAndReleased(TOGGLE_KEY);
+        visible = !visible;
+    }
+    if (guin.isKeyFlagPressedAndReleased(TARGET_KEY)) {
+        guin.resetKeyFlagPressedAndReleased(TARGET_KEY);
+        if (visible) QualityManager::getInstance().cycleTargetHz();
+    }
+}
+
+std::vector<std::string> StatsOverlay::buildLines() const {
+    const FrameSample& frame = FrameStats::getInstance().getLastFrame();
+    const QualityManager& quality = QualityManager::getInstance();
+    const QualitySettings& s = quality.getSettings();
+
+    std::vector<std::string> lines;
+    char line[128];
+
+    double frameMs = quality.getSmoothedFrameMs();
+    std::snprintf(line, sizeof(line), "%.1f fps  frame %.2f ms  cpu %.2f ms",
+        frameMs > 0.0 ? 1000.0 / frameMs : 0.0, frameMs, quality.getSmoothedCpuMs());
+    lines.push_back(line);
+
+    std::snprintf(line, sizeof(line), "draw calls %d", frame.drawCalls);
+    lines.push_back(line);
+
+    // GPU times lag a few frames behind, show the newest frame that has them next to its CPU times
+    const FrameSample& gpuFrame = FrameStats::getInstance().getLastGpuFrame();
+    if (gpuFrame.gpuMs >= 0.0) {
+        std::snprintf(line, sizeof(line), "frame %llu  cpu %.2f ms  gpu %.2f ms  (%s bound)",
+            (unsigned long long)gpuFrame.frame, gpuFrame.cpuMs, gpuFrame.gpuMs,
+            gpuFrame.gpuMs > gpuFrame.cpuMs ? "gpu" : "cpu");
+        lines.push_back(line);
+        for (const ZoneSample& zone : gpuFrame.zones) {
+            std::snprintf(line, sizeof(line), "  %-8s cpu %6.2f  gpu %6.2f", zone.name, zone.cpuMs, zone.gpuMs);
+            lines.push_back(line);
+        }
+    }
+    else if (!FrameStats::getInstance().hasGpuTimers()) {
+        lines.push_back("gpu timers not available");
+    }
+
+    std::snprintf(line, sizeof(line), "quality %s%s  target %d Hz (%.2f ms)",
+        QualityManager::levelName(quality.getLevel()), quality.isAdaptive() ? "" : " (fixed)",
+        quality.getTargetHz(), quality.getBudgetMs());
+    lines.push_back(line);
+
+    std::snprintf(line, sizeof(line), "pacman %d  ghost %d/%d  pellet %d  corner %d  sky %d  msaa %s",
+        s.playerSegments, s.ghostSegments, s.skirtSegments, s.pelletSegments,
+        s.cornerSegments, s.worldSphereSegments, s.multisample ? "on" : "off");
+    lines.push_back(line);
+
+    const PathfindingQueue& pathfinding = PathfindingQueue::getInstance();
+    const PathCache& cache = pathfinding.getCache();
+    uint64_t hits = cache.getHits();
+    uint64_t lookups = hits + cache.getMisses();
+    std::snprintf(line, sizeof(line), "paths searched %llu  cache hits %llu  misses %llu (%.0f%%)  evicted %llu",
+        (unsigned long long)pathfinding.getCompletedJobs(), (unsigned long long)hits,
+        (unsigned long long)cache.getMisses(), lookups ? 100.0 * hits / lookups : 0.0,
+        (unsigned long long)cache.getEvictions());
+    lines.push_back(line);
+
+    return lines;
+}
+
+void StatsOverlay::render() {
+    if (!visible) return;
+
+    glft2::font_data font = Game::getInstance().getMenuFont();
+    GLint vp[4];
+    glGetIntegerv(GL_VIEWPORT, vp);
+    float H = float(vp[3]);
+    float margin = H * 0.02f;
+
+    const float scale = 0.25f;
+    float lineW, lineH;
+    glft2::measureText(font, "Ag", &lineW, &lineH, scale);
+    float spacing = lineH * 0.4f;
+
+    std::vector<std::string> lines = buildLines();
+
+    // On top of everything, the scene depth is still in the buffer
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(1.0f, 1.0f, 0.6f, 1.0f);
+
+    float y = H - margin - lineH;
+    FrameStats::getInstance().countDrawCalls((int)lines.size());
+    for (const std::string& text : lines) {
+        glft2::render2D(font, margin, y, text, scale);
+        y -= lineH + spacing;
+    }
+
+    glPopAttrib();
+}
@@ -5,12 +5,17 @@
 #include <iomanip>
 #include <sstream>
 #include "GameLighting.h"
+#include "RenderHelper.h"
+#include "FrameStats.h"
+#include "QualityManager.h"
+#include "DebugDraw.h"
 
 
 Tile::Tile(TileType tileType, Point3D tileOrigin, BoundingBox3D tileBoundingBox, int tileRow, int tileCol) : Entity(tileOrigin, tileBoundingBox) {
 	this->tileRow = tileRow;
 	this->tileCol = tileCol;
 	this->tileType = tileType;
+	this->initialTileType = tileType;
 }
 
 bool Tile::collectPellet() {
@@ -44,6 +49,15 @@ bool Tile::isGhostHouseTile() const {
 	return false;
 }
 
+bool Tile::isDoor() const {
+	return initialTileType == TileType::DOOR_OPEN || initialTileType == TileType::DOOR_CLOSED;
+}
+
+void Tile::setDoorOpen(bool open) {
+	if (!isDoor()) return;
+	setTileType(open ? TileType::DOOR_OPEN : TileType::DOOR_CLOSED);
+}
+
 Point3D Tile::getCenterPoint() const {
 	const auto& absBB = getAbsoluteBoundingBox();
 	const auto& min = absBB.min;
@@ -87,16 +101,14 @@ std::string Tile::getTileTypeString() {
 void Tile::renderHighlight() const {
 	BoundingBox3D abb = this->getAbsoluteBoundingBox();
 
-	// Set the color for highlighting
-	glColor4f(highlightR, highlightG, highlightB, highlightA);
-
-	// Render the plane just above the floor to prevent clipping
-	glBegin(GL_QUADS);
-		glVertex3f(abb.min.x, abb.min.y + 0.01f, abb.min.z); // Bottom-left
-		glVertex3f(abb.max.x, abb.min.y + 0.01f, abb.min.z); // Bottom-right
-		glVertex3f(abb.max.x, abb.min.y + 0.01f, abb.max.z); // Top-right
-		glVertex3f(abb.min.x, abb.min.y + 0.01f, abb.max.z); // Top-left
-	glEnd();
+	// Plane just above the floor to prevent clipping, drawn with the rest of the debug batch
+	float y = abb.min.y + 0.01f;
+	DebugDraw::getInstance().quad(
+		Point3D(abb.min.x, y, abb.min.z),
+		Point3D(abb.max.x, y, abb.min.z),
+		Point3D(abb.max.x, y, abb.max.z),
+		Point3D(abb.min.x, y, abb.max.z),
+		DebugColor{ highlightR, highlightG, highlightB, highlightA });
 }
 
 void Tile::renderEmpty() const {
@@ -110,6 +122,7 @@ void Tile::renderEmpty() const {
 
 	GameLighting::setMaterial(GL_FRONT, LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR, LIGHT_EMISSION, LIGHT_SHININESS);
 
+	FrameStats::getInstance().countDrawCalls(1);
 	glBegin(GL_QUADS);
 		glNormal3f(0, 1, 0); // Up-facing surface
 		glVertex3f(abb.min.x, abb.min.y, abb.min.z);
@@ -137,13 +150,14 @@ void Tile::renderPellet() const {
 
 	glPushMatrix();
 	glTranslatef(centerX, centerY, centerZ);
-	glutSolidSphere(MapFactory::TILE_SIZE / 8.0, 16, 16);  // Has normals by default
+	int segments = QualityManager::getInstance().getSettings().pelletSegments;
+	RenderHelper::solidSphere(MapFactory::TILE_SIZE / 8.0, segments, segments);  // Has normals by default
 	glPopMatrix();
 
 	GameLighting::resetMaterial(GL_FRONT_AND_BACK);
 }
 
-void Tile::renderDoorOpen() const {
+void Tile::renderDoor(bool closed) const {
 	BoundingBox3D abb = this->getAbsoluteBoundingBox();
 
 	// Dark brown material with no shine
@@ -157,7 +171,7 @@ void Tile::renderDoorOpen() const {
 
 	float centerX = (abb.min.x + abb.max.x) / 2.0f;
 	float centerY = (abb.min.y + DOOR_HEIGHT) / 2.0f;
-	float centerZ = (abb.min.z + abb.max.z) / 2.0f + MapFactory::TILE_SIZE * 0.25f;
+	float centerZ = (abb.min.z + abb.max.z) / 2.0f + (closed ? 0.0f : MapFactory::TILE_SIZE * 0.25f);
 
 	float width = MapFactory::TILE_SIZE;
 	float height = MapFactory::TILE_SIZE;
@@ -167,31 +181,28 @@ void Tile::renderDoorOpen() const {
 	glTranslatef(centerX, centerY, centerZ);
 	glScalef(width, height, depth); // scale unit cube into a door block
 	glScalef(1.0f, DOOR_HEIGHT, 1.0f);
-	glutSolidCube(1.0f);
+	RenderHelper::solidCube(1.0f);
 	glPopMatrix();
 
 	GameLighting::resetMaterial(GL_FRONT_AND_BACK);
 }
 
 
+// Pellets and doors come from the snapshot bitsets, see Map::render
 void Tile::render() const {
 	if (highlight) {
 		renderHighlight();
 	}
 
-	switch (tileType) {
+	switch (initialTileType) {
 	case TileType::PELLET:
 		renderEmpty();
-		renderPellet();
 		break;
 	case TileType::EMPTY:
 	case TileType::GHOST_HOUSE:
 		renderEmpty();
 		break;
 	case TileType::DOOR_OPEN:
-		renderDoorOpen();
-		renderEmpty();
-		break;
 	case TileType::DOOR_CLOSED:
 	case TileType::TELEPORT:
 	case TileType::SPAWN_PLAYER:
@@ -3,6 +3,12 @@
 #include "RenderHelper.h"
 #include "GameLighting.h"
 #include "Pi.h"
+#include "QualityManager.h"
+
+// Rounded corner tessellation follows the current quality level
+static int cornerSegments() {
+    return QualityManager::getInstance().getSettings().cornerSegments;
+}
 
 TileWall::TileWall(WallType wallType,
                    TileType tileType, 
@@ -85,7 +91,7 @@ void TileWall::renderWallBlock() const {
     glPushMatrix();
         glTranslatef(centerX, centerY, centerZ);
         glScalef(1.0f, WALL_HEIGHT, 1.0f);
-        glutSolidCube(MapFactory::TILE_SIZE);
+        RenderHelper::solidCube(MapFactory::TILE_SIZE);
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -108,7 +114,7 @@ void TileWall::renderWallLeft() const {
         glTranslatef(centerX, halfY, halfZ);
         glScalef(THICKNESS_FRAC, 1.0f, 1.0f);
         glScalef(1.0f, WALL_HEIGHT, 1.0f);
-        glutSolidCube(MapFactory::TILE_SIZE);
+        RenderHelper::solidCube(MapFactory::TILE_SIZE);
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -130,7 +136,7 @@ void TileWall::renderWallRight() const {
         glTranslatef(centerX, halfY, halfZ);
         glScalef(THICKNESS_FRAC, 1.0f, 1.0f);
         glScalef(1.0f, WALL_HEIGHT, 1.0f);
-        glutSolidCube(MapFactory::TILE_SIZE);
+        RenderHelper::solidCube(MapFactory::TILE_SIZE);
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -151,7 +157,7 @@ void TileWall::renderWallTop() const {
         glTranslatef(halfX, halfY, centerZ);
         glScalef(1.0f, 1.0f, THICKNESS_FRAC);
         glScalef(1.0f, WALL_HEIGHT, 1.0f);
-        glutSolidCube(MapFactory::TILE_SIZE);
+        RenderHelper::solidCube(MapFactory::TILE_SIZE);
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -172,7 +178,7 @@ void TileWall::renderWallBottom() const {
         glTranslatef(halfX, halfY, centerZ);
         glScalef(1.0f, 1.0f, THICKNESS_FRAC);
         glScalef(1.0f, WALL_HEIGHT, 1.0f);
-        glutSolidCube(MapFactory::TILE_SIZE);
+        RenderHelper::solidCube(MapFactory::TILE_SIZE);
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -197,7 +203,7 @@ void TileWall::renderWallCornerTopLeft() const {
     glPushMatrix();
     glTranslatef(cx, halfY, cz);
     glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-    RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, CYLINDER_SEGMENTS);
+    RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, cornerSegments());
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -221,7 +227,7 @@ void TileWall::renderWallCornerTopRight() const {
 
     glPushMatrix();
         glTranslatef(cx, halfY, cz);
-        RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, CYLINDER_SEGMENTS);
+        RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, cornerSegments());
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -246,7 +252,7 @@ void TileWall::renderWallCornerBottomLeft() const {
     glPushMatrix();
         glTranslatef(cx, halfY, cz);
         glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
-        RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, CYLINDER_SEGMENTS);
+        RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, cornerSegments());
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -271,7 +277,7 @@ void TileWall::renderWallCornerBottomRight() const {
     glPushMatrix();
         glTranslatef(cx, halfY, cz);
         glRotatef(270.0f, 0.0f, 1.0f, 0.0f);
-        RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, CYLINDER_SEGMENTS);
+        RenderHelper::renderInnerRoundedCorner(r, tileH, PI * 0.5f, PI, cornerSegments());
     glPopMatrix();
 
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
@@ -296,7 +302,7 @@ void TileWall::renderWallInnerTopLeft() const {
         glTranslatef(cx, halfY, cz);
 
         // Quarter-cylinder in the corner
-        RenderHelper::renderOuterRoundedCorner(r, tileH, PI * 0.5f, PI, CYLINDER_SEGMENTS);
+        RenderHelper::renderOuterRoundedCorner(r, tileH, PI * 0.5f, PI, cornerSegments());
     glPopMatrix();
 
     glPushMatrix();
@@ -328,7 +334,7 @@ void TileWall::renderWallInnerTopRight() const {
 
     glPushMatrix();
         glTranslatef(cx, halfY, cz);
-        RenderHelper::renderOuterRoundedCorner(r, tileH, 0.0f, PI * 0.5f, CYLINDER_SEGMENTS);
+        RenderHelper::renderOuterRoundedCorner(r, tileH, 0.0f, PI * 0.5f, cornerSegments());
     glPopMatrix();
 
     glPushMatrix();
@@ -360,7 +366,7 @@ void TileWall::renderWallInnerBottomLeft() const {
 
     glPushMatrix();
         glTranslatef(cx, halfY, cz);
-        RenderHelper::renderOuterRoundedCorner(r, tileH, PI, PI * 1.5f, CYLINDER_SEGMENTS);
+        RenderHelper::renderOuterRoundedCorner(r, tileH, PI, PI * 1.5f, cornerSegments());
     glPopMatrix();
 
     glPushMatrix();
@@ -393,7 +399,7 @@ void TileWall::renderWallInnerBottomRight() const {
 
     glPushMatrix();
         glTranslatef(cx, halfY, cz);
-        RenderHelper::renderOuterRoundedCorner(r, tileH, PI * 1.5f, 2.0f * PI, CYLINDER_SEGMENTS);
+        RenderHelper::renderOuterRoundedCorner(r, tileH, PI * 1.5f, 2.0f * PI, cornerSegments());
     glPopMatrix();
 
     glPushMatrix();
@@ -1,6 +1,8 @@
 #include "WorldSphere.h"
 #include <iostream>
 #include "GameLighting.h"
+#include "FrameStats.h"
+#include "QualityManager.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -41,16 +43,18 @@ void WorldSphere::init() {
 }
 
 // Method to render the sphere with the loaded texture applied
-void WorldSphere::render() {
+void WorldSphere::render(float scale) {
     glEnable(GL_TEXTURE_2D);
     glBindTexture(GL_TEXTURE_2D, textureID);
 
-    GameLighting::setMaterial(GL_FRONT_AND_BACK, LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR, LIGHT_EMISSION, LIGHT_SHININESS);
+    GameLighting::setMaterial(GL_FRONT_AND_BACK, LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR, LIGHT_EMISSION, LIGHT_SHININESS, MaterialClass::LitTextured);
     glPushMatrix();
         // Optional: scale if your world requires it
         glTranslatef(-1.0f, 0.0f, 0.0f);
         // Render the sphere from inside
-        gluSphere(quadric, SPHERE_RADIUS, 32, 32);
+        FrameStats::getInstance().countDrawCalls(1);
+        int segments = QualityManager::getInstance().getSettings().worldSphereSegments;
+        gluSphere(quadric, SPHERE_RADIUS * scale, segments, segments);
 
     glPopMatrix();
     GameLighting::resetMaterial(GL_FRONT_AND_BACK);
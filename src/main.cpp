@@ -1,7 +1,11 @@
 #include <GL/glew.h>
 #include <GL/glut.h>
 #include "Game.h"
+#include "LevelPack.h"
 #include "resource.h"
+#include <cstdlib>
+#include <filesystem>
+#include <string>
 #include <windows.h>
 
 // This gets called by the Windows loader
@@ -38,6 +42,33 @@ int main(int argc, char** argv) {
     // Singleton static instance
     Game& game = Game::getInstance();
 
+    // --map file loads another board (any size) instead of the default one,
+    // --generate seed makes every level a generated one,
+    // --pack file plays the levels of a pack built by pacman_mapc --pack,
+    // --watch reloads the map in place whenever it is saved.
+    // Without any of them the shipped pack is played if it was built.
+    std::string packPath;
+    bool otherLevels = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--watch") {
+            game.setMapWatching(true);
+            otherLevels = true;
+        }
+        else if (i + 1 >= argc) break;
+        else if (arg == "--pack") packPath = argv[++i];
+        else if (arg == "--map") {
+            game.setMapPath(argv[++i]);
+            otherLevels = true;
+        }
+        else if (arg == "--generate") {
+            game.setGeneratedLevels(true, (uint32_t)std::strtoul(argv[++i], nullptr, 10));
+            otherLevels = true;
+        }
+    }
+    if (!packPath.empty()) game.setLevelPack(packPath);
+    else if (!otherLevels && std::filesystem::exists(LevelPack::DEFAULT_PATH)) game.setLevelPack(LevelPack::DEFAULT_PATH);
+
     glutReshapeFunc(Game::reshape);
     glutDisplayFunc(Game::render);
     glutTimerFunc(16, Game::update, 0);
@@ -0,0 +1,364 @@
+// Navigation micro benchmarks over 1.map and generated mazes up to 1024x1024,
+// results as JSON (ns/op, heap allocations/op, search nodes expanded/op)
+//
+//   pacman_bench_nav [--out file] [--max-size N] [--min-time-ms N] [--seed N] [--map file]
+//
+// Run from the build dir so assets/ resolves like for the game.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "Map.h"
+#include "MapFactory.h"
+#include "Ghost.h"
+#include "FlowField.h"
+#include "SearchStats.h"
+
+// Every heap allocation in the process goes through here
+static std::atomic<uint64_t> allocationCount{ 0 };
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Options {
+    std::string outPath;                        // stdout if empty
+    std::string mapPath = "assets/maps/1.map";
+    int maxSize = 1024;
+    double minTimeMs = 200.0;
+    uint32_t seed = 1;
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t ops = 0;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    double nodesPerOp = -1.0;                   // -1 = not a search
+};
+
+struct MapResult {
+    std::string name;
+    int width = 0;
+    int height = 0;
+    int walkableTiles = 0;
+    int navNodes = 0;
+    double buildMs = 0.0;
+    std::vector<BenchResult> benchmarks;
+};
+
+constexpr int SAMPLE_COUNT = 256;               // start/goal pairs per map, cycled through
+constexpr uint64_t MIN_OPS = 16;
+
+volatile size_t sink = 0;                       // keeps results alive
+
+// Compound assignment to a volatile is deprecated in C++20
+void keep(size_t value) {
+    sink = sink + value;
+}
+
+// Runs op(i) until minTimeMs passed and at least MIN_OPS ran
+template <typename Op>
+BenchResult measure(const std::string& name, double minTimeMs, Op op) {
+    using clock = std::chrono::steady_clock;
+    for (int i = 0; i < 4; ++i) op(i);          // warm caches and lazy statics
+
+    BenchResult result;
+    result.name = name;
+    uint64_t allocationsBefore = allocationCount.load();
+    auto start = clock::now();
+    double elapsedMs = 0.0;
+    uint64_t ops = 0;
+    while (ops < MIN_OPS || elapsedMs < minTimeMs) {
+        for (int batch = 0; batch < 8; ++batch) op(ops++);
+        elapsedMs = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+    result.ops = ops;
+    result.nsPerOp = elapsedMs * 1e6 / ops;
+    result.allocsPerOp = double(allocationCount.load() - allocationsBefore) / ops;
+    return result;
+}
+
+// Braided depth-first maze on the odd cells with one teleport pair, every floor tile holds a pellet
+std::vector<std::string> generateMaze(int width, int height, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::vector<std::string> rows(height, std::string(width, 'x'));
+    auto isCell = [&](int row, int col) { return row > 0 && col > 0 && row < height - 1 && col < width - 1 && row % 2 == 1 && col % 2 == 1; };
+
+    const int dr[4] = { -2, 2, 0, 0 };
+    const int dc[4] = { 0, 0, -2, 2 };
+    std::vector<std::pair<int, int>> stack = { { 1, 1 } };
+    rows[1][1] = '*';
+    while (!stack.empty()) {
+        auto [row, col] = stack.back();
+        int order[4] = { 0, 1, 2, 3 };
+        std::shuffle(order, order + 4, gen);
+        bool carved = false;
+        for (int k : order) {
+            int nextRow = row + dr[k];
+            int nextCol = col + dc[k];
+            if (!isCell(nextRow, nextCol) || rows[nextRow][nextCol] != 'x') continue;
+            rows[row + dr[k] / 2][col + dc[k] / 2] = '*';
+            rows[nextRow][nextCol] = '*';
+            stack.push_back({ nextRow, nextCol });
+            carved = true;
+            break;
+        }
+        if (!carved) stack.pop_back();
+    }
+
+    // Knock out some walls between cells so there are loops like on a real board
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (int row = 1; row < height - 1; ++row) {
+        for (int col = 1; col < width - 1; ++col) {
+            if (rows[row][col] != 'x' || percent(gen) >= 12) continue;
+            bool horizontal = isCell(row, col - 1) && isCell(row, col + 1);
+            bool vertical = isCell(row - 1, col) && isCell(row + 1, col);
+            if (horizontal || vertical) rows[row][col] = '*';
+        }
+    }
+
+    int teleportRow = (height / 2) | 1;
+    if (teleportRow < height - 1) {
+        rows[teleportRow][0] = 't';
+        rows[teleportRow][width - 1] = 't';
+        rows[teleportRow][1] = '*';
+        rows[teleportRow][width - 2] = '*';
+    }
+    return rows;
+}
+
+bool readMapRows(const std::string& path, std::vector<std::string>& rows) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "pacman_bench_nav: failed to open " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) rows.push_back(line);
+    }
+    return !rows.empty();
+}
+
+MapResult benchMap(const std::string& name, const std::vector<std::string>& rows, const Options& options) {
+    MapResult result;
+    result.name = name;
+
+    auto buildStart = std::chrono::steady_clock::now();
+    MapFactory factory;
+    std::shared_ptr<Map> map = std::make_shared<Map>(factory.createMapFromRows(rows));
+    result.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+    result.width = map->getWidth();
+    result.height = map->getHeight();
+    result.walkableTiles = map->getNavGraph().getWalkableTileCount();
+    result.navNodes = map->getNavGraph().getNodeCount();
+    if (!map->getRandomTile()) return result;
+
+    // Same samples for every benchmark, goals always reachable from their start
+    std::mt19937 gen(options.seed);
+    std::vector<Tile*> starts;
+    std::vector<Tile*> goals;
+    std::vector<BoundingBox3D> boxes;
+    std::uniform_real_distribution<float> offset(0.0f, 1.0f);
+    for (int i = 0; i < SAMPLE_COUNT; ++i) {
+        Tile* start = map->getRandomTile();
+        starts.push_back(start);
+        goals.push_back(map->getRandomTile(start));
+        Point3D origin = start->getOrigin();
+        origin.move(offset(gen), 0.0f, offset(gen));
+        boxes.push_back(BoundingBox3D(origin, Point3D(origin.x + 0.999f, origin.y + 0.999f, origin.z + 0.999f)));
+    }
+
+    BoundingBox3D ghostBox(Point3D(0, 0, 0), Point3D(0.999, 0.999, 0.999));
+    Ghost ghost(map.get(), starts[0]->getOrigin(), ghostBox, "bench");
+    auto sample = [](uint64_t i) { return (size_t)(i % SAMPLE_COUNT); };
+
+    BenchResult shortest = measure("shortestPathToTile", options.minTimeMs, [&](uint64_t i) {
+        ghost.setOrigin(starts[sample(i)]->getOrigin());
+        keep(ghost.shortestPathToTile(goals[sample(i)]).size());
+    });
+    SearchStats graphStats;
+    for (int i = 0; i < SAMPLE_COUNT; ++i) map->getNavGraph().findPath(starts[i], goals[i], &graphStats);
+    shortest.nodesPerOp = double(graphStats.expanded) / SAMPLE_COUNT;
+    result.benchmarks.push_back(shortest);
+
+    if (const HierarchicalPathfinder* hierarchy = map->getHierarchy()) {
+        BenchResult hpa = measure("hierarchicalFindPath", options.minTimeMs, [&](uint64_t i) {
+            keep(hierarchy->findPath(starts[sample(i)], goals[sample(i)]).tiles.size());
+        });
+        SearchStats hierarchyStats;
+        for (int i = 0; i < SAMPLE_COUNT; ++i) hierarchy->findPath(starts[i], goals[i], HierarchicalPathfinder::REFINE_CLUSTERS, &hierarchyStats);
+        hpa.nodesPerOp = double(hierarchyStats.expanded) / SAMPLE_COUNT;
+        result.benchmarks.push_back(hpa);
+    }
+
+    result.benchmarks.push_back(measure("furthestTileTowardCorner", options.minTimeMs, [&](uint64_t i) {
+        ghost.setOrigin(starts[sample(i)]->getOrigin());
+        keep((size_t)ghost.furthestTileTowardCorner(Map::corners[i % Map::corners.size()]));
+    }));
+
+    result.benchmarks.push_back(measure("getRandomTile", options.minTimeMs, [&](uint64_t i) {
+        keep((size_t)map->getRandomTile(starts[sample(i)]));
+    }));
+
+    FlowField field;
+    BenchResult flow = measure("flowFieldBuild", options.minTimeMs, [&](uint64_t i) {
+        field.invalidate();
+        field.update(map.get(), goals[sample(i)]);
+        keep(field.getVersion());
+    });
+    // A BFS expands every tile it reaches, count that for a few targets
+    uint64_t reached = 0;
+    const int flowSamples = 8;
+    for (int i = 0; i < flowSamples; ++i) {
+        field.invalidate();
+        field.update(map.get(), goals[i]);
+        for (int row = 0; row < map->getHeight(); ++row) {
+            for (int col = 0; col < map->getWidth(); ++col) {
+                if (field.distanceTo(map->getTileAt(row, col)) != FlowField::UNREACHABLE) reached++;
+            }
+        }
+    }
+    flow.nodesPerOp = double(reached) / flowSamples;
+    result.benchmarks.push_back(flow);
+
+    // What the game does per player step: the target walks along a route with a chaser
+    // CHASE_GAP tiles behind, the search only has to reach the chaser
+    const size_t CHASE_GAP = 32;
+    std::vector<Tile*> route;
+    field.invalidate();
+    field.update(map.get(), goals[0]);
+    for (Tile* tile = starts[0]; tile; tile = field.nextHop(tile)) route.push_back(tile);
+    if (route.size() > CHASE_GAP + 1) {
+        size_t steps = route.size() - CHASE_GAP;
+        BenchResult chase = measure("flowFieldChase", options.minTimeMs, [&](uint64_t i) {
+            size_t step = i % steps;
+            field.update(map.get(), route[step + CHASE_GAP], { route[step] });
+            keep(field.getVersion());
+        });
+        chase.nodesPerOp = 0;
+        for (size_t step = 0; step < std::min<size_t>(steps, flowSamples); ++step) {
+            field.invalidate();
+            field.update(map.get(), route[step + CHASE_GAP], { route[step] });
+            for (int row = 0; row < map->getHeight(); ++row) {
+                for (int col = 0; col < map->getWidth(); ++col) {
+                    if (field.distanceTo(map->getTileAt(row, col)) != FlowField::UNREACHABLE) chase.nodesPerOp++;
+                }
+            }
+        }
+        chase.nodesPerOp /= std::min<size_t>(steps, flowSamples);
+        result.benchmarks.push_back(chase);
+    }
+
+    result.benchmarks.push_back(measure("getTilesWithBoundingBox", options.minTimeMs, [&](uint64_t i) {
+        keep(map->getTilesWithBoundingBox(&boxes[sample(i)]).size());
+    }));
+    return result;
+}
+
+std::string jsonString(const std::string& value) {
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void writeJson(std::ostream& out, const std::vector<MapResult>& results, const Options& options) {
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"seed\": " << options.seed << ",\n  \"minTimeMs\": " << options.minTimeMs << ",\n  \"maps\": [\n";
+    for (size_t m = 0; m < results.size(); ++m) {
+        const MapResult& map = results[m];
+        out << "    {\n"
+            << "      \"name\": " << jsonString(map.name) << ",\n"
+            << "      \"width\": " << map.width << ",\n"
+            << "      \"height\": " << map.height << ",\n"
+            << "      \"walkableTiles\": " << map.walkableTiles << ",\n"
+            << "      \"navNodes\": " << map.navNodes << ",\n"
+            << "      \"buildMs\": " << map.buildMs << ",\n"
+            << "      \"benchmarks\": [\n";
+        for (size_t b = 0; b < map.benchmarks.size(); ++b) {
+            const BenchResult& bench = map.benchmarks[b];
+            out << "        { \"name\": " << jsonString(bench.name)
+                << ", \"ops\": " << bench.ops
+                << ", \"nsPerOp\": " << bench.nsPerOp
+                << ", \"allocsPerOp\": " << bench.allocsPerOp
+                << ", \"nodesPerOp\": ";
+            if (bench.nodesPerOp < 0.0) out << "null";
+            else out << bench.nodesPerOp;
+            out << " }" << (b + 1 < map.benchmarks.size() ? "," : "") << "\n";
+        }
+        out << "      ]\n    }" << (m + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " [--out file] [--max-size N] [--min-time-ms N] [--seed N] [--map file]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) options.outPath = argv[++i];
+        else if (arg == "--max-size" && hasValue) options.maxSize = std::atoi(argv[++i]);
+        else if (arg == "--min-time-ms" && hasValue) options.minTimeMs = std::atof(argv[++i]);
+        else if (arg == "--seed" && hasValue) options.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--map" && hasValue) options.mapPath = argv[++i];
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<MapResult> results;
+    std::vector<std::string> rows;
+    if (!readMapRows(options.mapPath, rows)) return 1;
+    results.push_back(benchMap(options.mapPath, rows, options));
+
+    const std::pair<int, int> sizes[] = { { 28, 36 }, { 64, 64 }, { 128, 128 }, { 256, 256 }, { 512, 512 }, { 1024, 1024 } };
+    for (auto [width, height] : sizes) {
+        if (std::max(width, height) > options.maxSize) continue;
+        std::cerr << "pacman_bench_nav: maze " << width << "x" << height << std::endl;
+        results.push_back(benchMap("maze " + std::to_string(width) + "x" + std::to_string(height),
+                                   generateMaze(width, height, options.seed), options));
+    }
+
+    if (options.outPath.empty()) {
+        writeJson(std::cout, results, options);
+        return 0;
+    }
+    std::ofstream file(options.outPath);
+    if (!file) {
+        std::cerr << "pacman_bench_nav: failed to open " << options.outPath << std::endl;
+        return 1;
+    }
+    writeJson(file, results, options);
+    return file.good() ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// Offscreen render benchmark, see HeadlessRenderer.h
+//
+//   MPG-PacMan-headless [--frames N] [--warmup N] [--size WxH] [--play]
+//                       [--replay file] [--dump dir] [--dump-every N] [--csv file]
+//                       [--trace file] [--map file] [--generate seed] [--pack file]
+//                       [--watch]
+//
+// Run from the build dir so assets/ resolves like for the game.
+
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "HeadlessRenderer.h"
+
+static void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " [--frames N] [--warmup N] [--size WxH] [--play]\n"
+              << "       [--replay file] [--dump dir] [--dump-every N] [--csv file]\n"
+              << "       [--trace file] [--map file] [--generate seed] [--pack file]\n"
+              << "       [--watch]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--frames" && hasValue) options.frames = std::atoi(argv[++i]);
+        else if (arg == "--warmup" && hasValue) options.warmupFrames = std::atoi(argv[++i]);
+        else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--play") options.play = true;
+        else if (arg == "--replay" && hasValue) options.replayPath = argv[++i];
+        else if (arg == "--dump" && hasValue) {
+            options.dumpDir = argv[++i];
+            if (options.dumpEvery == 0) options.dumpEvery = 1;
+        }
+        else if (arg == "--dump-every" && hasValue) options.dumpEvery = std::atoi(argv[++i]);
+        else if (arg == "--csv" && hasValue) options.csvPath = argv[++i];
+        else if (arg == "--trace" && hasValue) options.tracePath = argv[++i];
+        else if (arg == "--map" && hasValue) options.mapPath = argv[++i];
+        else if (arg == "--pack" && hasValue) options.packPath = argv[++i];
+        else if (arg == "--watch") options.watch = true;
+        else if (arg == "--generate" && hasValue) {
+            options.generate = true;
+            options.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.frames <= 0 || options.width <= 0 || options.height <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    HeadlessRenderer renderer(options);
+    if (!renderer.init() || !renderer.run()) {
+        return 1;
+    }
+    renderer.printReport(std::cout);
+    return 0;
+}
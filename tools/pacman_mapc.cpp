@@ -0,0 +1,289 @@
+// Validates text maps and compiles them into the binary format the game maps in
+// (see CompiledMap.h). The written file is opened again and loaded next to the text
+// map, both have to give the same tiles, links and NavGraph.
+//
+//   pacman_mapc [--check] input.map [output.pmap]
+//   pacman_mapc [--check] --generate seed [--size WxH] output.map [output.pmap]
+//   pacman_mapc [--check] --pack levels.txt [output.ppak]
+//
+// Output defaults to the input path with .pmap, --check only validates. --generate
+// writes a MazeGenerator board to the text map first and then compiles that.
+// --pack compiles every level of a manifest into one LevelPack, one level per line:
+//
+//   map difficulty playerSpeed ghostSpeed name
+//
+// map is relative to the manifest or generate:seed[:WxH], a speed of 0 keeps the
+// game's own curve, the name is the rest of the line. # starts a comment.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CompiledMap.h"
+#include "LevelPack.h"
+#include "Map.h"
+#include "MapFactory.h"
+#include "MapTemplate.h"
+#include "MazeGenerator.h"
+#include "TileWall.h"
+
+namespace {
+
+bool writeMapRows(const std::string& path, const std::vector<std::string>& rows) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cerr << "pacman_mapc: failed to open " << path << std::endl;
+        return false;
+    }
+    for (const std::string& row : rows) file << row << '\n';
+    return file.good();
+}
+
+int indexOf(const Tile* tile, int width) {
+    return tile ? tile->getTileRow() * width + tile->getTileCol() : -1;
+}
+
+// Same grid, links and graph whichever way the map was loaded
+bool sameMap(const Map& text, const Map& compiled, std::string& difference) {
+    int width = text.getWidth();
+    if (width != compiled.getWidth() || text.getHeight() != compiled.getHeight()) {
+        difference = "size";
+        return false;
+    }
+    for (int row = 0; row < text.getHeight(); ++row) {
+        for (int col = 0; col < width; ++col) {
+            const Tile* a = text.getTileAt(row, col);
+            const Tile* b = compiled.getTileAt(row, col);
+            std::string at = " at row " + std::to_string(row) + ", column " + std::to_string(col);
+            if (a->getTileType() != b->getTileType()) {
+                difference = "tile type" + at;
+                return false;
+            }
+            const TileWall* wallA = dynamic_cast<const TileWall*>(a);
+            const TileWall* wallB = dynamic_cast<const TileWall*>(b);
+            if ((wallA == nullptr) != (wallB == nullptr) || (wallA && wallA->getWallType() != wallB->getWallType())) {
+                difference = "wall type" + at;
+                return false;
+            }
+            if (indexOf(a->getTileUp(), width) != indexOf(b->getTileUp(), width) ||
+                indexOf(a->getTileDown(), width) != indexOf(b->getTileDown(), width) ||
+                indexOf(a->getTileLeft(), width) != indexOf(b->getTileLeft(), width) ||
+                indexOf(a->getTileRight(), width) != indexOf(b->getTileRight(), width)) {
+                difference = "neighbours" + at;
+                return false;
+            }
+        }
+    }
+    if (text.getState().pelletBits != compiled.getState().pelletBits) {
+        difference = "pellets";
+        return false;
+    }
+
+    const NavGraph& graphA = text.getNavGraph();
+    const NavGraph& graphB = compiled.getNavGraph();
+    if (graphA.getNodeCount() != graphB.getNodeCount() || graphA.getEdgeCount() != graphB.getEdgeCount() ||
+        graphA.getComponentCount() != graphB.getComponentCount() || graphA.getWalkableTileCount() != graphB.getWalkableTileCount()) {
+        difference = "nav graph";
+        return false;
+    }
+    for (int node = 0; node < graphA.getNodeCount(); ++node) {
+        if (graphA.getNodes()[node].edges != graphB.getNodes()[node].edges) {
+            difference = "nav graph node " + std::to_string(node);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string defaultOutput(const std::string& input) {
+    size_t slash = input.find_last_of("/\\");
+    size_t dot = input.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return input + ".pmap";
+    return input.substr(0, dot) + ".pmap";
+}
+
+void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " [--check] input.map [output.pmap]\n"
+              << "       " << exe << " [--check] --generate seed [--size WxH] output.map [output.pmap]\n"
+              << "       " << exe << " [--check] --pack levels.txt [output.ppak]" << std::endl;
+}
+
+struct PackLevel {
+    std::string map;
+    LevelPack::LevelInfo info;
+    std::vector<std::string> rows;
+};
+
+bool readManifest(const std::string& path, std::vector<PackLevel>& levels) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "pacman_mapc: failed to open " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        if (size_t comment = line.find('#'); comment != std::string::npos) line.erase(comment);
+        std::istringstream fields(line);
+        PackLevel level;
+        if (!(fields >> level.map)) continue;
+        if (!(fields >> level.info.difficulty >> level.info.playerSpeed >> level.info.ghostSpeed)) {
+            std::cerr << path << ":" << lineNumber << ": expected map difficulty playerSpeed ghostSpeed name" << std::endl;
+            return false;
+        }
+        std::getline(fields >> std::ws, level.info.name);
+        while (!level.info.name.empty() && std::isspace((unsigned char)level.info.name.back())) level.info.name.pop_back();
+        if (level.info.name.empty()) level.info.name = level.map;
+        levels.push_back(std::move(level));
+    }
+    if (levels.empty()) {
+        std::cerr << path << ": no levels" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Rows of every level, generated ones straight from MazeGenerator
+bool loadLevelRows(const std::string& manifest, PackLevel& level) {
+    const std::string prefix = "generate:";
+    if (level.map.compare(0, prefix.size(), prefix) != 0) {
+        std::filesystem::path path = std::filesystem::path(manifest).parent_path() / level.map;
+        return MapFactory::readRows(path.string(), level.rows);
+    }
+    MazeGenerator::Options options;
+    unsigned long seed = 0;
+    int fields = std::sscanf(level.map.c_str() + prefix.size(), "%lu:%dx%d", &seed, &options.width, &options.height);
+    if (fields != 1 && fields != 3) {
+        std::cerr << manifest << ": bad " << level.map << ", expected generate:seed[:WxH]" << std::endl;
+        return false;
+    }
+    return MazeGenerator::generate((uint32_t)seed, options, level.rows);
+}
+
+int buildPack(const std::string& manifest, const std::string& output, bool checkOnly) {
+    std::vector<PackLevel> levels;
+    if (!readManifest(manifest, levels)) return 1;
+    std::string error;
+    for (PackLevel& level : levels) {
+        if (!loadLevelRows(manifest, level)) return 1;
+        if (!MapFactory::validateRows(level.rows, error)) {
+            std::cerr << level.map << ": " << error << std::endl;
+            return 1;
+        }
+    }
+    if (checkOnly) return 0;
+
+    MapFactory factory;
+    std::vector<LevelPack::Level> packLevels;
+    for (const PackLevel& level : levels) {
+        std::shared_ptr<const MapTemplate> captured = MapTemplate::capture(factory.createMapFromRows(level.rows));
+        if (!captured) return 1;
+        packLevels.push_back({ level.info, std::move(captured) });
+    }
+    if (!LevelPack::write(packLevels, output)) return 1;
+    packLevels.clear();
+
+    // Every level loads back from the pack the same as from its rows
+    std::shared_ptr<const LevelPack> pack = LevelPack::open(output);
+    if (!pack || pack->getLevelCount() != (int)levels.size()) return 1;
+    for (int index = 0; index < pack->getLevelCount(); ++index) {
+        const PackLevel& level = levels[index];
+        LevelPack::LevelInfo info = pack->getInfo(index);
+        std::shared_ptr<const MapTemplate> board = pack->loadTemplate(index);
+        if (!board || info.name != level.info.name || info.difficulty != level.info.difficulty ||
+            info.playerSpeed != level.info.playerSpeed || info.ghostSpeed != level.info.ghostSpeed) {
+            std::cerr << "pacman_mapc: " << output << " level " << index << " does not load back" << std::endl;
+            return 1;
+        }
+        Map text = factory.createMapFromRows(level.rows);
+        Map packed = factory.createMapFromTemplate(board);
+        if (!sameMap(text, packed, error)) {
+            std::cerr << "pacman_mapc: " << output << " level " << index << " does not load back the same (" << error << ")" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << manifest << " -> " << output << " (" << levels.size() << " levels, " << std::filesystem::file_size(output) << " bytes)" << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool checkOnly = false;
+    bool generate = false;
+    bool pack = false;
+    uint32_t seed = 0;
+    MazeGenerator::Options generatorOptions;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--check") checkOnly = true;
+        else if (arg == "--pack") pack = true;
+        else if (arg == "--generate" && hasValue) {
+            generate = true;
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &generatorOptions.width, &generatorOptions.height) != 2) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (!arg.empty() && arg[0] != '-') paths.push_back(arg);
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (paths.empty() || paths.size() > 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (pack) {
+        if (generate || (paths.size() != 2 && !(checkOnly && paths.size() == 1))) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return buildPack(paths[0], checkOnly ? "" : paths[1], checkOnly);
+    }
+    const std::string& input = paths[0];
+    std::string output = paths.size() > 1 ? paths[1] : defaultOutput(input);
+
+    std::vector<std::string> rows;
+    if (generate) {
+        MazeGenerator::Report report;
+        if (!MazeGenerator::generate(seed, generatorOptions, rows, &report) || !writeMapRows(input, rows)) return 1;
+        std::cout << "seed " << seed << " -> " << input << " (candidate " << report.candidate << ", round " << report.rounds
+                  << ", " << report.loopDensity << " loops per 100 tiles, " << report.ms << " ms)" << std::endl;
+    }
+    else if (!MapFactory::readRows(input, rows)) return 1;
+    std::string error;
+    if (!MapFactory::validateRows(rows, error)) {
+        std::cerr << input << ": " << error << std::endl;
+        return 1;
+    }
+    if (checkOnly) return 0;
+
+    MapFactory factory;
+    Map map = factory.createMapFromRows(rows);
+    std::shared_ptr<const MapTemplate> captured = MapTemplate::capture(map);
+    if (!captured || !CompiledMap::write(*captured, output)) return 1;
+
+    std::shared_ptr<const MapTemplate> compiled = MapTemplate::open(output);
+    if (!compiled) return 1;
+    Map reloaded = factory.createMapFromTemplate(compiled);
+    if (!sameMap(map, reloaded, error)) {
+        std::cerr << "pacman_mapc: " << output << " does not load back the same (" << error << ")" << std::endl;
+        return 1;
+    }
+
+    std::cout << input << " -> " << output << " (" << map.getWidth() << "x" << map.getHeight()
+              << ", " << map.getNavGraph().getNodeCount() << " nav nodes)" << std::endl;
+    return 0;
+}